@@ -0,0 +1,130 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include "mg_stopwatch.h"
+#include "mg_alias.h"
+
+/* *************What is this?***************
+ * Pick spinner numbers (RatCircle::MAX_NUM_POINTS, MAX_SPEED) from data
+ * instead of by trial. See "Where spinner aliasing comes from" in mg_alias.h.
+ *
+ * One setting, every column:
+ *
+ *      $ build/alias COUNT SPEED [BITS] [HZ]
+ *      $ build/alias 508 3
+ *
+ * Rank circle sizes: try every COUNT (a multiple of 4, Spinner::COUNT is
+ * 4*N) from MIN to MAX with speeds 1 to MAX_SPEED, score each COUNT by its
+ * total over all the speeds, print the best and how the game's COUNT does:
+ *
+ *      $ build/alias --rank MIN MAX [MAX_SPEED] [BITS] [HZ]
+ *      $ build/alias --rank 4 2048 31
+ *
+ * BITS defaults to 16 (Spinner::counter is a uint16_t), HZ to 60.
+ * *******************************/
+
+constexpr int GAME_COUNT = 4*(((1<<9)-3)/4);            // RatCircle: N = MAX_NUM_POINTS/4, COUNT = 4*N
+constexpr int SHOW = 10;                                // How many of the best COUNTs to print
+
+int main(int argc, char* argv[])
+{
+    // Guard against bad inputs
+    bool rank = (argc >= 2) && (strcmp(argv[1], "--rank") == 0);
+    if (  (!rank && ((argc < 3) || (argc > 5))) || (rank && ((argc < 4) || (argc > 7)))  )
+    {
+        puts("Usage: ./alias COUNT SPEED [BITS] [HZ]\n"
+             "       ./alias --rank MIN_COUNT MAX_COUNT [MAX_SPEED] [BITS] [HZ]\n"
+             "EXAMPLE: ./alias 508 3\n"
+             "EXAMPLE: ./alias --rank 4 2048 31"
+            );
+        return EXIT_FAILURE;
+    }
+
+    if (!rank)
+    { // One setting
+        Alias::Params p = {
+            .count=atoi(argv[1]), .speed=atoi(argv[2]),
+            .bits=(argc > 3) ? atoi(argv[3]) : 16,
+            .refresh=(argc > 4) ? static_cast<float>(atof(argv[4])) : 60.0f
+        };
+        if ((p.count < 1) || (p.speed < 1) || (p.bits < 1) || (p.bits > 24) || (p.refresh <= 0))
+        {
+            puts("COUNT and SPEED must be >= 1, BITS 1 to 24, HZ > 0");
+            return EXIT_FAILURE;
+        }
+        Alias::print_header();
+        Alias::print(Alias::analyze(p));
+        return EXIT_SUCCESS;
+    }
+
+    // Rank every COUNT in [MIN:MAX]
+    const int min_count = (atoi(argv[2]) + 3)/4*4;          // Round up to a multiple of 4
+    const int max_count = atoi(argv[3]);
+    const int max_speed = (argc > 4) ? atoi(argv[4]) : 31;  // RatCircle::MAX_SPEED for COUNT 508
+    const int bits = (argc > 5) ? atoi(argv[5]) : 16;
+    const float refresh = (argc > 6) ? static_cast<float>(atof(argv[6])) : 60.0f;
+    if ((min_count < 4) || (max_count < min_count) || (max_speed < 1) || (bits < 1) || (bits > 24) || (refresh <= 0))
+    {
+        puts("Need 4 <= MIN_COUNT <= MAX_COUNT, MAX_SPEED >= 1, BITS 1 to 24, HZ > 0");
+        return EXIT_FAILURE;
+    }
+    const int ncounts = (max_count - min_count)/4 + 1;
+    const int nsettings = ncounts*max_speed;
+    Alias::Params* settings = (Alias::Params*)malloc(sizeof(Alias::Params)*nsettings);
+    Alias::Report* reports = (Alias::Report*)malloc(sizeof(Alias::Report)*nsettings);
+    for (int c=0; c<ncounts; c++)
+    {
+        for (int s=0; s<max_speed; s++)
+        {
+            settings[c*max_speed + s] = Alias::Params{
+                .count=min_count + 4*c, .speed=s+1, .bits=bits, .refresh=refresh};
+        }
+    }
+
+    Jobs::Pool pool;
+    Jobs::start(pool);
+    const int nthreads = Jobs::threads(pool);
+    Stopwatch::Tally sweep_time{"sweep"};
+    sweep_time.start();
+    Alias::sweep(pool, settings, nsettings, reports);
+    sweep_time.stop();
+    Jobs::stop(pool);
+
+    /* *************Score each COUNT***************
+     * reports is COUNT by COUNT, speeds 1 to max_speed in a row. A COUNT's score
+     * is the total over its speeds (a spinner can be at any speed). Rank the
+     * COUNTs: sort their first report, with the total as its score.
+     * *******************************/
+    Alias::Report* totals = (Alias::Report*)malloc(sizeof(Alias::Report)*ncounts);
+    int game = -1;                                      // Where GAME_COUNT ended up
+    for (int c=0; c<ncounts; c++)
+    {
+        totals[c] = reports[c*max_speed];
+        totals[c].score = Alias::score(&reports[c*max_speed], max_speed);
+    }
+    Alias::rank(totals, ncounts);
+    for (int c=0; c<ncounts; c++) if (totals[c].p.count == GAME_COUNT) game = c;
+
+    printf("%d settings (%d COUNTs x %d speeds, %d-bit counter, %.0f Hz) in %.1f ms on %d threads\n\n",
+           nsettings, ncounts, max_speed, bits, refresh, sweep_time.total_us/1000, nthreads);
+    printf("Best COUNTs (score: total over speeds 1-%d, lower is better)\n", max_speed);
+    for (int c=0; (c<ncounts) && (c<SHOW); c++)
+    {
+        printf("%3d. COUNT %5d (N %4d) : %9.2f\n", c+1, totals[c].p.count, totals[c].p.count/4, totals[c].score);
+    }
+    if (game >= 0)
+    {
+        printf("...\n%3d. COUNT %5d (N %4d) : %9.2f  <-- RatCircle now\n",
+               game+1, GAME_COUNT, GAME_COUNT/4, totals[game].score);
+    }
+    { // Every speed of the best COUNT
+        int best = (totals[0].p.count - min_count)/4;
+        printf("\nCOUNT %d, every speed:\n", totals[0].p.count);
+        Alias::print_header();
+        for (int s=0; s<max_speed; s++) Alias::print(reports[best*max_speed + s]);
+    }
+
+    free(settings); free(reports); free(totals);
+    return EXIT_SUCCESS;
+}
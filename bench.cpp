@@ -0,0 +1,890 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <SDL.h>
+#include "mg_stopwatch.h"
+#include "mg_broadphase.h"
+#include "mg_ratgeom.h"
+#include "mg_jobs.h"
+#include "mg_boids.h"
+#include "mg_gravity.h"
+#include "mg_flow.h"
+#include "mg_particles.h"
+#include "mg_present.h"
+#include "mg_pixfmt.h"
+#include "mg_raster.h"
+#include "mg_polyline.h"
+#include "mg_camera.h"
+#include "mg_path.h"
+#include "mg_audio.h"
+#include "mg_fft.h"
+
+/* *************What is this?***************
+ * Benchmarks for the game-libs, away from the game loop (no window, no VSYNC).
+ *
+ *      $ make bench
+ *
+ * Each Bench:: function sets up its own data, runs it for a while, and
+ * prints one line per size. Build is -O2, same as you'd ship.
+ * *******************************/
+
+namespace Bench
+{
+    ////////////
+    // FUNCTIONS
+    ////////////
+    float rnd(void);                                    // Random float in [0:1]
+    void sweep_and_prune(int count, float world_w, float world_h, int frames);
+    void rotations(int count, int reps);
+    void boids(Jobs::Pool&, int count, int frames);
+    void gravity(Jobs::Pool&, int count, float theta, int frames);
+    void flow(Jobs::Pool&, int count, int frames);
+    void particles(Jobs::Pool&, int per_second, float life_seconds, int frames);
+    void present(int art_w, int art_h, int win_w, int win_h, int frames);
+    void convert(int w, int h, int frames);
+    void stroke(int segments, int frames);
+    void curves(Jobs::Pool&, int count, float length, int frames);
+    void camera(int worlds, int frames);
+    void paths(Jobs::Pool&, int size, int count);
+    void mixer(int voices, int samples, int buffers);
+    void bank(int samples, int buffers);
+    void fft(int n, int reps);
+    void analyzer(float seconds);
+}
+
+float Bench::rnd(void)
+{
+    return static_cast<float>(std::rand())/static_cast<float>(RAND_MAX);
+}
+
+void Bench::sweep_and_prune(int count, float world_w, float world_h, int frames)
+{ // Boxes drift and bounce around the world: incremental sweep vs sorting from scratch
+    /* *************DOC***************
+     * Boxes are 4 to 16 pixels wide (about the size of the curves in the curve
+     * pool) and move up to 1 pixel per frame. Every frame, both broad phases
+     * find the overlapping pairs. They must agree on how many.
+     * *******************************/
+    SDL_FRect* boxes = (SDL_FRect*)malloc(sizeof(SDL_FRect)*count);
+    float* vx = (float*)malloc(sizeof(float)*count);
+    float* vy = (float*)malloc(sizeof(float)*count);
+    int* order = (int*)malloc(sizeof(int)*count);
+    constexpr int MAX_PAIRS = 1<<22;
+    Broadphase::Pair* pairs = (Broadphase::Pair*)malloc(sizeof(Broadphase::Pair)*MAX_PAIRS);
+    for (int i=0; i<count; i++)
+    {
+        float w = 4 + 12*rnd(); float h = 4 + 12*rnd();
+        boxes[i] = SDL_FRect{.x=(world_w-w)*rnd(), .y=(world_h-h)*rnd(), .w=w, .h=h};
+        vx[i] = 2*rnd() - 1; vy[i] = 2*rnd() - 1;
+    }
+    Broadphase::Sweep sweep;
+    Broadphase::alloc(sweep, count);
+    Broadphase::update(sweep, boxes, count, pairs, MAX_PAIRS); // First frame sorts from scratch
+
+    Stopwatch::Tally incremental{"incremental"};
+    Stopwatch::Tally scratch{"from scratch"};
+    long pairs_total = 0; long swaps_total = 0; long resorts = 0;
+    for (int f=0; f<frames; f++)
+    {
+        for (int i=0; i<count; i++)
+        { // Move and bounce
+            SDL_FRect& b = boxes[i];
+            b.x += vx[i]; b.y += vy[i];
+            if (b.x < 0)             vx[i] =  std::fabs(vx[i]);
+            if (b.x + b.w > world_w) vx[i] = -std::fabs(vx[i]);
+            if (b.y < 0)             vy[i] =  std::fabs(vy[i]);
+            if (b.y + b.h > world_h) vy[i] = -std::fabs(vy[i]);
+        }
+        incremental.start();
+        int n = Broadphase::update(sweep, boxes, count, pairs, MAX_PAIRS);
+        incremental.stop();
+        scratch.start();
+        int m = Broadphase::sweep(boxes, count, order, pairs, MAX_PAIRS);
+        scratch.stop();
+        assert(n == m);
+        if (n != m) printf("MISMATCH: incremental found %d pairs, from scratch found %d\n", n, m);
+        pairs_total += n; swaps_total += sweep.swaps; resorts += sweep.resorted;
+    }
+    printf("%7d boxes, %6.0fx%-5.0f : %7ld pairs/frame, incremental %8.1f us (%8ld swaps, %3ld/%d resorted), "
+           "from scratch %8.1f us\n",
+           count, world_w, world_h, pairs_total/frames, incremental.avg_us(), swaps_total/frames,
+           resorts, frames, scratch.avg_us());
+    Broadphase::release(sweep);
+    free(boxes); free(vx); free(vy); free(order); free(pairs);
+}
+
+void Bench::rotations(int count, int reps)
+{ // Rotate count objects, each by its own angle: rational [cos, sin] vs <cmath> cos and sin
+    /* *************DOC***************
+     * Each object has a parameter: the half-angle tangent t for the rational
+     * version, the angle θ for cmath (same rotations: θ = 2*atan(t)). Every rep
+     * finds each object's [cos, sin] and rotates its point (structure-of-arrays).
+     *
+     * Also checks how far the two disagree, and how far a float Rotation
+     * composed over and over drifts from the exact Turn.
+     * *******************************/
+    float* t = (float*)malloc(sizeof(float)*count);
+    float* theta = (float*)malloc(sizeof(float)*count);
+    float* x = (float*)malloc(sizeof(float)*count); float* y = (float*)malloc(sizeof(float)*count);
+    float* rx = (float*)malloc(sizeof(float)*count); float* ry = (float*)malloc(sizeof(float)*count);
+    float* cx = (float*)malloc(sizeof(float)*count); float* cy = (float*)malloc(sizeof(float)*count);
+    for (int i=0; i<count; i++)
+    {
+        t[i] = 2*rnd() - 1;                             // -90 to 90 degrees
+        theta[i] = 2*std::atan(t[i]);
+        x[i] = 100*rnd(); y[i] = 100*rnd();
+    }
+    Stopwatch::Tally rational{"rational"};
+    Stopwatch::Tally trig{"cmath"};
+    for (int r=0; r<reps; r++)
+    {
+        rational.start();
+        for (int i=0; i<count; i++)
+        { // Same math as RatCircle::x and RatCircle::y
+            float tt = t[i]*t[i];
+            float inv = 1/(1 + tt);
+            float c = (1 - tt)*inv; float s = 2*t[i]*inv;
+            rx[i] = c*x[i] - s*y[i]; ry[i] = s*x[i] + c*y[i];
+        }
+        rational.stop();
+        trig.start();
+        for (int i=0; i<count; i++)
+        {
+            float c = std::cos(theta[i]); float s = std::sin(theta[i]);
+            cx[i] = c*x[i] - s*y[i]; cy[i] = s*x[i] + c*y[i];
+        }
+        trig.stop();
+    }
+    float worst = 0;
+    for (int i=0; i<count; i++) worst = std::fmax(worst, RatGeom::quadrance({rx[i],ry[i]}, {cx[i],cy[i]}));
+    printf("%8d objects : rational %8.1f us, cmath %8.1f us (%.1fx), farthest apart %.2g px\n",
+           count, rational.avg_us(), trig.avg_us(), trig.avg_us()/rational.avg_us(), std::sqrt(worst));
+    free(t); free(theta); free(x); free(y); free(rx); free(ry); free(cx); free(cy);
+}
+
+void Bench::boids(Jobs::Pool& pool, int count, int frames)
+{ // Flock count agents for a while: agents per millisecond, and does it flock?
+    /* *************DOC***************
+     * Same crowding as the 4096 spinners in the game art: the world grows
+     * with the agent count. "Lined up" is |Σ v| / Σ |v| of the agents in a grid
+     * cell (averaged over cells): about 0.5 for 2-3 agents going random ways,
+     * 1 for all going the same way. Neighbors line up as the flocks form.
+     * *******************************/
+    const float k = std::sqrt(static_cast<float>(count)/4096);
+    Boids::Flock f;
+    Boids::alloc(f, count, 1280*k, 720*k, Boids::default_rules());
+    for (int i=0; i<count; i++) Boids::add(f, f.w*rnd(), f.h*rnd(), rnd()-0.5f, rnd()-0.5f);
+    auto lined_up = [&f]()
+    { // Average over grid cells (with 2+ agents) of |Σ v|/Σ |v| : do neighbors go the same way?
+        Boids::sort(f);
+        double total = 0; int cells = 0;
+        for (int c=0; c<f.gw*f.gh; c++)
+        {
+            if (f.cell_start[c+1] - f.cell_start[c] < 2) continue;
+            double sx = 0; double sy = 0; double s = 0;
+            for (int k=f.cell_start[c]; k<f.cell_start[c+1]; k++)
+            {
+                sx += f.svx[k]; sy += f.svy[k]; s += std::sqrt(f.svx[k]*f.svx[k] + f.svy[k]*f.svy[k]);
+            }
+            if (s > 0) { total += std::sqrt(sx*sx + sy*sy)/s; cells++; }
+        }
+        return (cells > 0) ? total/cells : 0.0;
+    };
+    const double before = lined_up();
+    Stopwatch::Tally sort_time{"sort"};
+    Stopwatch::Tally steer_time{"steer"};
+    for (int frame=0; frame<frames; frame++)
+    { // Same as Boids::step, timed in two parts
+        sort_time.start();
+        Boids::sort(f);
+        sort_time.stop();
+        steer_time.start();
+        Jobs::parallel_for(pool, f.count, 1<<11, [&f](int begin, int end) { Boids::steer(f, begin, end); });
+        steer_time.stop();
+    }
+    const double us = sort_time.avg_us() + steer_time.avg_us();
+    printf("%7d agents (%d threads): %8.1f us/frame (sort %7.1f, steer %8.1f) = %6.0f agents/ms, "
+           "lined up %.2f -> %.2f\n",
+           count, Jobs::threads(pool), us, sort_time.avg_us(), steer_time.avg_us(), count/(us/1000),
+           before, lined_up());
+    Boids::release(f);
+}
+
+void Bench::gravity(Jobs::Pool& pool, int count, float theta, int frames)
+{ // Barnes-Hut vs the direct sum: time per frame and how far off the pulls are
+    /* *************DOC***************
+     * The direct sum is N^2, too slow to run at N=10^6 (10^12 pulls). So it
+     * only runs for SAMPLE bodies (against all N), and its full frame time is
+     * that times N/SAMPLE. The sample is also the accuracy check: the error
+     * of a body is |a_tree - a_direct|/|a_direct|.
+     *
+     * Bodies start scattered in a disk (same crowding as 4096 spinners in the
+     * game art) and fall together for the frames that are timed.
+     * *******************************/
+    constexpr int SAMPLE = 256;
+    const float k = std::sqrt(static_cast<float>(count)/4096);
+    Gravity::Rules rules = Gravity::default_rules();
+    rules.theta = theta;
+    Gravity::Bodies b;
+    Gravity::alloc(b, count, 0, 0, rules);          // No walls
+    for (int i=0; i<count; i++)
+    { // Uniform in a disk of radius 360k (sqrt: uniform in area, not bunched in the middle)
+        float r = 360*k*std::sqrt(rnd()); float a = 6.2831853f*rnd();
+        Gravity::add(b, 640*k + r*std::cos(a), 360*k + r*std::sin(a), 0, 0, 1);
+    }
+    Stopwatch::Tally sort_time{"sort"};
+    Stopwatch::Tally build_time{"build"};
+    Stopwatch::Tally pull_time{"pull"};
+    for (int frame=0; frame<frames; frame++)
+    { // Same as Gravity::step, timed in three parts
+        sort_time.start();  Gravity::sort(b);  sort_time.stop();
+        build_time.start(); Gravity::build(b); build_time.stop();
+        pull_time.start();
+        Jobs::parallel_for(pool, b.count, 1<<10, [&b](int begin, int end) { Gravity::pull(b, begin, end); });
+        pull_time.stop();
+    }
+    // Accuracy and direct sum time, on the last positions
+    Gravity::sort(b); Gravity::build(b);
+    float tree_x[SAMPLE]; float tree_y[SAMPLE]; float exact_x[SAMPLE]; float exact_y[SAMPLE];
+    Stopwatch::Tally direct_time{"direct"};
+    direct_time.start();
+    Jobs::parallel_for(pool, SAMPLE, 8, [&](int begin, int end)
+    {
+        for (int s=begin; s<end; s++)
+        {
+            const int i = static_cast<int>((static_cast<long>(s)*count)/SAMPLE);
+            Gravity::direct(b, b.x[i], b.y[i], exact_x[s], exact_y[s]);
+        }
+    });
+    direct_time.stop();
+    double total_err = 0; double worst = 0;
+    for (int s=0; s<SAMPLE; s++)
+    {
+        const int i = static_cast<int>((static_cast<long>(s)*count)/SAMPLE);
+        Gravity::accel(b, b.x[i], b.y[i], tree_x[s], tree_y[s]);
+        double ex = tree_x[s] - exact_x[s]; double ey = tree_y[s] - exact_y[s];
+        double err = std::sqrt((ex*ex + ey*ey)/(exact_x[s]*exact_x[s] + exact_y[s]*exact_y[s] + 1e-30));
+        total_err += err; worst = std::fmax(worst, err);
+    }
+    const double us = sort_time.avg_us() + build_time.avg_us() + pull_time.avg_us();
+    const double direct_us = direct_time.avg_us()*count/SAMPLE;
+    printf("%8d bodies, theta %.2f (%d threads): %10.1f us/frame (sort %8.1f, build %7.1f, pull %10.1f), "
+           "%7d nodes | direct ~%12.0f us (%5.0fx) | error avg %.1e, worst %.1e\n",
+           count, theta, Jobs::threads(pool), us, sort_time.avg_us(), build_time.avg_us(), pull_time.avg_us(),
+           b.nnodes, direct_us, direct_us/us, total_err/SAMPLE, worst);
+    Gravity::release(b);
+}
+
+void Bench::flow(Jobs::Pool& pool, int count, int frames)
+{ // Particles ride the cached wind: time per frame, vs working out the wind per particle
+    /* *************DOC***************
+     * Same field as GameDemo::FLOW (game art size, 32 pixel cells, a snapshot
+     * every 6 frames). "formula" moves the same particles with Flow::wind()
+     * at each one instead of the grid: that's what the cache saves. "off by"
+     * is how far the grid's wind is from the formula's, at the particles.
+     * *******************************/
+    Flow::Field f;
+    Flow::alloc(f, 1280, 720, 32, 1.0f, 6);
+    float* x = (float*)malloc(sizeof(float)*count); float* y = (float*)malloc(sizeof(float)*count);
+    for (int i=0; i<count; i++) { x[i] = f.w*rnd(); y[i] = f.h*rnd(); }
+    x[0] = 0; y[0] = 0;                             // (Corners of the world wrap)
+    Stopwatch::Tally update_time{"update"};
+    Stopwatch::Tally advect_time{"advect"};
+    for (int frame=0; frame<frames; frame++)
+    {
+        update_time.start();
+        Flow::update(f);
+        update_time.stop();
+        advect_time.start();
+        Jobs::parallel_for(pool, count, 1<<14, [&](int begin, int end) { Flow::advect(f, x, y, begin, end, 1); });
+        advect_time.stop();
+    }
+    // The uncached way, for a few frames
+    Stopwatch::Tally formula_time{"formula"};
+    for (int frame=0; frame<3; frame++)
+    {
+        const float t = static_cast<float>(f.tick + frame);
+        formula_time.start();
+        Jobs::parallel_for(pool, count, 1<<14, [&](int begin, int end)
+        {
+            for (int i=begin; i<end; i++)
+            {
+                float u; float v;
+                Flow::wind(f, x[i], y[i], t, u, v);
+                x[i] = std::fmod(x[i] + u + f.w, f.w); y[i] = std::fmod(y[i] + v + f.h, f.h);
+            }
+        });
+        formula_time.stop();
+    }
+    // How far off is the grid? Snapshot now, compare at the particles.
+    Flow::snapshot(f, static_cast<float>(f.tick), f.u, f.v);
+    float worst = 0; bool inside = true;
+    for (int i=0; i<count; i+=97)
+    {
+        float u; float v; float gx = x[i]; float gy = y[i];
+        Flow::wind(f, x[i], y[i], static_cast<float>(f.tick), u, v);
+        Flow::advect(f, &gx, &gy, 0, 1, 1);         // Grid wind = how far it moved
+        float ex = std::remainder(gx - x[i] - u, f.w); float ey = std::remainder(gy - y[i] - v, f.h);
+        worst = std::fmax(worst, std::sqrt(ex*ex + ey*ey));
+    }
+    for (int i=0; i<count; i++) inside = inside && (x[i] >= 0) && (x[i] <= f.w) && (y[i] >= 0) && (y[i] <= f.h);
+    printf("%8d particles (%d threads, grid %dx%d): %8.1f us/frame (update %5.1f, advect %8.1f) | "
+           "formula %9.1f us (%4.1fx) | wind off by %.3f px/frame (speed %.1f/wave)%s\n",
+           count, Jobs::threads(pool), f.gw, f.gh, update_time.avg_us() + advect_time.avg_us(),
+           update_time.avg_us(), advect_time.avg_us(), formula_time.avg_us(),
+           formula_time.avg_us()/advect_time.avg_us(), worst, f.speed, inside ? "" : " ESCAPED THE WORLD");
+    free(x); free(y);
+    Flow::release(f);
+}
+
+void Bench::particles(Jobs::Pool& pool, int per_second, float life_seconds, int frames)
+{ // Spawn per_second particles a second (at 60 Hz) that live life_seconds: cost of the churn
+    /* *************DOC***************
+     * After life_seconds the pool is full of particles of every age, and
+     * every frame as many die as are born (rate = per_second/60 each way).
+     * The pool has 25% room to spare (life jitter). Times are per frame.
+     * *******************************/
+    const float rate = static_cast<float>(per_second)/60;
+    const float life = 60*life_seconds;
+    Particles::Pool p;
+    Particles::alloc(p, static_cast<int>(1.25f*rate*life) + 1, 0, 0.02f, 0.01f);
+    Particles::Emitter e = {
+        .x=640, .y=360, .radius=8, .rate=rate, .carry=0,
+        .heading=0, .spread=3.1415927f, .speed=2, .speed_jitter=1,
+        .life=life, .life_jitter=0.2f*life, .seed=1
+    };
+    Stopwatch::Tally emit_time{"emit"};
+    Stopwatch::Tally update_time{"update"};
+    Stopwatch::Tally kill_time{"kill"};
+    long most = 0;
+    for (int frame=0; frame<frames; frame++)
+    {
+        emit_time.start();
+        Particles::emit(p, e);
+        emit_time.stop();
+        update_time.start();
+        Jobs::parallel_for(pool, p.count, 1<<14, [&p](int begin, int end) { Particles::update(p, begin, end); });
+        update_time.stop();
+        kill_time.start();
+        Particles::kill(p);
+        kill_time.stop();
+        if (p.count > most) most = p.count;
+    }
+    const double us = emit_time.avg_us() + update_time.avg_us() + kill_time.avg_us();
+    printf("%8d/s, live %4.1fs (%d threads): %8.1f us/frame (emit %7.1f, update %7.1f, kill %7.1f) | "
+           "%7ld live at most, %3.0f%% of a 60 Hz frame, %ld dropped\n",
+           per_second, life_seconds, Jobs::threads(pool), us, emit_time.avg_us(), update_time.avg_us(),
+           kill_time.avg_us(), most, 100*us/16667, p.dropped);
+    Particles::release(p);
+}
+
+void Bench::present(int art_w, int art_h, int win_w, int win_h, int frames)
+{ // Integer upscale of the game art into a window-sized buffer, vs a generic scaled blit
+    /* *************DOC***************
+     * "generic" is what a scaled blit does without knowing K: for every
+     * window pixel, which game art pixel? (A multiply and divide per pixel.)
+     * Both also pay for clearing the whole window every frame, like the OS
+     * WINDOW section does. "integer" is Present::upscale, no clear: the bars
+     * only get cleared on a resize.
+     * *******************************/
+    const int K = std::min(win_w/art_w, win_h/art_h);
+    const int x0 = (win_w - K*art_w)/2; const int y0 = (win_h - K*art_h)/2;
+    uint32_t* art = (uint32_t*)malloc(sizeof(uint32_t)*art_w*art_h);
+    uint32_t* win = (uint32_t*)malloc(sizeof(uint32_t)*win_w*win_h);
+    uint32_t* check = (uint32_t*)malloc(sizeof(uint32_t)*win_w*win_h);
+    for (int i=0; i<art_w*art_h; i++) art[i] = static_cast<uint32_t>(std::rand());
+    Stopwatch::Tally generic_time{"generic"};
+    Stopwatch::Tally integer_time{"integer"};
+    for (int frame=0; frame<frames; frame++)
+    {
+        generic_time.start();
+        memset(check, 0, sizeof(uint32_t)*win_w*win_h);
+        for (int y=0; y<K*art_h; y++)
+        {
+            const uint32_t* src = art + static_cast<long>((y*art_h)/(K*art_h))*art_w;
+            uint32_t* dst = check + static_cast<long>(y0 + y)*win_w + x0;
+            for (int x=0; x<K*art_w; x++) dst[x] = src[(x*art_w)/(K*art_w)];
+        }
+        generic_time.stop();
+        integer_time.start();
+        Present::upscale(art, art_w, art_h, art_w, win + static_cast<long>(y0)*win_w + x0, win_w, K);
+        integer_time.stop();
+    }
+    bool same = true;                               // Same pixels in the game art rectangle?
+    for (int y=y0; y<y0 + K*art_h; y++)
+    {
+        same = same && (memcmp(win + static_cast<long>(y)*win_w + x0, check + static_cast<long>(y)*win_w + x0,
+                                sizeof(uint32_t)*K*art_w) == 0);
+    }
+    printf("%4dx%-4d -> %4dx%-4d (K=%2d): generic + clear %8.1f us, integer %8.1f us (%4.1fx), %.1f GB/s written%s\n",
+           art_w, art_h, win_w, win_h, K, generic_time.avg_us(), integer_time.avg_us(),
+           generic_time.avg_us()/integer_time.avg_us(),
+           (4.0*K*art_w*K*art_h)/(integer_time.avg_us()*1000), same ? "" : " DIFFERENT PIXELS");
+    free(art); free(win); free(check);
+}
+
+void Bench::convert(int w, int h, int frames)
+{ // What one pixel format conversion costs: a texture upload that converts vs one that doesn't
+    /* *************DOC***************
+     * "native" is an upload in the renderer's format: a plain copy. "convert"
+     * is what SDL does for a format the renderer doesn't list: unpack every
+     * pixel (RGBA8888) and pack it again (ARGB8888). With PixFmt::Packing the
+     * shifts are constants, which is the best case for a conversion.
+     * *******************************/
+    const int n = w*h;
+    Uint32* src = (Uint32*)malloc(sizeof(Uint32)*n);
+    Uint32* dst = (Uint32*)malloc(sizeof(Uint32)*n);
+    for (int i=0; i<n; i++) src[i] = static_cast<Uint32>(std::rand());
+    Stopwatch::Tally native_time{"native"};
+    Stopwatch::Tally convert_time{"convert"};
+    using From = PixFmt::Packing<SDL_PIXELFORMAT_RGBA8888>;
+    volatile Uint32 sink = 0;                       // (So the copies are not optimized away)
+    for (int frame=0; frame<frames; frame++)
+    {
+        native_time.start();
+        memcpy(dst, src, sizeof(Uint32)*n);
+        native_time.stop();
+        sink = sink + dst[frame % n];
+        convert_time.start();
+        for (int i=0; i<n; i++)
+        {
+            const Uint32 p = src[i];
+            dst[i] = PixFmt::pack<SDL_PIXELFORMAT_ARGB8888>((p >> From::R) & 0xFF, (p >> From::G) & 0xFF,
+                                                            (p >> From::B) & 0xFF, (p >> From::A) & 0xFF);
+        }
+        convert_time.stop();
+        sink = sink + dst[frame % n];
+    }
+    printf("%4dx%-4d : native %7.1f us, convert %7.1f us (%4.1fx, %4.1f%% of a 60 Hz frame)\n",
+           w, h, native_time.avg_us(), convert_time.avg_us(), convert_time.avg_us()/native_time.avg_us(),
+           100.0*convert_time.avg_us()/16667.0);
+    free(src); free(dst);
+}
+
+void Bench::stroke(int segments, int frames)
+{ // A zigzag from the top of the canvas to the bottom and back: every segment is a span per row
+    /* *************DOC***************
+     * segments*720 spans is more than Raster::MAX_SPANS for segments > 91:
+     * the polyline outgrows the span scratch. Every pixel must still be
+     * blended once (with the max coverage of the capsules that touch it),
+     * so no pixel can come out more opaque than c.a (a join blended twice
+     * would). Checked on the last frame.
+     * *******************************/
+    Raster::Canvas canvas;
+    Raster::alloc(canvas, 1280, 720, SDL_PIXELFORMAT_ARGB8888);
+    SDL_FPoint* points = (SDL_FPoint*)malloc(sizeof(SDL_FPoint)*(segments+1));
+    for (int i=0; i<=segments; i++)
+    {
+        points[i] = SDL_FPoint{.x=10 + 1260.0f*i/segments, .y=(i%2) ? 715.0f : 5.0f};
+    }
+    const SDL_Color c = {.r=255, .g=200, .b=0, .a=128};
+    Stopwatch::Tally stroke_time{"stroke"};
+    for (int f=0; f<frames; f++)
+    {
+        Raster::clear(canvas);
+        stroke_time.start(); Raster::stroke(canvas, points, segments+1, 2.5f, c); stroke_time.stop();
+    }
+    Uint32 most = 0;                                // Most opaque pixel
+    for (int i=0; i<canvas.w*canvas.h; i++) most = std::max(most, canvas.pixels[i] >> 24);
+    printf("%4d segments (%6d rows) : %8.1f us avg per polyline, most opaque pixel %u (color alpha %u)\n",
+           segments, segments*720, stroke_time.avg_us(), most, c.a);
+    assert(most <= c.a);
+    Raster::release(canvas);
+    free(points);
+}
+
+void Bench::curves(Jobs::Pool& pool, int count, float length, int frames)
+{ // count quadratic curves about length pixels across, RDP'd, stroked in one Batch on every thread
+    /* *************DOC***************
+     * Same polylines the game strokes: K=128 samples of a quadratic, RDP at
+     * 0.5 px, 2.5 px wide, on a 1280x720 canvas (scale=80). Then the same
+     * frame again with no workers: the canvases must match pixel for pixel
+     * (bands blend in Batch order, same as one polyline at a time).
+     * *******************************/
+    constexpr int K = 128;
+    Raster::Canvas canvas; Raster::Canvas alone;
+    Raster::alloc(canvas, 1280, 720, SDL_PIXELFORMAT_ARGB8888);
+    Raster::alloc(alone, 1280, 720, SDL_PIXELFORMAT_ARGB8888);
+    Raster::Batch batch;
+    Raster::alloc(batch, count, count*K);
+    SDL_FPoint* lines = (SDL_FPoint*)malloc(sizeof(SDL_FPoint)*count*K);
+    int* nlines = (int*)malloc(sizeof(int)*count);
+    SDL_Color* colors = (SDL_Color*)malloc(sizeof(SDL_Color)*count);
+    for (int i=0; i<count; i++)
+    { // Control points in a length x length box somewhere on the canvas
+        const float x = rnd()*(1280 - length); const float y = rnd()*(720 - length);
+        const SDL_FPoint p0 = {x + rnd()*length, y + rnd()*length};
+        const SDL_FPoint p1 = {x + rnd()*length, y + rnd()*length};
+        const SDL_FPoint p2 = {x + rnd()*length, y + rnd()*length};
+        SDL_FPoint* l = &lines[i*K];
+        for (int k=0; k<K; k++)
+        {
+            const float t = static_cast<float>(k)/(K-1); const float s = 1-t;
+            l[k] = SDL_FPoint{s*s*p0.x + 2*s*t*p1.x + t*t*p2.x, s*s*p0.y + 2*s*t*p1.y + t*t*p2.y};
+        }
+        nlines[i] = Polyline::rdp(l, K, 0.5f);
+        colors[i] = SDL_Color{static_cast<Uint8>(rnd()*255), static_cast<Uint8>(rnd()*255), 255, 255};
+    }
+    auto frame = [&](Raster::Canvas& cv, Jobs::Pool& p, Stopwatch::Tally& t)
+    {
+        Raster::clear(cv);
+        t.start();
+        for (int i=0; i<count; i++) Raster::add(batch, &lines[i*K], nlines[i], colors[i]);
+        Raster::stroke(cv, p, batch, 2.5f);
+        t.stop();
+    };
+    Stopwatch::Tally pool_time{"pool"}; Stopwatch::Tally alone_time{"alone"};
+    Jobs::Pool one; Jobs::start(one, 0);            // (The calling thread does it all)
+    for (int f=0; f<frames; f++) frame(canvas, pool, pool_time);
+    for (int f=0; f<std::max(frames/4, 1); f++) frame(alone, one, alone_time);
+    Jobs::stop(one);
+    const bool same = (memcmp(canvas.pixels, alone.pixels, sizeof(Uint32)*canvas.w*canvas.h) == 0);
+    printf("%6d curves %4.0f px : %2d threads %8.1f us, 1 thread %8.1f us (%4.1fx), %4.1f%% of a 60 Hz frame, %s\n",
+           count, length, Jobs::threads(pool), pool_time.avg_us(), alone_time.avg_us(),
+           alone_time.avg_us()/pool_time.avg_us(), 100.0*pool_time.avg_us()/16667.0,
+           (same) ? "same pixels" : "PIXELS DIFFER");
+    assert(same);
+    Raster::release(canvas); Raster::release(alone); Raster::release(batch);
+    free(lines); free(nlines); free(colors);
+}
+
+void Bench::camera(int worlds, int frames)
+{ // Cull 4096 things per game art (the spinners' crowding) in a world of worlds x worlds game arts
+    /* *************DOC***************
+     * The camera sees one game art (1280x720, zoom 1). "scan" asks every
+     * thing if it is on screen. "bin" is the counting sort (every thing, but
+     * a few adds each), "query" only visits the cells on screen. The things
+     * on screen are what gets drawn: that count stays the same as the world
+     * grows, and so does query.
+     * *******************************/
+    const float W = 1280.0f*worlds; const float H = 720.0f*worlds;
+    const int count = 4096*worlds*worlds;
+    float* x = (float*)malloc(sizeof(float)*count); float* y = (float*)malloc(sizeof(float)*count);
+    float* r = (float*)malloc(sizeof(float)*count);
+    int* shown = (int*)malloc(sizeof(int)*count);
+    for (int i=0; i<count; i++) { x[i] = rnd()*W; y[i] = rnd()*H; r[i] = 2 + 61*rnd(); }
+    Camera::Grid grid;
+    Camera::alloc(grid, count, W, H, 64);
+    Camera::View cam = {.x=0, .y=0, .zoom=1, .w=1280, .h=720};
+    Stopwatch::Tally scan_time{"scan"}; Stopwatch::Tally bin_time{"bin"}; Stopwatch::Tally query_time{"query"};
+    long nscan = 0; long nquery = 0;
+    for (int frame=0; frame<frames; frame++)
+    { // The camera drifts across the world
+        cam.x = (W - 1280)*static_cast<float>(frame)/frames; cam.y = (H - 720)*static_cast<float>(frame)/frames;
+        const SDL_FRect see = Camera::visible(cam);
+        scan_time.start();
+        int n = 0;
+        for (int i=0; i<count; i++)
+        {
+            shown[n] = i;
+            n += Camera::overlaps(SDL_FRect{.x=x[i]-r[i], .y=y[i]-r[i], .w=2*r[i], .h=2*r[i]}, see);
+        }
+        scan_time.stop();
+        nscan += n;
+        bin_time.start();
+        Camera::bin(grid, x, y, r, count);
+        bin_time.stop();
+        query_time.start();
+        nquery += Camera::query(grid, x, y, r, see, shown);
+        query_time.stop();
+    }
+    assert(nscan == nquery);                            // (Same things, in a different order)
+    printf("%2dx%-2d worlds, %7d things : %4ld on screen, scan %7.1f us, bin %7.1f us, query %5.1f us\n",
+           worlds, worlds, count, nquery/frames, scan_time.avg_us(), bin_time.avg_us(), query_time.avg_us());
+    Camera::release(grid);
+    free(x); free(y); free(r); free(shown);
+}
+
+void Bench::paths(Jobs::Pool& pool, int size, int count)
+{ // Paths per second on a size x size grid of rectangular walls: A*, JPS, JPS batched, JPS batched and cached
+    /* *************DOC***************
+     * A* and JPS answer the same random requests on one thread (and must
+     * agree on every length). "batched" is Path::find on every thread with
+     * an empty cache. "cached" is agents that start near each other (16
+     * start chunks) going to 8 goals: most requests are cache hits.
+     * *******************************/
+    Path::Grid grid;
+    Path::alloc(grid, size, size);
+    for (int k=0; k<size*size/400; k++)
+    { // ~25% walls, in rectangles up to 16 cells across
+        const int x = static_cast<int>(rnd()*size); const int y = static_cast<int>(rnd()*size);
+        const int w = 1 + static_cast<int>(rnd()*16); const int h = 1 + static_cast<int>(rnd()*16);
+        for (int j=y; j<std::min(y+h, size); j++) for (int i=x; i<std::min(x+w, size); i++) grid.wall[j*size + i] = 1;
+    }
+    auto open_cell = [&](int cx, int cy, int spread, int& x, int& y)
+    { // Random open cell within spread of (cx,cy)
+        do
+        {
+            x = std::min(std::max(cx + static_cast<int>((rnd() - 0.5f)*spread), 0), size-1);
+            y = std::min(std::max(cy + static_cast<int>((rnd() - 0.5f)*spread), 0), size-1);
+        } while (!Path::open(grid, x, y));
+    };
+    Path::Request* req = (Path::Request*)malloc(sizeof(Path::Request)*count);
+    Path::Result* res = (Path::Result*)malloc(sizeof(Path::Result)*count);
+    SDL_Point* points = (SDL_Point*)malloc(sizeof(SDL_Point)*count*Path::MAX_POINTS);
+    for (int i=0; i<count; i++)
+    {
+        open_cell(size/2, size/2, size, req[i].sx, req[i].sy);
+        open_cell(size/2, size/2, size, req[i].gx, req[i].gy);
+        res[i].points = &points[i*Path::MAX_POINTS];
+    }
+    Path::Searcher s;
+    Path::alloc(s, grid);
+    SDL_Point* a = (SDL_Point*)malloc(sizeof(SDL_Point)*Path::MAX_POINTS);
+    Path::Result ra = {.points=a, .n=0, .length=0, .cached=false};
+    Stopwatch::Tally astar_time{"A*"}; Stopwatch::Tally jps_time{"JPS"};
+    long astar_expanded = 0; long found = 0;
+    const int nastar = std::max(count/8, 1);        // (A* is slow: fewer of them)
+    for (int i=0; i<nastar; i++)
+    {
+        const long e = s.expanded;
+        astar_time.start(); Path::astar(s, grid, req[i], ra); astar_time.stop();
+        astar_expanded += s.expanded - e;
+        jps_time.start(); Path::jps(s, grid, req[i], res[i]); jps_time.stop();
+        assert((ra.n > 0) == (res[i].n > 0));
+        assert(std::fabs(ra.length - res[i].length) < 1e-2f*ra.length + 1e-3f);
+        found += (ra.n > 0);
+    }
+    const long jps_expanded = s.expanded - astar_expanded;
+    Path::Service sv;
+    Path::alloc(sv, grid, Jobs::threads(pool), count);
+    Stopwatch::Tally batch_time{"batched"}; Stopwatch::Tally cached_time{"cached"};
+    batch_time.start(); Path::find(sv, pool, req, count, res); batch_time.stop();
+    int cx[16], cy[16], gx[8], gy[8];
+    for (int k=0; k<16; k++) open_cell(size/2, size/2, size, cx[k], cy[k]);
+    for (int k=0; k<8; k++) open_cell(size/2, size/2, size, gx[k], gy[k]);
+    for (int i=0; i<count; i++)
+    { // An agent near one of 16 spots, going to one of 8 goals
+        const int k = static_cast<int>(rnd()*16)%16;
+        open_cell(cx[k], cy[k], Path::CHUNK/2, req[i].sx, req[i].sy);
+        const int gk = static_cast<int>(rnd()*8)%8; req[i].gx = gx[gk]; req[i].gy = gy[gk];
+    }
+    const long hits = sv.hits;
+    cached_time.start(); Path::find(sv, pool, req, count, res); cached_time.stop();
+    printf("%dx%d, %d paths (%ld%% found) : A* %7.0f/s (%ld cells expanded), JPS %7.0f/s (%ld), "
+           "batched %7.0f/s, cached %8.0f/s (%ld%% hits)\n",
+           size, size, count, 100*found/nastar,
+           1e6*astar_time.laps/astar_time.total_us, astar_expanded/nastar,
+           1e6*jps_time.laps/jps_time.total_us, jps_expanded/nastar,
+           1e6*count/batch_time.total_us, 1e6*count/cached_time.total_us, 100*(sv.hits - hits)/count);
+    Path::release(sv); Path::release(s); Path::release(grid);
+    free(req); free(res); free(points); free(a);
+}
+
+void Bench::mixer(int voices, int samples, int buffers)
+{ // Time to mix voices into one buffer (no device, no callback), next to the buffer's deadline
+    Audio::Engine e;
+    Audio::init(e, 48000, samples);
+    for (int v=0; v<voices; v++)
+    { // Every voice at once, never fading (the worst case for the mixer)
+        Audio::apply(e, Audio::Command{.op=Audio::PLAY, .voice=v, .pitch=110.0f + 20*v,
+                .gain=1.0f/voices, .pan=2*rnd() - 1, .decay=0});
+    }
+    Stopwatch::Tally mix_time{"mix"};
+    for (int b=0; b<buffers; b++)
+    {
+        mix_time.start(); Audio::mix(e, e.left, e.right, e.spec.samples); mix_time.stop();
+    }
+    printf("%2d voices, %4d samples (%5.0f us of sound) : %6.1f us avg, %6.1f us max per buffer (%4.1f%% of the deadline)\n",
+           voices, e.spec.samples, e.period_us, mix_time.avg_us(), mix_time.max_us, 100*mix_time.avg_us()/e.period_us);
+    Audio::close(e);
+}
+
+void Bench::bank(int samples, int buffers)
+{ // Oscillators in a Bank: double them until one buffer takes longer to mix than it takes to play
+    Audio::Engine e;
+    Audio::init(e, 48000, samples);
+    int fit = 0;                                    // Most oscillators that made the deadline
+    for (int count=1024; count<=(1<<20); count*=2)
+    {
+        Audio::Bank b;
+        Audio::alloc(b, count);
+        for (int i=0; i<count; i++)
+        { // Random pitches and pans (every oscillator on)
+            Audio::set(Audio::back(b), i, 110*std::exp2(5*rnd()), 0.5f/std::sqrt(static_cast<float>(count)), 2*rnd() - 1, 48000);
+        }
+        Audio::back(b).count = count;
+        Audio::publish(b);
+        Audio::take(b);
+        Stopwatch::Tally mix_time{"mix bank"};
+        for (int k=0; k<buffers; k++)
+        {
+            for (int t=0; t<e.spec.samples; t++) { e.left[t] = 0; e.right[t] = 0; }
+            mix_time.start(); Audio::mix(b, e.left, e.right, e.spec.samples); mix_time.stop();
+        }
+        printf("%7d oscillators, %d samples : %8.1f us avg, %8.1f us max per buffer (%5.1f%% of the %.0f us deadline)\n",
+               count, e.spec.samples, mix_time.avg_us(), mix_time.max_us, 100*mix_time.avg_us()/e.period_us, e.period_us);
+        Audio::release(b);
+        if (mix_time.avg_us() > e.period_us) break;
+        fit = count;
+    }
+    printf("most oscillators mixed within the deadline: %d (one core)\n", fit);
+    Audio::close(e);
+}
+
+void Bench::fft(int n, int reps)
+{ // Real FFT (half-size complex FFT, untangled) vs the plain DFT it replaces
+    Fft::Plan p;
+    Fft::alloc(p, n);
+    float* x = (float*)malloc(sizeof(float)*n);
+    float* power = (float*)malloc(sizeof(float)*(n/2+1));
+    for (int i=0; i<n; i++) x[i] = 2*rnd() - 1;
+    Stopwatch::Tally fft_time{"fft"};
+    for (int r=0; r<reps; r++) { fft_time.start(); Fft::real_fft(p, x, power); fft_time.stop(); }
+    Stopwatch::Tally dft_time{"dft"};
+    double off = 0; double biggest = 0;             // Worst difference, biggest power
+    dft_time.start();
+    for (int k=0; k<=n/2; k++)
+    { // (Angles in double: this is the reference)
+        double re = 0; double im = 0;
+        for (int i=0; i<n; i++)
+        {
+            const double a = 6.283185307179586*(static_cast<long>(k)*i%n)/n;
+            re += x[i]*p.window[i]*std::cos(a); im -= x[i]*p.window[i]*std::sin(a);
+        }
+        off = std::max(off, std::fabs(re*re + im*im - power[k])); biggest = std::max(biggest, re*re + im*im);
+    }
+    dft_time.stop();
+    printf("%5d point window : FFT %7.1f us, DFT %9.1f us (%6.0fx), off by %.1g (of the biggest power)\n",
+           n, fft_time.avg_us(), dft_time.total_us, dft_time.total_us/fft_time.avg_us(), off/biggest);
+    Fft::release(p);
+    free(x); free(power);
+}
+
+void Bench::analyzer(float seconds)
+{ // A drum loop through the Analyzer thread, as fast as it will go: the render thread side asks for every frame
+    const int freq = 48000;
+    const long frames = static_cast<long>(seconds*freq);
+    float* track = (float*)malloc(sizeof(float)*2*frames);
+    for (long i=0; i<frames; i++)
+    { // Kick (55 Hz, every half second) and a hi-hat (3 kHz, on the off beats)
+        const float t = static_cast<float>(i)/freq;
+        const float beat = std::fmod(t, 0.5f);
+        const float kick = std::sin(Audio::TWO_PI*55*t)*std::exp(-12*beat);
+        const float hat = (beat >= 0.25f) ? 0.3f*std::sin(Audio::TWO_PI*3000*t) : 0.0f;
+        track[2*i] = 0.6f*(kick + hat); track[2*i+1] = track[2*i];
+    }
+    Fft::Analyzer a;
+    Stopwatch::Tally run_time{"analyzer"};
+    run_time.start();
+    Fft::start(a, track, frames, freq);
+    const long last = frames/Fft::HOP;
+    double on = 0; double off = 0; int non = 0; int noff = 0; // Bass level on the kick, between kicks
+    for (long k=0; k<last; k++)
+    {
+        while (a.produced.load() <= k) std::this_thread::yield(); // (Wait for it: this isn't playback)
+        const Fft::Frame& f = Fft::frame_at(a, k*Fft::HOP);
+        const float beat = std::fmod(static_cast<float>(f.at)/freq, 0.5f);
+        if (beat < 0.05f) { on += f.bands[0]; non++; }
+        else if ((beat > 0.3f) && (beat < 0.45f)) { off += f.bands[0]; noff++; }
+    }
+    run_time.stop();
+    Fft::stop(a);
+    printf("%.0f s of sound in %.1f ms (%.0fx real time), %ld frames : bass %.2f on the kick, %.2f between kicks\n",
+           seconds, run_time.total_us/1e3, 1e6*seconds/run_time.total_us, last, on/non, off/noff);
+    free(track);
+}
+
+int main(int, char**)
+{
+    std::srand(1);                                      // Same boxes every run
+    puts("--- Broad phase: incremental sweep and prune ---");
+    // Spread out: the world grows with the box count (same crowding as 1000 boxes in the game art)
+    for (int count : {1000, 10000, 100000})
+    {
+        float k = std::sqrt(static_cast<float>(count)/1000);
+        Bench::sweep_and_prune(count, 1280*k, 720*k, (count < 100000) ? 400 : 100);
+    }
+    // Packed: every box in the game art (crowded, boxes pass each other all the time)
+    for (int count : {1000, 10000, 100000})
+    {
+        Bench::sweep_and_prune(count, 1280, 720, (count < 100000) ? 400 : 20);
+    }
+    puts("--- Rotations: rational vs cmath ---");
+    for (int count : {1000, 100000, 1000000}) Bench::rotations(count, (count < 1000000) ? 200 : 20);
+    { // Exact Turns vs float Rotations composed over and over
+        RatGeom::Turn exact = RatGeom::NO_TURN;
+        RatGeom::Rotation r = RatGeom::rotation(RatGeom::NO_TURN);
+        const RatGeom::Turn step = RatGeom::turn(1,2);  // [3/5, 4/5]
+        int k = 0;
+        for (; (exact.q < (1LL<<31)/5) && (k < 100); k++)
+        { // Until the exact numbers get too big to compose again
+            exact = RatGeom::compose(exact, step);
+            r = RatGeom::compose(r, RatGeom::rotation(step));
+        }
+        RatGeom::Rotation e = RatGeom::rotation(exact);
+        printf("turn(1,2) composed %d times: exact q=%lld, float Rotation off by %.2g\n",
+               k, exact.q, std::sqrt(RatGeom::quadrance({e.c,e.s}, {r.c,r.s})));
+        r = RatGeom::rotation(RatGeom::NO_TURN);
+        for (int i=0; i<1000000; i++) r = RatGeom::compose(r, RatGeom::rotation(step));
+        printf("turn(1,2) composed 1000000 times as floats: c^2+s^2-1 = %.2g\n", r.c*r.c + r.s*r.s - 1);
+    }
+    puts("--- Boids: spinner flock ---");
+    {
+        Jobs::Pool pool;
+        Jobs::start(pool);
+        for (int count : {4096, 10000, 100000}) Bench::boids(pool, count, (count < 100000) ? 300 : 100);
+        Jobs::stop(pool);
+    }
+    puts("--- Gravity: Barnes-Hut vs direct sum ---");
+    {
+        Jobs::Pool pool;
+        Jobs::start(pool);
+        for (int count : {4096, 100000, 1000000}) Bench::gravity(pool, count, 0.5f, (count < 100000) ? 60 : 4);
+        for (float theta : {0.25f, 0.75f, 1.0f}) Bench::gravity(pool, 100000, theta, 4);  // Accuracy vs speed
+        Jobs::stop(pool);
+    }
+    puts("--- Flow field: particles on a cached wind ---");
+    {
+        Jobs::Pool pool;
+        Jobs::start(pool);
+        for (int count : {4096, 100000, 1000000}) Bench::flow(pool, count, (count < 1000000) ? 600 : 120);
+        Jobs::stop(pool);
+    }
+    puts("--- Particles: spawn and kill churn ---");
+    {
+        Jobs::Pool pool;
+        Jobs::start(pool);
+        Bench::particles(pool, 100000, 1, 300);
+        Bench::particles(pool, 1000000, 1, 180);        // 1M born and 1M die every second
+        Bench::particles(pool, 1000000, 0.1f, 180);     // Same churn, short lives: a small pool
+        Jobs::stop(pool);
+    }
+    puts("--- Present: game art to the OS window on the CPU ---");
+    Bench::present(1280, 720, 1920, 1080, 100);         // scale=80, 1080p (K=1: just a copy)
+    Bench::present(1280, 720, 3840, 2160, 100);         // scale=80, 4K
+    Bench::present(320, 180, 3840, 2160, 100);          // scale=20, 4K
+    Bench::present(160, 90, 3840, 2160, 100);           // scale=10, 4K
+    puts("--- Pixel format: upload in the renderer's format vs one that converts ---");
+    Bench::convert(1280, 720, 200);                     // Game art or stroke canvas, scale=80
+    Bench::convert(1920, 1080, 100);                    // 1080p window surface
+    puts("--- Stroke: one polyline, more rows than the span scratch starts with ---");
+    for (int segments : {16, 200}) Bench::stroke(segments, 100);
+    puts("--- Stroke: a Batch of curves, bands of rows on every thread ---");
+    {
+        Jobs::Pool pool;
+        Jobs::start(pool);
+        for (float length : {100.0f, 700.0f}) Bench::curves(pool, 10000, length, (length < 200) ? 40 : 8);
+        Jobs::stop(pool);
+    }
+    puts("--- Camera: cull what is off screen ---");
+    for (int worlds : {1, 4, 16}) Bench::camera(worlds, (worlds < 16) ? 200 : 40);
+    puts("--- Paths: A* vs Jump Point Search, batched on every thread, cached ---");
+    {
+        Jobs::Pool pool;
+        Jobs::start(pool);
+        Bench::paths(pool, 256, 800);
+        Bench::paths(pool, 1024, 200);
+        Jobs::stop(pool);
+    }
+    puts("--- Audio mixer: one buffer of sine voices ---");
+    for (int samples : {64, 128, 512}) Bench::mixer(Audio::MAX_VOICES, samples, 2000);
+    Bench::mixer(8, 128, 2000);
+    puts("--- Audio bank: how many oscillators fit in a 128 sample buffer ---");
+    Bench::bank(128, 200);
+    puts("--- FFT: spectrum of one window, then a whole track on the analyzer thread ---");
+    for (int n : {512, 2048, 8192}) Bench::fft(n, 2000);
+    Bench::analyzer(30);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+#ifndef __MG_ALIAS_H__
+#define __MG_ALIAS_H__
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include "mg_jobs.h"
+
+namespace Alias
+{ // Which spinner settings alias (jump, strobe, stutter) and which look smooth
+    /* *************Where spinner aliasing comes from***************
+     * A spinner draws point phase = counter%COUNT of its circle. Every video
+     * frame the counter goes up by speed, and the counter is a BITS-bit unsigned
+     * int, so it wraps at 2^BITS. Four things can look wrong:
+     *
+     *      spokes  : if speed and COUNT share a factor g = gcd(speed, COUNT),
+     *                the spinner only ever lands on every g-th point. It jumps
+     *                around COUNT/g spots instead of COUNT.
+     *
+     *      wrap    : when the counter wraps, phase jumps by an extra
+     *                -(2^BITS % COUNT) points. Unless COUNT divides 2^BITS,
+     *                the spinner hiccups once every 2^BITS/speed frames.
+     *
+     *      strobe  : the eye sees the shortest way between two frames. A step
+     *                of more than COUNT/2 points looks like a small step
+     *                BACKWARDS (the wagon wheel in old westerns).
+     *
+     *      squirm  : the rational circle's points bunch up toward the end of
+     *                each quarter (see "The case for parametric graphics"), so
+     *                the spinner speeds up and slows down 4 times a revolution.
+     *                If that happens faster than refresh/2 times a second, the
+     *                squirm itself aliases into a slow false wobble.
+     *
+     * analyze() works all of these out for one setting (period and coverage
+     * by stepping the counter through a full cycle, the rest by arithmetic).
+     * sweep() analyzes lots of settings on every core, and rank() sorts them,
+     * lowest score (least aliasing) first.
+     * *******************************/
+    struct Params
+    {
+        int count;                          // Points in the circle (Spinner::COUNT, 4*N)
+        int speed;                          // Counter increments per frame
+        int bits;                           // Counter width (Spinner::counter is 16 bits)
+        float refresh;                      // Frames per second
+    };
+
+    struct Report
+    {
+        Params p;
+        long period;                        // Frames until the spinner does exactly the same thing again
+        int visited;                        // Points it ever lands on (COUNT is best)
+        int spokes;                         // gcd(speed, COUNT): 1 is best
+        int wrap_jump;                      // Extra points jumped when the counter wraps (0 is best)
+        float wrap_every;                   // Seconds between wrap jumps
+        int step;                           // Step the eye sees each frame (negative : looks backwards)
+        float revs;                         // True revolutions per second
+        float seen_revs;                    // Revolutions per second the eye sees
+        float squirm;                       // Quarter-turn speed wobbles per second
+        bool squirm_aliased;                // squirm is faster than refresh/2
+        float score;                        // Sum of the penalties (lower is better)
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    Report analyze(Params p);                       // One setting
+    void sweep(Jobs::Pool&, const Params* settings, int count, Report* out); // Many settings, in parallel
+    void rank(Report* reports, int count);          // Sort, lowest score first
+    float score(const Report*, int count);          // Total score of several settings (like all speeds)
+    void print(const Report&);
+    void print_header(void);
+}
+
+Alias::Report Alias::analyze(Params p)
+{ // Period, coverage, and aliasing of one spinner setting
+    /* *************DOC***************
+     * The score adds up, in "points of error per frame":
+     *
+     *      spokes - 1                  (lands g times coarser than it could)
+     *      wrap_jump / frames per wrap (the hiccup, averaged over time)
+     *      COUNT/2 if it looks backwards
+     *      COUNT/8 if the squirm aliases
+     *
+     * Not deep science, just enough to sort the obviously bad settings from
+     * the fine ones. The individual numbers are in the Report.
+     * *******************************/
+    assert((p.count > 0) && (p.speed > 0) && (p.bits > 0) && (p.bits <= 24));
+    Report r = {};
+    r.p = p;
+    const long wrap = 1L << p.bits;                 // Counter wraps here
+    const long s = p.speed % wrap;
+    // The counter cycles through wrap/gcd(s,wrap) values. The phase sequence repeats
+    // after that many frames, maybe sooner (check the halvings: the cycle is a power of 2).
+    const long cycle = wrap/std::gcd(s, wrap);
+    auto phase = [&](long f) { return static_cast<int>(((f*s) % wrap) % p.count); };
+    long period = cycle;
+    while ((period % 2) == 0)
+    {
+        long half = period/2;
+        bool repeats = true;
+        for (long f=0; (f<cycle) && repeats; f++) repeats = (phase(f) == phase((f+half) % cycle));
+        if (!repeats) break;
+        period = half;
+    }
+    r.period = period;
+    { // Points it lands on: step the counter and the phase together (no divides in the loop)
+        char* seen = (char*)calloc(p.count, 1);
+        const int step = static_cast<int>(s % p.count);
+        const int jump = static_cast<int>(wrap % p.count);   // Phase lost when the counter wraps
+        long counter = 0; int ph = 0;
+        for (long f=0; f<period; f++)
+        {
+            seen[ph] = 1;
+            counter += s; ph += step;
+            if (ph >= p.count) ph -= p.count;
+            if (counter >= wrap) { counter -= wrap; ph -= jump; if (ph < 0) ph += p.count; }
+        }
+        r.visited = 0;
+        for (int i=0; i<p.count; i++) r.visited += seen[i];
+        free(seen);
+    }
+    r.spokes = std::gcd(p.speed, p.count);
+    r.wrap_jump = static_cast<int>(wrap % p.count);
+    if (r.wrap_jump > p.count/2) r.wrap_jump -= p.count;    // Shortest way around
+    r.wrap_every = static_cast<float>(wrap)/(static_cast<float>(s)*p.refresh);
+    r.step = p.speed % p.count;
+    if (r.step > p.count/2) r.step -= p.count;
+    r.revs = p.refresh*static_cast<float>(p.speed)/static_cast<float>(p.count);
+    r.seen_revs = p.refresh*static_cast<float>(r.step)/static_cast<float>(p.count);
+    r.squirm = 4*r.revs;
+    r.squirm_aliased = (r.squirm > 0.5f*p.refresh);
+    r.score = static_cast<float>(r.spokes - 1)
+            + static_cast<float>(std::abs(r.wrap_jump))*static_cast<float>(s)/static_cast<float>(wrap)
+            + ((r.step < 0) ? 0.5f*p.count : 0.0f)
+            + (r.squirm_aliased ? 0.125f*p.count : 0.0f);
+    return r;
+}
+
+void Alias::sweep(Jobs::Pool& pool, const Params* settings, int count, Report* out)
+{ // analyze() every setting, spread across the pool (each one is independent)
+    // A setting is up to 2^bits frames of stepping: small chunks, so the big ones spread out
+    Jobs::parallel_for(pool, count, 4, [&](int begin, int end)
+    {
+        for (int i=begin; i<end; i++) out[i] = analyze(settings[i]);
+    });
+}
+
+void Alias::rank(Report* reports, int count)
+{
+    std::stable_sort(reports, reports+count, [](const Report& a, const Report& b) { return a.score < b.score; });
+}
+
+float Alias::score(const Report* reports, int count)
+{
+    float total = 0;
+    for (int i=0; i<count; i++) total += reports[i].score;
+    return total;
+}
+
+void Alias::print_header(void)
+{
+    printf("%6s %5s %4s %6s | %8s %7s %6s %5s %9s %5s %7s %7s %7s | %7s\n",
+           "COUNT", "speed", "bits", "Hz", "period", "visited", "spokes", "wrap", "every(s)",
+           "step", "rev/s", "seen", "squirm", "score");
+}
+
+void Alias::print(const Report& r)
+{
+    printf("%6d %5d %4d %6.1f | %8ld %7d %6d %5d %9.1f %5d %7.2f %7.2f %6.1f%s | %7.2f\n",
+           r.p.count, r.p.speed, r.p.bits, r.p.refresh, r.period, r.visited, r.spokes, r.wrap_jump,
+           r.wrap_every, r.step, r.revs, r.seen_revs, r.squirm, r.squirm_aliased ? "!" : " ", r.score);
+}
+
+#endif // __MG_ALIAS_H__
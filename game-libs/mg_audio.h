@@ -0,0 +1,550 @@
+#ifndef __MG_AUDIO_H__
+#define __MG_AUDIO_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "mg_stopwatch.h"
+
+namespace Audio
+{ // Sound: a mixer in the audio callback, fed by the game thread through a lock-free ring of commands
+    /* *************The audio callback has a deadline***************
+     * SDL asks for sound one buffer at a time, on its own thread (the
+     * callback). A 128 sample buffer at 48 kHz is 2.7 ms of sound, so the
+     * callback has less than 2.7 ms to fill it. If it misses the deadline,
+     * the sound card runs dry and you hear a click (an underrun).
+     *
+     * So the callback never waits on anything. It takes no locks (the game
+     * thread might hold one for a whole frame). It never calls malloc (that
+     * can take a lock too) and never prints. Everything it touches is
+     * allocated in open().
+     *
+     * The game thread talks to the mixer through a Ring of commands, with
+     * one producer (the game) and one consumer (the callback). Each side
+     * only writes its own index. A command is "there" when the head index
+     * moves past it (an atomic store after the command is written), so
+     * neither side ever waits on the other. If the ring is full, the command
+     * is dropped and counted: the game never waits either.
+     * *******************************/
+    /* *************Mixing LANES samples at once***************
+     * A voice is a sine wave at some pitch, with a gain that decays and a
+     * pan. Each sample of a sine is the last one turned by a fixed angle.
+     * That is a complex multiply, not a sin(), but it makes one long chain:
+     * each sample waits for the one before it.
+     *
+     * So each voice makes LANES samples at a time. The voice's phasor is
+     * turned by 0, 1, ... LANES-1 steps, using powers of the step made once
+     * per callback. Those LANES samples don't depend on each other. The loop
+     * over them has no branches and adds into separate output samples, so
+     * the compiler vectorizes it at -O2 (the Makefile's build). Then the
+     * phasor jumps LANES steps at once.
+     *
+     * The gain ramps (linearly) across the callback to where the decay
+     * puts it at the end, so a buffer boundary doesn't step the gain.
+     * *******************************/
+    /* *************A Bank: thousands of oscillators, retuned every frame***************
+     * A Bank is many sine oscillators (one per spinner, say) that the game
+     * retunes every video frame: new pitches, new pans. That is too much to
+     * send as commands. So the game writes a whole snapshot (Params) and
+     * publishes it, and the callback mixes with the latest one.
+     *
+     * There are three snapshots (a triple buffer):
+     *
+     *      - back: the game writes this one (nobody else touches it)
+     *      - middle: the last one published
+     *      - front: the callback mixes this one (nobody else touches it)
+     *
+     * publish() swaps back and middle, and take() swaps middle and front.
+     * Each swap is one atomic exchange, and a FRESH bit says whether the
+     * middle is newer than the front. Neither side waits. The callback
+     * never sees a half-written snapshot. If the game publishes twice
+     * between callbacks, the older snapshot is simply never mixed.
+     *
+     * Only the phasors and the gains the last buffer ended on belong to
+     * the callback. A new pitch picks up where the sine is, and a new pan
+     * ramps across the buffer, so retuning doesn't click.
+     * *******************************/
+    /* *************A Track: a WAV file, played over and over***************
+     * load() reads the whole file and converts it (once, with SDL's
+     * converter) to what the device plays: stereo floats at its rate. The
+     * callback then just copies from it, looping at the end.
+     *
+     * Track::played counts the frames the callback has handed to SDL, over
+     * every loop. It is the one thing the callback writes, so anyone (the
+     * render thread, Fft::Analyzer) can read where playback is without
+     * asking the callback anything. It runs ahead of what comes out of the
+     * speakers by about a buffer.
+     * *******************************/
+    constexpr int RING = 256;                           // Commands in flight (a power of 2)
+    constexpr int MAX_VOICES = 64;
+    constexpr int LANES = 8;                            // Samples of a voice mixed at once
+    constexpr float SILENT = 1e-4f;                     // Gain below this : voice is done
+    constexpr float TWO_PI = 6.2831853f;
+
+    enum Op { PLAY, STOP, VOLUME };
+
+    struct Command
+    {
+        int op;                             // PLAY, STOP, VOLUME
+        int voice;                          // PLAY, STOP: which voice (PLAY on a playing voice restarts it)
+        float pitch;                        // PLAY: Hz
+        float gain;                         // PLAY: starting gain. VOLUME: master volume.
+        float pan;                          // PLAY: -1 (left) to 1 (right)
+        float decay;                        // PLAY: seconds to fade to 1/1000 (0 : never fades)
+    };
+
+    struct Ring
+    { // One producer (the game thread), one consumer (the audio callback)
+        Command cmds[RING];
+        alignas(64) std::atomic<uint32_t> head; // Next command to write (only the producer writes it)
+        alignas(64) std::atomic<uint32_t> tail; // Next command to read (only the consumer writes it)
+        long dropped;                       // Pushes that found the ring full (producer side)
+    };
+
+    struct Params
+    { // One snapshot of the whole bank (written by the game thread)
+        float* c; float* s;                 // cos and sin of each oscillator's step (radians per sample)
+        float* left; float* right;          // Gain in each ear (0 : silent)
+        int count;                          // Oscillators [0:count) are mixed
+    };
+
+    struct Bank
+    {
+        Params params[3];                   // Triple buffer (see top of namespace)
+        int back;                           // Game thread's snapshot
+        std::atomic<int> middle;            // Last published (| FRESH : the callback hasn't taken it)
+        int front;                          // Callback's snapshot
+        float* re; float* im;               // Callback's: phasors
+        float* last_left; float* last_right; // Callback's: gains the last buffer ended on (ramp from these)
+        int capacity;
+        long published, taken;              // Snapshots published (game thread), taken (callback)
+    };
+    constexpr int FRESH = 4;                            // Bank::middle bit: published since the callback took it
+
+    struct Track
+    {
+        float* samples;                     // Interleaved stereo, at the device's rate (read only once loaded)
+        long frames;                        // Samples per ear
+        float gain;
+        std::atomic<long> played;           // Frames mixed so far, every loop (only the callback writes it)
+    };
+
+    struct Engine
+    {
+        SDL_AudioDeviceID dev;              // (0 : no sound)
+        SDL_AudioSpec spec;                 // What the device really opened
+        Ring ring;
+        // Voices (only the callback touches these once the device is open)
+        float re[MAX_VOICES], im[MAX_VOICES];   // Phasor (where the sine is)
+        float step[MAX_VOICES];             // Radians per sample
+        float gain[MAX_VOICES];             // Gain now
+        float fall[MAX_VOICES];             // Gain is multiplied by this every sample
+        float left_gain[MAX_VOICES], right_gain[MAX_VOICES]; // Pan
+        float volume;                       // Master volume (of the voices, not a bank)
+        float* left; float* right;          // Mix buffers (spec.samples each)
+        std::atomic<Bank*> bank;            // Mixed after the voices (NULL : none, see attach)
+        std::atomic<Track*> track;          // Mixed after the bank (NULL : none, see attach)
+        // Callback stats (read them after close)
+        Stopwatch::Tally callback_time{"audio callback"};
+        Stopwatch::Clock::time_point last_start;
+        double period_us;                   // Sound in one buffer: the callback's deadline
+        double max_gap_us;                  // Longest time from one callback to the next
+        long callbacks;
+        long late;                          // Callbacks that took longer than period_us
+        long gaps;                          // Callbacks that came more than 2 periods after the last
+        long commands;                      // Commands the callback applied
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    bool push(Ring&, const Command&);               // Game thread. false : ring full, dropped
+    bool pop(Ring&, Command&);                      // Audio callback. false : ring empty
+    void init(Engine&, int freq, int samples);      // No device (mix() by hand). Remember to close(engine)
+    bool open(Engine&, int freq, int samples);      // Start the sound. false : no sound. Remember to close(engine)
+    void close(Engine&);
+    void play(Engine&, int voice, float pitch, float gain, float pan, float decay);
+    void stop(Engine&, int voice);
+    void set_volume(Engine&, float volume);
+    void apply(Engine&, const Command&);            // Audio callback: do what a command says
+    void mix(Engine&, float* left, float* right, int frames); // Every voice into left, right
+    void alloc(Bank&, int capacity);                // Silent, phases spread out. Remember to release(bank)
+    void release(Bank&);                            // (Close the engine it is attached to first)
+    Params& back(Bank&);                            // Game thread: the snapshot to fill in
+    void set(Params&, int i, float pitch, float gain, float pan, int freq); // Game thread: one oscillator
+    void publish(Bank&);                            // Game thread: the callback mixes back from now on
+    bool take(Bank&);                               // Audio callback: false : nothing new, keep front
+    void mix(Bank&, float* left, float* right, int frames); // Add the bank into left, right
+    void attach(Engine&, Bank*);                    // Any thread, any time (NULL : detach)
+    bool load(Track&, const char* file, const Engine&); // WAV file, converted for the engine. Remember to release(track)
+    void release(Track&);                           // (Close the engine it is attached to first)
+    void mix(Track&, float* left, float* right, int frames); // Add the track into left, right
+    void attach(Engine&, Track*);                   // Any thread, any time (NULL : detach)
+    void callback(void* engine, Uint8* stream, int len); // SDL_AudioCallback
+    void print(const Engine&);                      // Callback stats
+}
+
+bool Audio::push(Ring& r, const Command& c)
+{
+    const uint32_t head = r.head.load(std::memory_order_relaxed);
+    if (head - r.tail.load(std::memory_order_acquire) == RING) { r.dropped++; return false; }
+    r.cmds[head & (RING-1)] = c;
+    r.head.store(head + 1, std::memory_order_release); // (Command is written before the head says so)
+    return true;
+}
+
+bool Audio::pop(Ring& r, Command& c)
+{
+    const uint32_t tail = r.tail.load(std::memory_order_relaxed);
+    if (tail == r.head.load(std::memory_order_acquire)) return false;
+    c = r.cmds[tail & (RING-1)];
+    r.tail.store(tail + 1, std::memory_order_release); // (Slot is read before the producer can reuse it)
+    return true;
+}
+
+void Audio::init(Engine& e, int freq, int samples)
+{ // Stereo floats, samples per buffer rounded up to LANES, every voice silent
+    e.dev = 0;
+    e.ring.head = 0; e.ring.tail = 0; e.ring.dropped = 0;
+    for (int v=0; v<MAX_VOICES; v++)
+    {
+        e.re[v] = 1; e.im[v] = 0; e.step[v] = 0; e.gain[v] = 0; e.fall[v] = 1;
+        e.left_gain[v] = 0; e.right_gain[v] = 0;
+    }
+    e.volume = 1;
+    e.bank = NULL; e.track = NULL;
+    e.callback_time = Stopwatch::Tally{"audio callback"};
+    e.max_gap_us = 0; e.callbacks = 0; e.late = 0; e.gaps = 0; e.commands = 0;
+    samples = (samples + LANES-1)/LANES*LANES;
+    e.spec = SDL_AudioSpec{};
+    e.spec.freq = freq; e.spec.format = AUDIO_F32SYS; e.spec.channels = 2;
+    e.spec.samples = static_cast<Uint16>(samples);
+    e.spec.callback = callback; e.spec.userdata = &e;
+    e.period_us = 1e6*samples/freq;
+    e.left = (float*)malloc(sizeof(float)*samples); e.right = (float*)malloc(sizeof(float)*samples);
+}
+
+bool Audio::open(Engine& e, int freq, int samples)
+{ // init(), then open the device and start the callbacks
+    /* *************DOC***************
+     * SDL converts to whatever the sound card wants, so the device always
+     * takes this format and buffer size. The callback gets a pointer to e:
+     * e must not move until close(e).
+     *
+     * Test without a sound card: SDL_AUDIODRIVER=dummy (silence) or
+     * SDL_AUDIODRIVER=disk (writes the sound to a file).
+     *
+     * SDL's audio subsystem is started here, not in SDL_Init: a game that
+     * never opens the sound never pays for it, and one that does can open
+     * it after the first frame is up (starting the driver can take as long
+     * as making the renderer). close() stops it again.
+     * *******************************/
+    init(e, freq, samples);
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0)
+    {
+        printf("No sound: %s\n", SDL_GetError());
+        close(e);
+        return false;
+    }
+    const SDL_AudioSpec want = e.spec;
+    e.dev = SDL_OpenAudioDevice(NULL, 0, &want, &e.spec, 0); // (No changes allowed: SDL converts)
+    if (e.dev == 0)
+    {
+        printf("No sound: %s\n", SDL_GetError());
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        close(e);
+        return false;
+    }
+    SDL_PauseAudioDevice(e.dev, 0);                 // Callbacks start now
+    return true;
+}
+
+void Audio::close(Engine& e)
+{ // (After this the callback stats are safe to read)
+    if (e.dev != 0)
+    {
+        SDL_CloseAudioDevice(e.dev);
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);          // (open() started it)
+    }
+    free(e.left); free(e.right);
+    e.left = NULL; e.right = NULL;
+    e.dev = 0;
+}
+
+void Audio::play(Engine& e, int voice, float pitch, float gain, float pan, float decay)
+{
+    push(e.ring, Command{.op=PLAY, .voice=voice, .pitch=pitch, .gain=gain, .pan=pan, .decay=decay});
+}
+
+void Audio::stop(Engine& e, int voice)
+{
+    push(e.ring, Command{.op=STOP, .voice=voice, .pitch=0, .gain=0, .pan=0, .decay=0});
+}
+
+void Audio::set_volume(Engine& e, float volume)
+{
+    push(e.ring, Command{.op=VOLUME, .voice=0, .pitch=0, .gain=volume, .pan=0, .decay=0});
+}
+
+void Audio::apply(Engine& e, const Command& c)
+{ // (No allocation, no waiting: this runs in the callback)
+    if (c.op == VOLUME) { e.volume = c.gain; return; }
+    if ((c.voice < 0) || (c.voice >= MAX_VOICES)) return;
+    const int v = c.voice;
+    if (c.op == STOP) { e.gain[v] = 0; return; }
+    e.re[v] = 1; e.im[v] = 0;                       // Start the sine at 0: no click
+    e.step[v] = TWO_PI*c.pitch/e.spec.freq;
+    e.gain[v] = c.gain;
+    // Fall to 1/1000 in decay seconds: fall^(decay*freq) = 1/1000
+    e.fall[v] = (c.decay > 0) ? std::pow(1e-3f, 1.0f/(c.decay*e.spec.freq)) : 1.0f;
+    const float angle = (TWO_PI/8)*(std::min(std::max(c.pan, -1.0f), 1.0f) + 1); // Equal power pan
+    e.left_gain[v] = std::cos(angle); e.right_gain[v] = std::sin(angle);
+}
+
+void Audio::mix(Engine& e, float* __restrict left, float* __restrict right, int frames)
+{ // Add up every voice that isn't silent (frames : a multiple of LANES)
+    assert(frames%LANES == 0);
+    for (int t=0; t<frames; t++) { left[t] = 0; right[t] = 0; }
+    for (int v=0; v<MAX_VOICES; v++)
+    {
+        if (e.gain[v] < SILENT) continue;
+        // The step turned 0 to LANES-1 times, and LANES times
+        float wr[LANES]; float wi[LANES];
+        const float cr = std::cos(e.step[v]); const float ci = std::sin(e.step[v]);
+        wr[0] = 1; wi[0] = 0;
+        for (int k=1; k<LANES; k++)
+        {
+            wr[k] = wr[k-1]*cr - wi[k-1]*ci; wi[k] = wr[k-1]*ci + wi[k-1]*cr;
+        }
+        const float jr = wr[LANES-1]*cr - wi[LANES-1]*ci; const float ji = wr[LANES-1]*ci + wi[LANES-1]*cr;
+        // Gain ramps from g0 now to g1 at the end of the buffer
+        const float g0 = e.gain[v]*e.volume;
+        const float g1 = g0*std::pow(e.fall[v], static_cast<float>(frames));
+        const float dg = (g1 - g0)/frames;
+        const float gl = e.left_gain[v]; const float gr = e.right_gain[v];
+        float pr = e.re[v]; float pi = e.im[v];
+        for (int b=0; b<frames; b+=LANES)
+        {
+            for (int k=0; k<LANES; k++)
+            { // Im(p*w^k): the sine k samples from now
+                const float s = (pr*wi[k] + pi*wr[k])*(g0 + dg*static_cast<float>(b + k));
+                left[b+k] += gl*s; right[b+k] += gr*s;
+            }
+            const float nr = pr*jr - pi*ji; pi = pr*ji + pi*jr; pr = nr;
+        }
+        const float m = 1/std::sqrt(pr*pr + pi*pi);     // (Rounding slowly changes |p|: put it back to 1)
+        e.re[v] = pr*m; e.im[v] = pi*m;
+        e.gain[v] *= std::pow(e.fall[v], static_cast<float>(frames));
+    }
+}
+
+void Audio::alloc(Bank& b, int capacity)
+{
+    b.capacity = capacity;
+    for (Params& p : b.params)
+    {
+        p.c = (float*)malloc(sizeof(float)*capacity); p.s = (float*)malloc(sizeof(float)*capacity);
+        p.left = (float*)malloc(sizeof(float)*capacity); p.right = (float*)malloc(sizeof(float)*capacity);
+        p.count = 0;
+    }
+    b.back = 0; b.middle = 1; b.front = 2;
+    b.re = (float*)malloc(sizeof(float)*capacity); b.im = (float*)malloc(sizeof(float)*capacity);
+    b.last_left = (float*)calloc(capacity, sizeof(float)); b.last_right = (float*)calloc(capacity, sizeof(float));
+    for (int i=0; i<capacity; i++)
+    { // Golden angle apart: thousands of sines that all start at 0 would add up to a spike
+        b.re[i] = std::cos(2.3999632f*i); b.im[i] = std::sin(2.3999632f*i);
+    }
+    b.published = 0; b.taken = 0;
+}
+
+void Audio::release(Bank& b)
+{
+    for (Params& p : b.params)
+    {
+        free(p.c); free(p.s); free(p.left); free(p.right);
+        p = Params{.c=NULL, .s=NULL, .left=NULL, .right=NULL, .count=0};
+    }
+    free(b.re); free(b.im); free(b.last_left); free(b.last_right);
+    b.re = NULL; b.im = NULL; b.last_left = NULL; b.last_right = NULL;
+    b.capacity = 0;
+}
+
+Audio::Params& Audio::back(Bank& b)
+{
+    return b.params[b.back];
+}
+
+void Audio::set(Params& p, int i, float pitch, float gain, float pan, int freq)
+{ // (The cos and sin are worked out here, once a frame, not in the callback)
+    const float step = TWO_PI*pitch/freq;
+    p.c[i] = std::cos(step); p.s[i] = std::sin(step);
+    const float angle = (TWO_PI/8)*(std::min(std::max(pan, -1.0f), 1.0f) + 1); // Equal power pan
+    p.left[i] = gain*std::cos(angle); p.right[i] = gain*std::sin(angle);
+}
+
+void Audio::publish(Bank& b)
+{ // Back becomes the middle (and is fresh), the old middle is the new back
+    b.back = b.middle.exchange(b.back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+    b.published++;
+}
+
+bool Audio::take(Bank& b)
+{ // Middle becomes the front, if it is fresh (else the front is already the latest)
+    if ((b.middle.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+    b.front = b.middle.exchange(b.front, std::memory_order_acq_rel) & ~FRESH;
+    b.taken++;
+    return true;
+}
+
+void Audio::mix(Bank& b, float* __restrict left, float* __restrict right, int frames)
+{ // Like mix(Engine&), but each oscillator's ear gains ramp from the last buffer's to the snapshot's
+    assert(frames%LANES == 0);
+    const Params& p = b.params[b.front];
+    const float inv = 1.0f/frames;
+    for (int i=0; i<p.count; i++)
+    {
+        const float l1 = p.left[i]; const float r1 = p.right[i];
+        const float l0 = b.last_left[i]; const float r0 = b.last_right[i];
+        b.last_left[i] = l1; b.last_right[i] = r1;
+        if ((l0 == 0) && (r0 == 0) && (l1 == 0) && (r1 == 0)) continue;
+        float wr[LANES]; float wi[LANES];
+        const float cr = p.c[i]; const float ci = p.s[i];
+        wr[0] = 1; wi[0] = 0;
+        for (int k=1; k<LANES; k++)
+        {
+            wr[k] = wr[k-1]*cr - wi[k-1]*ci; wi[k] = wr[k-1]*ci + wi[k-1]*cr;
+        }
+        const float jr = wr[LANES-1]*cr - wi[LANES-1]*ci; const float ji = wr[LANES-1]*ci + wi[LANES-1]*cr;
+        const float dl = (l1 - l0)*inv; const float dr = (r1 - r0)*inv;
+        float pr = b.re[i]; float pi = b.im[i];
+        for (int t=0; t<frames; t+=LANES)
+        {
+            for (int k=0; k<LANES; k++)
+            {
+                const float s = pr*wi[k] + pi*wr[k];
+                const float f = static_cast<float>(t + k);
+                left[t+k] += (l0 + dl*f)*s; right[t+k] += (r0 + dr*f)*s;
+            }
+            const float nr = pr*jr - pi*ji; pi = pr*ji + pi*jr; pr = nr;
+        }
+        const float m = 1/std::sqrt(pr*pr + pi*pi);
+        b.re[i] = pr*m; b.im[i] = pi*m;
+    }
+}
+
+void Audio::attach(Engine& e, Bank* b)
+{
+    e.bank.store(b, std::memory_order_release);
+}
+
+bool Audio::load(Track& t, const char* file, const Engine& e)
+{ // false : no track (says why)
+    t.samples = NULL; t.frames = 0; t.gain = 1; t.played = 0;
+    SDL_AudioSpec spec; Uint8* buf; Uint32 len;
+    if (SDL_LoadWAV(file, &spec, &buf, &len) == NULL)
+    {
+        printf("No track: %s\n", SDL_GetError());
+        return false;
+    }
+    SDL_AudioCVT cvt;
+    if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq, AUDIO_F32SYS, 2, e.spec.freq) < 0)
+    {
+        printf("No track: %s\n", SDL_GetError());
+        SDL_FreeWAV(buf);
+        return false;
+    }
+    cvt.len = static_cast<int>(len);
+    cvt.buf = (Uint8*)malloc(static_cast<size_t>(len)*cvt.len_mult); // (Converts in place: room for the biggest step)
+    memcpy(cvt.buf, buf, len);
+    SDL_FreeWAV(buf);
+    if (SDL_ConvertAudio(&cvt) < 0)
+    {
+        printf("No track: %s\n", SDL_GetError());
+        free(cvt.buf);
+        return false;
+    }
+    t.samples = reinterpret_cast<float*>(cvt.buf);
+    t.frames = cvt.len_cvt/static_cast<int>(2*sizeof(float));
+    if (t.frames == 0) { printf("No track: %s is empty\n", file); release(t); return false; }
+    return true;
+}
+
+void Audio::release(Track& t)
+{
+    free(t.samples);
+    t.samples = NULL; t.frames = 0;
+}
+
+void Audio::mix(Track& t, float* __restrict left, float* __restrict right, int frames)
+{ // Copy in runs up to the end of the track, then loop
+    const float* __restrict in = t.samples;
+    long at = t.played.load(std::memory_order_relaxed) % t.frames;
+    int done = 0;
+    while (done < frames)
+    {
+        const int run = static_cast<int>(std::min(static_cast<long>(frames - done), t.frames - at));
+        for (int k=0; k<run; k++)
+        {
+            left[done+k] += t.gain*in[2*(at+k)]; right[done+k] += t.gain*in[2*(at+k)+1];
+        }
+        done += run; at += run;
+        if (at == t.frames) at = 0;
+    }
+    t.played.fetch_add(frames, std::memory_order_release);
+}
+
+void Audio::attach(Engine& e, Track* t)
+{
+    e.track.store(t, std::memory_order_release);
+}
+
+void Audio::callback(void* engine, Uint8* stream, int len)
+{ // Commands, mix, interleave (and time it all)
+    Engine& e = *static_cast<Engine*>(engine);
+    const Stopwatch::Clock::time_point now = Stopwatch::Clock::now();
+    if (e.callbacks > 0)
+    { // How long since the last callback (much longer than a period: the sound card ran dry)
+        const double gap = std::chrono::duration<double, std::micro>(now - e.last_start).count();
+        e.max_gap_us = std::max(e.max_gap_us, gap);
+        e.gaps += (gap > 2*e.period_us);
+    }
+    e.last_start = now;
+    e.callback_time.start();
+    Command c;
+    while (pop(e.ring, c)) { apply(e, c); e.commands++; }
+    const int frames = len/static_cast<int>(2*sizeof(float));
+    assert(frames <= e.spec.samples);
+    mix(e, e.left, e.right, frames);
+    Bank* bank = e.bank.load(std::memory_order_acquire);
+    if (bank != NULL)
+    {
+        take(*bank);
+        mix(*bank, e.left, e.right, frames);
+    }
+    Track* track = e.track.load(std::memory_order_acquire);
+    if (track != NULL) mix(*track, e.left, e.right, frames);
+    float* out = reinterpret_cast<float*>(stream);
+    for (int t=0; t<frames; t++)
+    { // (Clip, don't wrap)
+        out[2*t] = std::min(std::max(e.left[t], -1.0f), 1.0f);
+        out[2*t+1] = std::min(std::max(e.right[t], -1.0f), 1.0f);
+    }
+    e.callback_time.stop();
+    e.late += (e.callback_time.last_us > e.period_us);
+    e.callbacks++;
+}
+
+void Audio::print(const Engine& e)
+{
+    e.callback_time.print();
+    printf("audio buffers            : %d samples at %d Hz (%.0f us each), %ld late, %ld gaps (longest %.0f us), "
+           "%ld commands, %ld dropped\n",
+           e.spec.samples, e.spec.freq, e.period_us, e.late, e.gaps, e.max_gap_us, e.commands, e.ring.dropped);
+}
+
+#endif // __MG_AUDIO_H__
@@ -0,0 +1,237 @@
+#ifndef __MG_BOIDS_H__
+#define __MG_BOIDS_H__
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include "mg_jobs.h"
+
+namespace Boids
+{ // Flocking: every agent steers by its neighbors (Reynolds' boids)
+    /* *************The three rules***************
+     * Each frame, each agent looks at the agents within SEE pixels of it:
+     *
+     *      separation : steer away from neighbors that are too close (within
+     *                   PERSONAL), harder the closer they are
+     *      alignment  : steer toward the average velocity of the neighbors
+     *      cohesion   : steer toward the average position of the neighbors
+     *
+     * Add up the three steers (each with a weight), add a push back inside near
+     * the edges of the world, clamp the speed, move. That's a flock.
+     *
+     * Finding neighbors: checking every agent against every other is N^2. So
+     * drop the agents into a grid of SEE-sized cells (a counting sort by cell),
+     * and each agent only checks the 3x3 cells around its own. The sort also
+     * copies the positions and velocities into cell order, so the agents in a
+     * cell are next to each other in memory: the neighbor loop is a plain loop
+     * over contiguous floats, no branches (a mask instead of an if), which
+     * the compiler can vectorize.
+     *
+     * Every agent only READS the sorted copies and only WRITES its own slot, so
+     * the agents can be split across threads with Jobs::parallel_for.
+     * *******************************/
+    struct Rules
+    {
+        float see;                          // Neighbor radius (also the grid cell size)
+        float personal;                     // Separation radius
+        float separate;                     // Weights of the three rules
+        float align;
+        float cohere;
+        float min_speed;                    // Pixels per frame
+        float max_speed;
+        float margin;                       // Start turning back this close to the edge
+        float turn;                         // How hard to turn back
+    };
+
+    struct Flock
+    {
+        // Agents, structure-of-arrays, in agent order (agent i is always i)
+        float* x; float* y;                 // Position
+        float* vx; float* vy;               // Velocity (pixels per frame)
+        int count;
+        int capacity;
+        float w, h;                         // World size: agents stay in [0:w]x[0:h]
+        Rules rules;
+        // Grid (rebuilt every step)
+        int gw, gh;                         // Grid size in cells
+        int* cell_start;                    // Agents in cell c are sorted [cell_start[c]:cell_start[c+1])
+        int* cell_of;                       // Scratch: cell of each agent
+        int* order;                         // order[k] : agent in sorted slot k
+        float* sx; float* sy;               // Sorted copies (cell order)
+        float* svx; float* svy;
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    Rules default_rules(void);                      // A calm flock, for agents a few pixels apart
+    void alloc(Flock&, int capacity, float w, float h, Rules rules); // Remember to release(flock)
+    void release(Flock&);
+    void add(Flock&, float x, float y, float vx, float vy); // Add an agent (index is count before)
+    void rescale(Flock&, float k);                  // World is k times bigger (or smaller)
+    void sort(Flock&);                              // Drop the agents into the grid
+    void steer(Flock&, int begin, int end);         // Rules + move, sorted slots [begin:end)
+    void step(Flock&, Jobs::Pool&);                 // One frame: sort, then steer in parallel
+}
+
+Boids::Rules Boids::default_rules(void)
+{
+    return Rules{
+        .see=12, .personal=4,
+        .separate=0.05f, .align=0.05f, .cohere=0.0005f,
+        .min_speed=0.3f, .max_speed=1.5f,
+        .margin=24, .turn=0.05f
+    };
+}
+
+void Boids::alloc(Flock& f, int capacity, float w, float h, Rules rules)
+{
+    f.capacity = capacity; f.count = 0;
+    f.w = w; f.h = h;
+    f.rules = rules;
+    f.x = (float*)malloc(sizeof(float)*capacity);  f.y = (float*)malloc(sizeof(float)*capacity);
+    f.vx = (float*)malloc(sizeof(float)*capacity); f.vy = (float*)malloc(sizeof(float)*capacity);
+    f.sx = (float*)malloc(sizeof(float)*capacity); f.sy = (float*)malloc(sizeof(float)*capacity);
+    f.svx = (float*)malloc(sizeof(float)*capacity); f.svy = (float*)malloc(sizeof(float)*capacity);
+    f.cell_of = (int*)malloc(sizeof(int)*capacity);
+    f.order = (int*)malloc(sizeof(int)*capacity);
+    f.gw = static_cast<int>(std::ceil(w/rules.see)); if (f.gw < 1) f.gw = 1;
+    f.gh = static_cast<int>(std::ceil(h/rules.see)); if (f.gh < 1) f.gh = 1;
+    f.cell_start = (int*)malloc(sizeof(int)*(f.gw*f.gh + 1));
+}
+
+void Boids::release(Flock& f)
+{
+    free(f.x); free(f.y); free(f.vx); free(f.vy);
+    free(f.sx); free(f.sy); free(f.svx); free(f.svy);
+    free(f.cell_of); free(f.order); free(f.cell_start);
+    f.x = NULL; f.y = NULL; f.vx = NULL; f.vy = NULL;
+    f.sx = NULL; f.sy = NULL; f.svx = NULL; f.svy = NULL;
+    f.cell_of = NULL; f.order = NULL; f.cell_start = NULL;
+    f.count = 0; f.capacity = 0;
+}
+
+void Boids::add(Flock& f, float x, float y, float vx, float vy)
+{
+    assert(f.count < f.capacity);
+    int i = f.count++;
+    f.x[i] = x; f.y[i] = y; f.vx[i] = vx; f.vy[i] = vy;
+}
+
+void Boids::rescale(Flock& f, float k)
+{ // Scale every length: positions, velocities, world, and the rules
+    /* *************DOC***************
+     * The rule lengths scale too, so SEE-sized cells still tile the world
+     * with the same gw x gh grid: nothing to reallocate, and the flock looks
+     * the same, just bigger (or smaller).
+     * *******************************/
+    for (int i=0; i<f.count; i++)
+    {
+        f.x[i] *= k; f.y[i] *= k; f.vx[i] *= k; f.vy[i] *= k;
+    }
+    f.w *= k; f.h *= k;
+    Rules& R = f.rules;
+    R.see *= k; R.personal *= k;
+    R.min_speed *= k; R.max_speed *= k;
+    R.margin *= k; R.turn *= k;
+    R.separate *= k*k;                              // (Its push goes as 1/distance)
+}
+
+void Boids::sort(Flock& f)
+{ // Counting sort by cell, and copy positions and velocities into cell order
+    const int ncells = f.gw*f.gh;
+    const float inv = 1.0f/f.rules.see;
+    for (int c=0; c<=ncells; c++) f.cell_start[c] = 0;
+    for (int i=0; i<f.count; i++)
+    { // Count the agents in each cell (agents right on the edge go in the edge cell)
+        int cx = static_cast<int>(f.x[i]*inv); cx = (cx < 0) ? 0 : ((cx >= f.gw) ? f.gw-1 : cx);
+        int cy = static_cast<int>(f.y[i]*inv); cy = (cy < 0) ? 0 : ((cy >= f.gh) ? f.gh-1 : cy);
+        int c = cy*f.gw + cx;
+        f.cell_of[i] = c;
+        f.cell_start[c+1]++;
+    }
+    for (int c=0; c<ncells; c++) f.cell_start[c+1] += f.cell_start[c];   // Counts to starts
+    // Scatter: cell_start[c] is the next free slot of cell c as it goes (so afterwards
+    // each cell_start[c] is where cell c+1 starts: shift them back by one)
+    for (int i=0; i<f.count; i++)
+    {
+        int k = f.cell_start[f.cell_of[i]]++;
+        f.order[k] = i;
+        f.sx[k] = f.x[i]; f.sy[k] = f.y[i]; f.svx[k] = f.vx[i]; f.svy[k] = f.vy[i];
+    }
+    for (int c=ncells; c>0; c--) f.cell_start[c] = f.cell_start[c-1];   // Each start moved to the next start
+    f.cell_start[0] = 0;
+}
+
+void Boids::steer(Flock& f, int begin, int end)
+{ // Apply the rules to the agents in sorted slots [begin:end) and move them
+    const Rules& R = f.rules;
+    const float see2 = R.see*R.see;
+    const float personal2 = R.personal*R.personal;
+    const float inv = 1.0f/R.see;
+    for (int k=begin; k<end; k++)
+    {
+        const float px = f.sx[k]; const float py = f.sy[k];
+        const float vx = f.svx[k]; const float vy = f.svy[k];
+        int cx = static_cast<int>(px*inv); cx = (cx < 0) ? 0 : ((cx >= f.gw) ? f.gw-1 : cx);
+        int cy = static_cast<int>(py*inv); cy = (cy < 0) ? 0 : ((cy >= f.gh) ? f.gh-1 : cy);
+        float n = 0;                                // Neighbors
+        float sum_dx = 0; float sum_dy = 0;         // Σ offset to neighbors (cohesion)
+        float sum_vx = 0; float sum_vy = 0;         // Σ neighbor velocity (alignment)
+        float away_x = 0; float away_y = 0;         // Σ push away from close neighbors (separation)
+        const int y0 = (cy > 0) ? cy-1 : 0;       const int y1 = (cy < f.gh-1) ? cy+1 : cy;
+        const int x0 = (cx > 0) ? cx-1 : 0;       const int x1 = (cx < f.gw-1) ? cx+1 : cx;
+        for (int gy=y0; gy<=y1; gy++)
+        { // A row of 3 cells is one contiguous run of sorted slots
+            const int from = f.cell_start[gy*f.gw + x0];
+            const int to = f.cell_start[gy*f.gw + x1 + 1];
+            for (int m=from; m<to; m++)
+            { // No branches: a mask (0 or 1) says whether m counts
+                float dx = f.sx[m] - px; float dy = f.sy[m] - py;
+                float d2 = dx*dx + dy*dy;
+                float near = ((d2 < see2) & (d2 > 0)) ? 1.0f : 0.0f;    // (d2 == 0: that's me)
+                float close = ((d2 < personal2) & (d2 > 0)) ? 1.0f : 0.0f;
+                n += near;
+                sum_dx += near*dx; sum_dy += near*dy;
+                sum_vx += near*f.svx[m]; sum_vy += near*f.svy[m];
+                float push = close/(d2 + 1e-6f);      // Closer : harder
+                away_x -= push*dx; away_y -= push*dy;
+            }
+        }
+        float nvx = vx; float nvy = vy;
+        if (n > 0)
+        {
+            float inv_n = 1.0f/n;
+            nvx += R.cohere*sum_dx*inv_n + R.align*(sum_vx*inv_n - vx) + R.separate*away_x;
+            nvy += R.cohere*sum_dy*inv_n + R.align*(sum_vy*inv_n - vy) + R.separate*away_y;
+        }
+        // Turn back near the edges
+        if (px < R.margin)       nvx += R.turn;
+        if (px > f.w - R.margin) nvx -= R.turn;
+        if (py < R.margin)       nvy += R.turn;
+        if (py > f.h - R.margin) nvy -= R.turn;
+        // Clamp the speed
+        float speed2 = nvx*nvx + nvy*nvy;
+        if (speed2 > R.max_speed*R.max_speed)
+        {
+            float s = R.max_speed/std::sqrt(speed2); nvx *= s; nvy *= s;
+        }
+        else if ((speed2 < R.min_speed*R.min_speed) && (speed2 > 0))
+        {
+            float s = R.min_speed/std::sqrt(speed2); nvx *= s; nvy *= s;
+        }
+        // Move. (Safe to write: every agent reads the sorted copies, not these.)
+        const int i = f.order[k];
+        f.vx[i] = nvx; f.vy[i] = nvy;
+        f.x[i] = std::fmin(std::fmax(px + nvx, 0.0f), f.w);
+        f.y[i] = std::fmin(std::fmax(py + nvy, 0.0f), f.h);
+    }
+}
+
+void Boids::step(Flock& f, Jobs::Pool& pool)
+{ // One frame of flocking
+    sort(f);                                        // O(count), one thread
+    Jobs::parallel_for(pool, f.count, 1<<11, [&f](int begin, int end) { steer(f, begin, end); });
+}
+
+#endif // __MG_BOIDS_H__
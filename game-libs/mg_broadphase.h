@@ -0,0 +1,229 @@
+#ifndef __MG_BROADPHASE_H__
+#define __MG_BROADPHASE_H__
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+namespace Broadphase
+{ // Find which bounding boxes overlap without testing every pair
+    /* *************Sweep and prune***************
+     * Checking every pair of M boxes is M*(M-1)/2 tests. At M=5000 that's 12.5
+     * million tests, every frame.
+     *
+     * Sweep and prune: sort the boxes by their left edge. Then sweep left to
+     * right. A box can only overlap the boxes whose left edge comes after its
+     * own left edge but before its right edge. As soon as the sweep passes the
+     * right edge, stop (prune): every box after that starts too far right.
+     *
+     * Boxes that overlap in x still have to overlap in y, so check y for each
+     * candidate. The work is the sort plus the number of x-overlaps, not M^2.
+     * *******************************/
+    /* *************Incremental sweep and prune***************
+     * sweep() sorts from scratch every frame. But things only move a little
+     * each frame, so last frame's order is almost this frame's order.
+     *
+     * A Sweep remembers the sorted list of box edges (the left edge "begins"
+     * a box, the right edge "ends" it) from one frame to the next. Each frame:
+     *
+     *      - update the x of every edge (boxes moved)
+     *      - insertion sort: only the edges that passed each other get swapped,
+     *        so an almost sorted list is almost free to sort
+     *      - walk the edges left to right, keeping the list of "active" boxes
+     *        (begun but not ended). A box that begins overlaps in x with every
+     *        active box: check y, and that's a pair.
+     *
+     * If too many edges passed each other (everything moved a lot, or the boxes
+     * are packed tight), insertion sort is slower than sorting from scratch. So
+     * insertion sort has a budget of swaps, and std::sort finishes the job if
+     * the budget runs out.
+     * *******************************/
+    struct Pair
+    { // Two boxes that overlap, a < b
+        int a; int b;
+    };
+
+    struct Edge
+    { // A left or right edge of a box
+        float x;
+        int tag;                            // box*2 + (0 : left edge, 1 : right edge)
+    };
+
+    struct Sweep
+    { // Edges stay sorted from frame to frame
+        Edge* edges;                        // 2*count edges, sorted by x
+        int* active;                        // Boxes begun but not ended
+        float* active_top;                  // y range of each active box (contiguous for the y checks)
+        float* active_bottom;
+        int* slot;                          // slot[box] : where box is in active
+        int count;                          // Boxes in the sweep
+        int capacity;                       // Most boxes the sweep has room for
+        long swaps;                         // Insertion sort swaps in the last update
+        bool resorted;                      // Last update ran out of swaps and used std::sort
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    int sweep(const SDL_FRect* boxes, int count, int* order, Pair* pairs, int max_pairs);
+    bool overlap_y(const SDL_FRect& a, const SDL_FRect& b);
+    void alloc(Sweep&, int capacity);               // Remember to release(sweep)
+    void release(Sweep&);
+    int update(Sweep&, const SDL_FRect* boxes, int count, Pair* pairs, int max_pairs);
+    bool before(const Edge& a, const Edge& b);      // Sort order of edges
+}
+
+bool Broadphase::overlap_y(const SDL_FRect& a, const SDL_FRect& b)
+{
+    return (a.y <= b.y + b.h) && (b.y <= a.y + a.h);
+}
+
+int Broadphase::sweep(const SDL_FRect* boxes, int count, int* order, Pair* pairs, int max_pairs)
+{ // Sort and sweep: write the overlapping pairs, return how many
+    /* *************DOC***************
+     * Parameters
+     * ----------
+     * boxes : count boxes
+     * order : room for count ints (scratch: box indices sorted by left edge)
+     * pairs : room for max_pairs pairs
+     *
+     * Return
+     * ------
+     * number of pairs written (stops at max_pairs)
+     * *******************************/
+    for (int i=0; i<count; i++) order[i] = i;
+    std::sort(order, order+count, [boxes](int i, int j) { return boxes[i].x < boxes[j].x; });
+    int n = 0;
+    for (int k=0; k<count; k++)
+    {
+        const SDL_FRect& a = boxes[order[k]];
+        const float right = a.x + a.w;
+        for (int m=k+1; (m<count) && (boxes[order[m]].x <= right); m++)
+        { // Overlaps in x: check y
+            const SDL_FRect& b = boxes[order[m]];
+            if (!overlap_y(a, b)) continue;
+            if (n == max_pairs) return n;               // Out of room
+            int i = order[k]; int j = order[m];
+            pairs[n++] = (i < j) ? Pair{.a=i, .b=j} : Pair{.a=j, .b=i};
+        }
+    }
+    return n;
+}
+
+void Broadphase::alloc(Sweep& s, int capacity)
+{
+    s.edges = (Edge*)malloc(sizeof(Edge)*2*capacity);
+    s.active = (int*)malloc(sizeof(int)*capacity);
+    s.active_top = (float*)malloc(sizeof(float)*capacity);
+    s.active_bottom = (float*)malloc(sizeof(float)*capacity);
+    s.slot = (int*)malloc(sizeof(int)*capacity);
+    s.count = 0; s.capacity = capacity;
+    s.swaps = 0; s.resorted = false;
+}
+
+void Broadphase::release(Sweep& s)
+{
+    free(s.edges); free(s.active); free(s.active_top); free(s.active_bottom); free(s.slot);
+    s.edges = NULL; s.active = NULL; s.active_top = NULL; s.active_bottom = NULL; s.slot = NULL;
+    s.count = 0; s.capacity = 0;
+}
+
+bool Broadphase::before(const Edge& a, const Edge& b)
+{ // Sort by x. Same x: left edges first, so boxes that just touch count as overlapping.
+    return (a.x < b.x) || ((a.x == b.x) && ((a.tag & 1) < (b.tag & 1)));
+}
+
+int Broadphase::update(Sweep& s, const SDL_FRect* boxes, int count, Pair* pairs, int max_pairs)
+{ // Re-sort the edges (insertion sort) and sweep: write the overlapping pairs, return how many
+    /* *************DOC***************
+     * Parameters
+     * ----------
+     * s : the Sweep (edges sorted last frame)
+     * boxes : count boxes, box i is the same thing every frame
+     *      (new boxes can be added at the end; removing boxes is not supported)
+     * pairs : room for max_pairs pairs
+     *
+     * Return
+     * ------
+     * number of pairs written (stops at max_pairs)
+     * *******************************/
+    assert(count <= s.capacity);
+    if (count < s.count) s.count = 0;               // Boxes went away: start over
+    for (int i=s.count; i<count; i++)
+    { // New boxes: add their edges at the end, insertion sort moves them into place
+        s.edges[2*i]   = Edge{.x=0, .tag=2*i};
+        s.edges[2*i+1] = Edge{.x=0, .tag=2*i+1};
+    }
+    s.count = count;
+    const int nedges = 2*count;
+    Edge* e = s.edges;
+    for (int k=0; k<nedges; k++)
+    { // Boxes moved: update the x of every edge
+        const SDL_FRect& b = boxes[e[k].tag >> 1];
+        e[k].x = (e[k].tag & 1) ? b.x + b.w : b.x;
+    }
+    { // Insertion sort, with a budget
+        const long budget = 8L*nedges;              // About what std::sort costs at 10k boxes
+        long swaps = 0;
+        int k = 1;
+        for (; (k<nedges) && (swaps<budget); k++)
+        {
+            Edge key = e[k];
+            int m = k-1;
+            while ((m >= 0) && before(key, e[m])) { e[m+1] = e[m]; m--; }
+            swaps += (k-1) - m;
+            e[m+1] = key;
+        }
+        s.swaps = swaps;
+        s.resorted = (k < nedges);
+        if (s.resorted) std::sort(e, e+nedges, before); // Out of budget: sort from scratch
+    }
+    // Sweep
+    int nactive = 0;
+    int n = 0;
+    for (int k=0; k<nedges; k++)
+    {
+        const int box = e[k].tag >> 1;
+        if (e[k].tag & 1)
+        { // Right edge: box is done. Swap the last active box into its slot.
+            int i = s.slot[box];
+            nactive--;
+            s.active[i] = s.active[nactive];
+            s.active_top[i] = s.active_top[nactive];
+            s.active_bottom[i] = s.active_bottom[nactive];
+            s.slot[s.active[i]] = i;
+            continue;
+        }
+        // Left edge: box overlaps every active box in x. Check y.
+        const float top = boxes[box].y; const float bottom = boxes[box].y + boxes[box].h;
+        if (n + nactive > max_pairs)
+        { // Might run out of room: check before every write
+            for (int i=0; i<nactive; i++)
+            {
+                if ((s.active_top[i] <= bottom) && (top <= s.active_bottom[i]))
+                {
+                    if (n == max_pairs) return n;   // Out of room
+                    int other = s.active[i];
+                    pairs[n++] = Pair{.a=std::min(other, box), .b=std::max(other, box)};
+                }
+            }
+        }
+        else
+        { // Plenty of room. Most active boxes miss in y, so don't branch on it:
+          // always write the pair, only move n forward on a hit (same trick as Pick::cull).
+            for (int i=0; i<nactive; i++)
+            {
+                bool hit = (s.active_top[i] <= bottom) & (top <= s.active_bottom[i]);
+                int other = s.active[i];
+                pairs[n] = Pair{.a=std::min(other, box), .b=std::max(other, box)};
+                n += static_cast<int>(hit);
+            }
+        }
+        s.active[nactive] = box; s.active_top[nactive] = top; s.active_bottom[nactive] = bottom;
+        s.slot[box] = nactive;
+        nactive++;
+    }
+    return n;
+}
+
+#endif // __MG_BROADPHASE_H__
@@ -0,0 +1,207 @@
+#ifndef __MG_CAMERA_H__
+#define __MG_CAMERA_H__
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+namespace Camera
+{ // A 2D camera over a world bigger than the game art: pan, zoom, and cull what it can't see
+    /* *************World and game art***************
+     * Things live in WORLD pixels. The camera shows part of the world in the
+     * game art: the world point (x,y) lands at game art pixel [0,0], and
+     * every world pixel is zoom game art pixels across.
+     *
+     *      art = (world - [x,y])*zoom          world = art/zoom + [x,y]
+     *
+     * zoom 1 : one world pixel is one game art pixel (like before there was
+     * a camera). zoom 2 : closer. zoom 0.25 : four times as much world.
+     * *******************************/
+    /* *************Cull before making geometry***************
+     * A spinner or a curve costs something to draw: trail points, 128 curve
+     * samples, RDP, snapping. If it is off screen, all of that is thrown away
+     * by SDL. So ask first: does its BOUNDS overlap the visible rectangle?
+     *
+     * With thousands of things, even asking each one is a loop over all of
+     * them. A Grid bins the things by where their center is (a counting
+     * sort, like Boids::sort), so the visible rectangle only visits the cells
+     * it covers, grown by reach: the biggest half-size of anything, so
+     * something centered just outside still gets checked. Each thing in
+     * those cells gets the exact bounds check.
+     *
+     * Then the per-frame cost of drawing goes with what is visible, not with
+     * how big the world is. (The bin is O(N), but it is a few adds per thing;
+     * drawing is the expensive part.)
+     * *******************************/
+    struct View
+    {
+        float x, y;                         // World point at game art [0,0]
+        float zoom;                         // Game art pixels per world pixel
+        float w, h;                         // Game art size
+    };
+
+    struct Grid
+    { // Things binned by center: things in cell c are order[cell_start[c]:cell_start[c+1])
+        float cell;                         // Cell size in world pixels
+        int gw, gh;                         // Grid size in cells
+        float reach;                        // Biggest half-size of anything binned
+        int* cell_start;
+        int* cell_of;                       // Scratch: cell of each thing
+        int* order;                         // Things, in cell order
+        int count;
+        int capacity;
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    SDL_FRect visible(const View&);                 // World rectangle the camera sees
+    SDL_FPoint to_art(const View&, SDL_FPoint world);
+    SDL_FPoint to_world(const View&, SDL_FPoint art);
+    void to_art(const View&, SDL_FPoint* points, int count); // In place
+    SDL_FRect to_art(const View&, const SDL_FRect& world);
+    void pan(View&, float dx, float dy);            // Move the view by dx,dy GAME ART pixels
+    void zoom_about(View&, float zoom, SDL_FPoint art); // New zoom, the world under art stays put
+    float zoom_step(float zoom, int dir, bool whole); // Next zoom in (dir 1) or out (-1)
+    void keep_in(View&, float world_w, float world_h); // Don't look (much) past the world edges
+    bool overlaps(const SDL_FRect& a, const SDL_FRect& b);
+    void alloc(Grid&, int capacity, float world_w, float world_h, float cell); // Remember to release(grid)
+    void release(Grid&);
+    void bin(Grid&, const float* x, const float* y, const float* r, int count); // r : half-size of each thing
+    int query(const Grid&, const float* x, const float* y, const float* r, const SDL_FRect& rect, int* out);
+}
+
+SDL_FRect Camera::visible(const View& v)
+{
+    return SDL_FRect{.x=v.x, .y=v.y, .w=v.w/v.zoom, .h=v.h/v.zoom};
+}
+
+SDL_FPoint Camera::to_art(const View& v, SDL_FPoint p)
+{
+    return SDL_FPoint{.x=(p.x - v.x)*v.zoom, .y=(p.y - v.y)*v.zoom};
+}
+
+SDL_FPoint Camera::to_world(const View& v, SDL_FPoint p)
+{
+    return SDL_FPoint{.x=p.x/v.zoom + v.x, .y=p.y/v.zoom + v.y};
+}
+
+void Camera::to_art(const View& v, SDL_FPoint* points, int count)
+{
+    for (int i=0; i<count; i++)
+    {
+        points[i] = SDL_FPoint{.x=(points[i].x - v.x)*v.zoom, .y=(points[i].y - v.y)*v.zoom};
+    }
+}
+
+SDL_FRect Camera::to_art(const View& v, const SDL_FRect& r)
+{
+    return SDL_FRect{.x=(r.x - v.x)*v.zoom, .y=(r.y - v.y)*v.zoom, .w=r.w*v.zoom, .h=r.h*v.zoom};
+}
+
+void Camera::pan(View& v, float dx, float dy)
+{ // (Game art pixels, so panning feels the same at any zoom)
+    v.x += dx/v.zoom; v.y += dy/v.zoom;
+}
+
+void Camera::zoom_about(View& v, float zoom, SDL_FPoint art)
+{
+    const SDL_FPoint anchor = to_world(v, art);     // World point under art...
+    v.zoom = zoom;
+    v.x = anchor.x - art.x/zoom; v.y = anchor.y - art.y/zoom; // ...is still under art
+}
+
+float Camera::zoom_step(float zoom, int dir, bool whole)
+{ // whole : 1/4, 1/3, 1/2, 1, 2, 3, 4 (every pixel is a whole number of pixels), else a 25% step
+    if (!whole) return (dir > 0) ? zoom*1.25f : zoom/1.25f;
+    if (zoom >= 1)
+    {
+        const float n = std::round(zoom) + static_cast<float>(dir);
+        return (n >= 1) ? n : 0.5f;
+    }
+    const float n = std::round(1/zoom) - static_cast<float>(dir);  // zoom is 1/n
+    return (n <= 1) ? 1.0f : 1/n;
+}
+
+void Camera::keep_in(View& v, float world_w, float world_h)
+{ // Center the world if it is smaller than the view, else stop at its edges
+    const SDL_FRect see = visible(v);
+    v.x = (see.w >= world_w) ? (world_w - see.w)/2 : std::min(std::max(v.x, 0.0f), world_w - see.w);
+    v.y = (see.h >= world_h) ? (world_h - see.h)/2 : std::min(std::max(v.y, 0.0f), world_h - see.h);
+}
+
+bool Camera::overlaps(const SDL_FRect& a, const SDL_FRect& b)
+{
+    return (a.x < b.x + b.w) && (b.x < a.x + a.w) && (a.y < b.y + b.h) && (b.y < a.y + a.h);
+}
+
+void Camera::alloc(Grid& g, int capacity, float world_w, float world_h, float cell)
+{
+    g.cell = cell; g.capacity = capacity; g.count = 0; g.reach = 0;
+    g.gw = std::max(1, static_cast<int>(std::ceil(world_w/cell)));
+    g.gh = std::max(1, static_cast<int>(std::ceil(world_h/cell)));
+    g.cell_start = (int*)malloc(sizeof(int)*(g.gw*g.gh + 1));
+    g.cell_of = (int*)malloc(sizeof(int)*capacity);
+    g.order = (int*)malloc(sizeof(int)*capacity);
+}
+
+void Camera::release(Grid& g)
+{
+    free(g.cell_start); free(g.cell_of); free(g.order);
+    g.cell_start = NULL; g.cell_of = NULL; g.order = NULL;
+    g.count = 0; g.capacity = 0;
+}
+
+void Camera::bin(Grid& g, const float* x, const float* y, const float* r, int count)
+{ // Counting sort by cell (things off the world go in the edge cells)
+    assert(count <= g.capacity);
+    g.count = count;
+    const int ncells = g.gw*g.gh;
+    const float inv = 1.0f/g.cell;
+    float reach = 0;
+    for (int c=0; c<=ncells; c++) g.cell_start[c] = 0;
+    for (int i=0; i<count; i++)
+    {
+        int cx = static_cast<int>(x[i]*inv); cx = (cx < 0) ? 0 : ((cx >= g.gw) ? g.gw-1 : cx);
+        int cy = static_cast<int>(y[i]*inv); cy = (cy < 0) ? 0 : ((cy >= g.gh) ? g.gh-1 : cy);
+        g.cell_of[i] = cy*g.gw + cx;
+        g.cell_start[g.cell_of[i] + 1]++;
+        reach = std::max(reach, r[i]);
+    }
+    g.reach = reach;
+    for (int c=0; c<ncells; c++) g.cell_start[c+1] += g.cell_start[c];
+    for (int i=0; i<count; i++) g.order[g.cell_start[g.cell_of[i]]++] = i;
+    for (int c=ncells; c>0; c--) g.cell_start[c] = g.cell_start[c-1]; // (Scatter moved each start to the next)
+    g.cell_start[0] = 0;
+}
+
+int Camera::query(const Grid& g, const float* x, const float* y, const float* r, const SDL_FRect& rect, int* out)
+{ // Things whose bounds (center +/- r) overlap rect, in cell order. Return how many.
+    /* *************DOC***************
+     * x, y, r are the same arrays that were binned. out : room for count.
+     * The edge cells also hold everything past the world edges, so the
+     * cell range is clamped, not skipped, when rect is partly off the world.
+     * *******************************/
+    const float inv = 1.0f/g.cell;
+    auto cell_x = [&g, inv](float wx) { return std::min(std::max(static_cast<int>(std::floor(wx*inv)), 0), g.gw-1); };
+    auto cell_y = [&g, inv](float wy) { return std::min(std::max(static_cast<int>(std::floor(wy*inv)), 0), g.gh-1); };
+    const int x0 = cell_x(rect.x - g.reach); const int x1 = cell_x(rect.x + rect.w + g.reach);
+    const int y0 = cell_y(rect.y - g.reach); const int y1 = cell_y(rect.y + rect.h + g.reach);
+    int n = 0;
+    for (int cy=y0; cy<=y1; cy++)
+    { // A row of cells is one contiguous run of order
+        const int from = g.cell_start[cy*g.gw + x0];
+        const int to = g.cell_start[cy*g.gw + x1 + 1];
+        for (int k=from; k<to; k++)
+        {
+            const int i = g.order[k];
+            const bool in = (x[i] + r[i] > rect.x) && (x[i] - r[i] < rect.x + rect.w) &&
+                            (y[i] + r[i] > rect.y) && (y[i] - r[i] < rect.y + rect.h);
+            out[n] = i; n += in;                    // (No branch: write it, count it if it's in)
+        }
+    }
+    return n;
+}
+
+#endif // __MG_CAMERA_H__
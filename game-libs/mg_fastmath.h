@@ -0,0 +1,32 @@
+#ifndef __MG_FASTMATH_H__
+#define __MG_FASTMATH_H__
+
+#include <bit>
+#include <cstdint>
+
+namespace FastMath
+{ // Cheap approximations for hot loops
+    float rsqrt(float x);                           // ~1/sqrt(x), good to about 0.2%
+}
+
+float FastMath::rsqrt(float x)
+{ // Approximate 1/sqrt(x) without a sqrt or a divide
+    /* *************DOC***************
+     * The famous Quake III trick: treat the float bits as an integer, and the
+     * integer is roughly a scaled-and-offset log2(x). Halving and negating the
+     * log is 1/sqrt(x), so shift right by one and subtract from a magic number.
+     * One Newton-Raphson step then cleans up the guess.
+     *
+     * Use this to normalize vectors: v * rsqrt(v.x*v.x + v.y*v.y)
+     *
+     * x == 0 returns a big finite number, so normalizing a zero vector gives back
+     * a zero vector instead of NaN.
+     * *******************************/
+    uint32_t i = std::bit_cast<uint32_t>(x);
+    i = 0x5f3759df - (i >> 1);                      // Initial guess
+    float y = std::bit_cast<float>(i);
+    y = y*(1.5f - (0.5f*x*y*y));                    // One Newton-Raphson step
+    return y;
+}
+
+#endif // __MG_FASTMATH_H__
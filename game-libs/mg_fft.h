@@ -0,0 +1,254 @@
+#ifndef __MG_FFT_H__
+#define __MG_FFT_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+namespace Fft
+{ // Spectrum of a sound: a real FFT on sliding windows, worked out on a thread ahead of playback
+    /* *************A real FFT from a half-size complex one***************
+     * A sound is real numbers, so its spectrum is symmetric: N samples have
+     * only N/2+1 frequencies worth keeping. Pack the N real samples into
+     * N/2 complex ones (even samples are the real parts, odd samples are
+     * the imaginary parts), do one N/2 point complex FFT, then untangle the
+     * two halves. That is half the work of an N point complex FFT.
+     *
+     * The complex FFT is the textbook radix-2 one: put the samples in
+     * bit-reversed order, then log2 stages of butterflies. The twiddles
+     * (cos and sin) are a table made once. The butterflies of a stage don't
+     * depend on each other, and the data is split into separate re and im
+     * arrays, so the inner loop can be vectorized.
+     * *******************************/
+    /* *************Analyzing ahead of playback***************
+     * The render thread must not do the FFT: it has a frame to draw. So an
+     * Analyzer thread works through the track one window at a time, a HOP
+     * apart, and puts each window's BANDS levels in a ring of FRAMES frames.
+     * It stays up to FRAMES-1 frames ahead of playback (a few hundred ms),
+     * and sleeps when it is that far ahead.
+     *
+     * Each video frame, the render thread asks for the frame where playback
+     * is now. Asking is a copy out of the ring plus one atomic store (to
+     * say "frames before this one can be overwritten"). If the frame isn't
+     * there yet (the analyzer fell behind), it keeps the last one and
+     * counts a miss. Visuals are then at most a HOP (plus a sound buffer)
+     * away from what is heard.
+     *
+     * Levels are 0 to 1. Each band's level is measured against the loudest
+     * that band has been lately (a slowly falling peak), so quiet and loud
+     * tracks both move things around.
+     * *******************************/
+    constexpr int N = 2048;                             // Window (samples)
+    constexpr int HOP = 512;                            // Window start to window start (~11 ms at 48 kHz)
+    constexpr int BANDS = 8;                            // Levels per frame, low to high (log spaced)
+    constexpr int FRAMES = 64;                          // Frames in the ring (how far ahead it can get)
+    constexpr float LOWEST = 40;                        // Hz at the bottom of the lowest band
+    constexpr float PEAK_FALL = 0.995f;                 // Peak level falls by this every frame
+    constexpr float PI = 3.14159265f;
+
+    struct Plan
+    { // Tables and scratch for an n point real FFT
+        int n;
+        float* cos_t; float* sin_t;         // cos, sin of 2 pi k/n, k in [0:n/2]
+        int* rev;                           // Bit reversal of [0:n/2)
+        float* window;                      // Hann window, n samples
+        float* re; float* im;               // n/2 complex scratch
+    };
+
+    struct Frame
+    {
+        long at;                            // Window center (track frames, counting every loop)
+        float bands[BANDS];                 // Levels, 0 to 1
+    };
+
+    struct Analyzer
+    {
+        const float* samples; long frames;  // Track: interleaved stereo (read only, see Audio::Track)
+        int freq;
+        Plan plan;
+        float* x;                           // One window of mono samples
+        float* power;                       // n/2+1 bins
+        int band_start[BANDS+1];            // Band b is bins [band_start[b]:band_start[b+1])
+        float peak[BANDS];                  // Loudest lately
+        Frame ring[FRAMES];                 // Frame k is ring[k%FRAMES]
+        std::atomic<long> produced;         // Frames analyzed (analyzer thread writes it)
+        std::atomic<long> consumed;         // Frame the render thread is on (render thread writes it)
+        std::atomic<bool> quit;
+        std::thread worker;
+        Frame last;                         // Render thread's copy of the latest frame
+        long asks, misses, lead;            // Render thread: frames asked for, not there yet, frames ahead (sum)
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    void alloc(Plan&, int n);                       // n : a power of 2. Remember to release(plan)
+    void release(Plan&);
+    void fft(const Plan&, float* re, float* im);    // n/2 point complex FFT, in place
+    void real_fft(const Plan&, const float* x, float* power); // Windowed, n samples in, n/2+1 powers out
+    void start(Analyzer&, const float* samples, long frames, int freq); // Track must outlive stop()
+    void stop(Analyzer&);                           // Joins the thread, frees everything
+    void analyze(Analyzer&, long k, Frame&);        // Analyzer thread: frame k
+    void run(Analyzer*);                            // Analyzer thread main loop
+    const Frame& frame_at(Analyzer&, long played);  // Render thread: levels where playback is
+}
+
+void Fft::alloc(Plan& p, int n)
+{
+    assert((n >= 4) && ((n & (n-1)) == 0));
+    p.n = n;
+    const int m = n/2;
+    p.cos_t = (float*)malloc(sizeof(float)*(m+1)); p.sin_t = (float*)malloc(sizeof(float)*(m+1));
+    for (int k=0; k<=m; k++)
+    {
+        p.cos_t[k] = std::cos(2*PI*k/n);
+        p.sin_t[k] = std::sin(2*PI*k/n);
+    }
+    p.rev = (int*)malloc(sizeof(int)*m);
+    int bits = 0;
+    while ((1 << bits) < m) bits++;
+    for (int i=0; i<m; i++)
+    {
+        int r = 0;
+        for (int b=0; b<bits; b++) r |= ((i >> b) & 1) << (bits-1-b);
+        p.rev[i] = r;
+    }
+    p.window = (float*)malloc(sizeof(float)*n);
+    for (int i=0; i<n; i++) p.window[i] = 0.5f - 0.5f*std::cos(2*PI*i/n);
+    p.re = (float*)malloc(sizeof(float)*m); p.im = (float*)malloc(sizeof(float)*m);
+}
+
+void Fft::release(Plan& p)
+{
+    free(p.cos_t); free(p.sin_t); free(p.rev); free(p.window); free(p.re); free(p.im);
+    p = Plan{.n=0, .cos_t=NULL, .sin_t=NULL, .rev=NULL, .window=NULL, .re=NULL, .im=NULL};
+}
+
+void Fft::fft(const Plan& p, float* __restrict re, float* __restrict im)
+{ // Forward (e^-i) transform of n/2 points
+    const int m = p.n/2;
+    for (int i=0; i<m; i++)
+    { // Bit-reversed order (swap each pair once)
+        const int r = p.rev[i];
+        if (r > i) { std::swap(re[i], re[r]); std::swap(im[i], im[r]); }
+    }
+    for (int h=1; h<m; h*=2)
+    { // Stage: butterflies 2h apart. Twiddle j is e^(-i pi j/h) : table entry j*n/(2h)
+        const int stride = p.n/(2*h);
+        for (int s=0; s<m; s+=2*h)
+        {
+            float* __restrict ar = re + s; float* __restrict ai = im + s;
+            float* __restrict br = re + s + h; float* __restrict bi = im + s + h;
+            for (int j=0; j<h; j++)
+            {
+                const float c = p.cos_t[j*stride]; const float sn = p.sin_t[j*stride];
+                const float tr = br[j]*c + bi[j]*sn; const float ti = bi[j]*c - br[j]*sn; // b times e^(-i angle)
+                br[j] = ar[j] - tr; bi[j] = ai[j] - ti;
+                ar[j] += tr; ai[j] += ti;
+            }
+        }
+    }
+}
+
+void Fft::real_fft(const Plan& p, const float* x, float* power)
+{ // Pack, complex FFT, untangle: power[k] = |X[k]|^2 for k in [0:n/2]
+    const int m = p.n/2;
+    float* re = p.re; float* im = p.im;
+    for (int k=0; k<m; k++) { re[k] = x[2*k]*p.window[2*k]; im[k] = x[2*k+1]*p.window[2*k+1]; }
+    fft(p, re, im);
+    for (int k=0; k<=m; k++)
+    { // Z[k] and conj(Z[m-k]) give the spectra of the even (E) and odd (O) samples
+        const float zr = re[k%m]; const float zi = im[k%m];
+        const float cr = re[(m-k)%m]; const float ci = -im[(m-k)%m];
+        const float er = 0.5f*(zr + cr); const float ei = 0.5f*(zi + ci);
+        const float or_ = 0.5f*(zi - ci); const float oi = -0.5f*(zr - cr); // (Z - conj)/(2i)
+        // X[k] = E + e^(-2 pi i k/n) O
+        const float c = p.cos_t[k]; const float s = p.sin_t[k];
+        const float xr = er + or_*c + oi*s; const float xi = ei + oi*c - or_*s;
+        power[k] = xr*xr + xi*xi;
+    }
+}
+
+void Fft::start(Analyzer& a, const float* samples, long frames, int freq)
+{
+    a.samples = samples; a.frames = frames; a.freq = freq;
+    alloc(a.plan, N);
+    a.x = (float*)malloc(sizeof(float)*N);
+    a.power = (float*)malloc(sizeof(float)*(N/2+1));
+    // Band edges: LOWEST Hz to half the sample rate, each band the same number of octaves
+    const float top = 0.5f*freq;
+    for (int b=0; b<=BANDS; b++)
+    {
+        const float hz = LOWEST*std::pow(top/LOWEST, static_cast<float>(b)/BANDS);
+        a.band_start[b] = std::min(static_cast<int>(hz*N/freq), N/2);
+    }
+    for (int b=0; b<BANDS; b++) a.band_start[b+1] = std::max(a.band_start[b+1], a.band_start[b]+1); // (One bin at least)
+    for (float& pk : a.peak) pk = 1e-6f;
+    a.last = Frame{};
+    a.asks = 0; a.misses = 0; a.lead = 0;
+    a.produced = 0; a.consumed = 0; a.quit = false;
+    a.worker = std::thread(run, &a);
+}
+
+void Fft::stop(Analyzer& a)
+{
+    a.quit = true;
+    if (a.worker.joinable()) a.worker.join();
+    release(a.plan);
+    free(a.x); free(a.power);
+    a.x = NULL; a.power = NULL;
+}
+
+void Fft::analyze(Analyzer& a, long k, Frame& f)
+{ // Window centered on track frame k*HOP (the track loops), mixed to mono
+    f.at = k*HOP;
+    long i = f.at - N/2;
+    i = ((i % a.frames) + a.frames) % a.frames;
+    for (int n=0; n<N; n++)
+    {
+        a.x[n] = 0.5f*(a.samples[2*i] + a.samples[2*i+1]);
+        if (++i == a.frames) i = 0;
+    }
+    real_fft(a.plan, a.x, a.power);
+    for (int b=0; b<BANDS; b++)
+    {
+        float sum = 0;
+        for (int k=a.band_start[b]; k<a.band_start[b+1]; k++) sum += a.power[k];
+        const float level = std::sqrt(sum/(a.band_start[b+1] - a.band_start[b]));
+        a.peak[b] = std::max(a.peak[b]*PEAK_FALL, level);
+        f.bands[b] = level/a.peak[b];
+    }
+}
+
+void Fft::run(Analyzer* a)
+{ // Stay FRAMES-1 frames ahead of the render thread, no further
+    while (!a->quit)
+    {
+        const long c = a->consumed.load(std::memory_order_acquire);
+        const long k = std::max(a->produced.load(std::memory_order_relaxed), c); // (Behind playback: skip to it)
+        if (k - c >= FRAMES-1)
+        { // Far enough ahead (frame k's slot is one the render thread may still read)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            continue;
+        }
+        analyze(*a, k, a->ring[k%FRAMES]);
+        a->produced.store(k+1, std::memory_order_release);
+    }
+}
+
+const Fft::Frame& Fft::frame_at(Analyzer& a, long played)
+{ // (Render thread) played : track frames played so far (see Audio::Track)
+    const long k = played/HOP;
+    const long produced = a.produced.load(std::memory_order_acquire);
+    a.asks++;
+    if (k < produced) { a.last = a.ring[k%FRAMES]; a.lead += produced - k; }
+    else a.misses++;                                // (Analyzer is behind: keep the last levels)
+    a.consumed.store(k, std::memory_order_release);
+    return a.last;
+}
+
+#endif // __MG_FFT_H__
@@ -0,0 +1,186 @@
+#ifndef __MG_FIT_H__
+#define __MG_FIT_H__
+
+#include <cmath>
+
+namespace Fit
+{ // Fit quadratic dCB curves to a live stream of points (like the mouse), one point at a time
+    /* *************How the online fit works***************
+     * A stroke is cut into segments. Each segment is one quadratic dCB curve:
+     *
+     *      - P0 is the first point of the segment (fixed)
+     *      - P2 is the latest point (moves with the mouse)
+     *      - P1 is whatever fits the points in between best (least squares)
+     *
+     * Give each point a λ by how far along the stroke it is (chord length):
+     *
+     *      λi = Li/L       Li : length of the stroke from P0 to point i
+     *                      L  : length of the whole segment so far
+     *
+     * With P0 and P2 fixed, the curve is linear in P1, so the best P1 is one
+     * division. Let u = 2λ(1-λ), the Bernstein weight on P1:
+     *
+     *      P1 = Σ u*(S - (1-λ)^2*P0 - λ^2*P2) / Σ u^2
+     *
+     * The catch: L changes with every new point, so every λ changes, so it
+     * looks like every sum has to be redone from scratch. But λ = Li/L, and L
+     * is the same for every point. Multiply out the sums and L comes out front,
+     * leaving sums that only depend on each point's own Li:
+     *
+     *      Σ Li^k        k=0..4
+     *      Σ Li^k * Si   k=0..2
+     *      Σ |Si|^2      (for the fit error)
+     *
+     * A new point just adds its terms to these running sums. So a new point is
+     * O(1) work no matter how many points are in the segment.
+     *
+     * The squared error of the fit also comes out of the running sums. When
+     * the average error gets bigger than the tolerance, the curve can't bend
+     * enough to follow the stroke anymore. Close the segment (with the fit
+     * from BEFORE the new point) and start a new segment at its end point.
+     *
+     * The sums get big (L^4 with L in the hundreds of pixels), so they are
+     * doubles, and points are stored relative to P0.
+     * *******************************/
+    struct Stroke
+    {
+        SDL_FPoint P0;                      // Start of the open segment
+        SDL_FPoint last;                    // Latest point
+        double L;                           // Length of the open segment so far
+        double M[5];                        // M[k] : Σ Li^k
+        double Nx[3]; double Ny[3];         // N[k] : Σ Li^k * Si  (Si relative to P0)
+        double Q;                           // Σ |Si|^2
+        SDL_FPoint fit[3];                  // Best fit of the open segment: P0, P1, P2
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    void begin(Stroke&, SDL_FPoint p);                  // Start a stroke at p
+    bool add(Stroke&, SDL_FPoint p, float tol, SDL_FPoint* closed); // true : closed is a finished segment
+    bool end(Stroke&, SDL_FPoint* closed);              // true : closed is the last segment
+    double solve(const Stroke&, SDL_FPoint* control_points); // Fit the open segment, return mean error^2
+    void accumulate(Stroke&, SDL_FPoint p);             // Add p to the running sums
+    void rescale(Stroke&, float k);                     // Every point k times farther from [0,0]
+}
+
+void Fit::begin(Stroke& s, SDL_FPoint p)
+{ // Start a new segment at p
+    s.P0 = p; s.last = p; s.L = 0;
+    for (int k=0; k<5; k++) s.M[k] = 0;
+    for (int k=0; k<3; k++) { s.Nx[k] = 0; s.Ny[k] = 0; }
+    s.Q = 0;
+    accumulate(s, p);                                   // P0 is a point of the segment (at L=0)
+    s.fit[0] = p; s.fit[1] = p; s.fit[2] = p;
+}
+
+void Fit::accumulate(Stroke& s, SDL_FPoint p)
+{ // Add p (at distance s.L along the segment) to the running sums
+    const double l = s.L;
+    const double sx = p.x - s.P0.x; const double sy = p.y - s.P0.y;
+    double lk = 1;                                      // l^k
+    for (int k=0; k<5; k++)
+    {
+        s.M[k] += lk;
+        if (k < 3) { s.Nx[k] += lk*sx; s.Ny[k] += lk*sy; }
+        lk *= l;
+    }
+    s.Q += sx*sx + sy*sy;
+    s.last = p;
+}
+
+void Fit::rescale(Stroke& s, float k)
+{ // The sums are polynomials in l and S: M[j] scales by k^j, N[j] by k^(j+1), Q by k^2
+    s.P0 = SDL_FPoint{.x=k*s.P0.x, .y=k*s.P0.y}; s.last = SDL_FPoint{.x=k*s.last.x, .y=k*s.last.y};
+    for (int j=0; j<3; j++) s.fit[j] = SDL_FPoint{.x=k*s.fit[j].x, .y=k*s.fit[j].y};
+    s.L *= k;
+    double kj = 1;                                      // k^j
+    for (int j=0; j<5; j++)
+    {
+        s.M[j] *= kj;
+        if (j < 3) { s.Nx[j] *= kj*k; s.Ny[j] *= kj*k; }
+        kj *= k;
+    }
+    s.Q *= static_cast<double>(k)*k;
+}
+
+double Fit::solve(const Stroke& s, SDL_FPoint* cp)
+{ // Least-squares P1 for the open segment, return the mean squared error
+    /* *************DOC***************
+     * Everything below is the sums in "How the online fit works" multiplied out
+     * with λ = l/L. Points are relative to P0, so P0 is [0,0] here and drops out.
+     *
+     * cp : room for 3 points, set to P0, P1, P2
+     * *******************************/
+    const double L = s.L;
+    const double* M = s.M;
+    const double e2x = s.last.x - s.P0.x; const double e2y = s.last.y - s.P0.y; // P2 - P0
+    double p1x = 0.5*e2x; double p1y = 0.5*e2y;         // Too few points: P1 halfway (a line)
+    // Σ u^2 * L^4 (u = 2λ(1-λ))
+    const double uu = 4*(L*L*M[2] - 2*L*M[3] + M[4]);
+    if ((L > 0) && (uu > 1e-9*L*L*L*L*M[0]))
+    {
+        // Σ u*S * L^2
+        const double usx = 2*(L*s.Nx[1] - s.Nx[2]); const double usy = 2*(L*s.Ny[1] - s.Ny[2]);
+        // Σ u*λ^2 * L^4
+        const double ut2 = 2*(L*M[3] - M[4]);
+        // P1 = Σ u*(S - λ^2*P2) / Σ u^2, everything scaled by L^4
+        p1x = (L*L*usx - ut2*e2x)/uu;
+        p1y = (L*L*usy - ut2*e2y)/uu;
+    }
+    cp[0] = s.P0;
+    cp[1] = SDL_FPoint{.x=static_cast<float>(s.P0.x + p1x), .y=static_cast<float>(s.P0.y + p1y)};
+    cp[2] = s.last;
+    if (L <= 0) return 0;
+    // Error: Σ |S - B(λ)|^2 = Σ|S|^2 - 2 Σ S.B + Σ |B|^2,
+    // with B(λ) = c1*l + c2*l^2 (a polynomial in l, because P0 is [0,0])
+    const double c1x = 2*p1x/L;                 const double c1y = 2*p1y/L;
+    const double c2x = (e2x - 2*p1x)/(L*L);     const double c2y = (e2y - 2*p1y)/(L*L);
+    const double SB = c1x*s.Nx[1] + c1y*s.Ny[1] + c2x*s.Nx[2] + c2y*s.Ny[2];
+    const double BB = (c1x*c1x + c1y*c1y)*M[2] + 2*(c1x*c2x + c1y*c2y)*M[3] + (c2x*c2x + c2y*c2y)*M[4];
+    double err = s.Q - 2*SB + BB;
+    if (err < 0) err = 0;                               // Round-off
+    return err/M[0];
+}
+
+bool Fit::add(Stroke& s, SDL_FPoint p, float tol, SDL_FPoint* closed)
+{ // Add the next point of the stroke
+    /* *************DOC***************
+     * Parameters
+     * ----------
+     * s : the stroke (call begin() first)
+     * p : the next point
+     * tol : float
+     *      RMS distance (pixels) the fit may be off before the segment closes
+     * closed : room for 3 points
+     *      if the segment closed, these are its control points
+     *
+     * Return
+     * ------
+     * true if a segment closed (the new open segment starts where it ended)
+     * *******************************/
+    float dx = p.x - s.last.x; float dy = p.y - s.last.y;
+    if (dx*dx + dy*dy < 1e-6f) return false;           // Mouse didn't move: nothing new
+    Stroke before = s;                                  // In case the new point breaks the fit
+    s.L += std::sqrt(static_cast<double>(dx*dx + dy*dy));
+    accumulate(s, p);
+    double err = solve(s, s.fit);
+    if (err <= static_cast<double>(tol)*tol) return false;
+    // Too much error: close the segment as it was, start the next one at its end
+    for (int j=0; j<3; j++) closed[j] = before.fit[j];
+    begin(s, before.last);
+    s.L = std::sqrt(static_cast<double>(dx*dx + dy*dy));
+    accumulate(s, p);
+    solve(s, s.fit);
+    return true;
+}
+
+bool Fit::end(Stroke& s, SDL_FPoint* closed)
+{ // Close the open segment (if it has any length)
+    if (s.L <= 0) return false;
+    for (int j=0; j<3; j++) closed[j] = s.fit[j];
+    begin(s, s.last);
+    return true;
+}
+
+#endif // __MG_FIT_H__
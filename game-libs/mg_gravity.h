@@ -0,0 +1,362 @@
+#ifndef __MG_GRAVITY_H__
+#define __MG_GRAVITY_H__
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include "mg_jobs.h"
+
+namespace Gravity
+{ // Everything pulls on everything: N-body gravity, Barnes-Hut style
+    /* *************Why Barnes-Hut***************
+     * Every body pulls on every other body: N^2 pulls a frame. At N=4096
+     * that's 16 million, at N=100000 it's 10 billion.
+     *
+     * But a far away clump of bodies pulls about the same as one big body at
+     * the clump's center of mass. Barnes-Hut puts the bodies in a quadtree
+     * (each cell split into 4 until a cell has a few bodies), and each body
+     * walks the tree from the top:
+     *
+     *      - a cell that looks small from here (size/distance < THETA) pulls
+     *        like one body: its total mass at its center of mass. Skip what
+     *        is inside it.
+     *      - a cell that looks big: look inside it (its 4 children)
+     *      - a leaf that looks big: pull body by body
+     *
+     * That's about log(N) pulls per body instead of N. THETA=0 is the exact
+     * sum (slow), bigger THETA is faster and less accurate. 0.5 is the usual.
+     * *******************************/
+    /* *************A quadtree without pointers***************
+     * The tree is rebuilt every frame (everything moves), so building it has
+     * to be cheap. No new/delete of nodes, no pointers:
+     *
+     *      - Morton code: cut the bounding square into a 65536x65536 grid, and
+     *        interleave the bits of the x and y grid index: y15 x15 y14 x14 ...
+     *        The top 2 bits say which quarter of the square the body is in,
+     *        the next 2 bits which quarter of that quarter, and so on.
+     *      - Sort the bodies by code (radix sort, 4 passes, no compares). Now
+     *        every quadtree cell is a contiguous run of the sorted bodies.
+     *      - The nodes are an array in depth-first order. A node's children
+     *        come right after it, and node.next says where its subtree ends.
+     *        Walking the tree is a loop: open a node (i+1) or skip it
+     *        (node.next). No stack, no recursion.
+     *
+     * A cell with all its bodies in one quarter does not get a node: it skips
+     * straight down to the cell where the bodies split up (the common prefix of
+     * the first and last code says how far). So every inner node has 2+
+     * children, and there are fewer than 2N nodes.
+     *
+     * The sorted bodies are also copied into sorted order, so bodies that are
+     * next to each other in space are next to each other in memory, and a run
+     * of neighbors walks almost the same nodes.
+     * *******************************/
+    constexpr int LEAF = 8;                         // Most bodies in a leaf (more only at the bottom of the tree)
+    constexpr int LEVELS = 16;                      // Morton code: 16 bits of x, 16 bits of y
+
+    struct Rules
+    {
+        float G;                            // Gravitational constant (in pixels, frames, and masses)
+        float soft;                         // Softening: pull as if 1/(d^2 + soft^2) (no slingshots at d=0)
+        float theta;                        // Cell size/distance below this pulls as one body
+        float dt;                           // Frames per step
+    };
+
+    struct Node
+    { // A quadtree cell: sorted bodies [first:last)
+        float mx, my;                       // Center of mass
+        float mass;                         // Total mass
+        float size2;                        // (Cell size)^2
+        int first, last;                    // Sorted bodies in the cell
+        int next;                           // First node after this subtree (i+1 : a leaf)
+    };
+
+    struct Bodies
+    {
+        // Bodies, structure-of-arrays, in body order (body i is always i)
+        float* x; float* y;                 // Position
+        float* vx; float* vy;               // Velocity (pixels per frame)
+        float* m;                           // Mass
+        int count;
+        int capacity;
+        float w, h;                         // World: bodies bounce off the edges of [0:w]x[0:h] (0 : no walls)
+        Rules rules;
+        // Tree (rebuilt every step)
+        uint32_t* code;                     // Morton code of sorted slot k
+        int* order;                         // order[k] : body in sorted slot k
+        uint32_t* code_tmp; int* order_tmp; // Radix sort scratch
+        float* sx; float* sy; float* sm;    // Sorted copies (Morton order)
+        Node* nodes;                        // Depth-first order, nodes[0] is the root
+        int nnodes;
+        float root_x, root_y, root_size;    // Bounding square of the bodies
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    Rules default_rules(void);                      // Spinner centers fall together in a few seconds
+    void alloc(Bodies&, int capacity, float w, float h, Rules rules); // Remember to release(bodies)
+    void release(Bodies&);
+    void add(Bodies&, float x, float y, float vx, float vy, float m); // Add a body (index is count before)
+    void rescale(Bodies&, float k);                 // World is k times bigger (or smaller)
+    uint32_t morton(uint32_t gx, uint32_t gy);      // Interleave two 16-bit grid indices
+    void sort(Bodies&);                             // Morton codes, radix sort, sorted copies
+    void build(Bodies&);                            // Quadtree over the sorted bodies (after sort)
+    void accel(const Bodies&, float px, float py, float& ax, float& ay); // Pull at p, from the tree
+    void direct(const Bodies&, float px, float py, float& ax, float& ay); // Pull at p, every body (N^2)
+    void pull(Bodies&, int begin, int end);         // Accelerate + move sorted slots [begin:end)
+    void step(Bodies&, Jobs::Pool&);                // One frame: sort, build, pull in parallel
+}
+
+Gravity::Rules Gravity::default_rules(void)
+{
+    return Rules{.G=0.2f, .soft=4, .theta=0.5f, .dt=1};
+}
+
+void Gravity::alloc(Bodies& b, int capacity, float w, float h, Rules rules)
+{
+    b.capacity = capacity; b.count = 0;
+    b.w = w; b.h = h;
+    b.rules = rules;
+    b.x = (float*)malloc(sizeof(float)*capacity);  b.y = (float*)malloc(sizeof(float)*capacity);
+    b.vx = (float*)malloc(sizeof(float)*capacity); b.vy = (float*)malloc(sizeof(float)*capacity);
+    b.m = (float*)malloc(sizeof(float)*capacity);
+    b.code = (uint32_t*)malloc(sizeof(uint32_t)*capacity);
+    b.code_tmp = (uint32_t*)malloc(sizeof(uint32_t)*capacity);
+    b.order = (int*)malloc(sizeof(int)*capacity);
+    b.order_tmp = (int*)malloc(sizeof(int)*capacity);
+    b.sx = (float*)malloc(sizeof(float)*capacity); b.sy = (float*)malloc(sizeof(float)*capacity);
+    b.sm = (float*)malloc(sizeof(float)*capacity);
+    b.nodes = (Node*)malloc(sizeof(Node)*(2*capacity + 1));   // Inner nodes have 2+ children: < 2N nodes
+    b.nnodes = 0;
+}
+
+void Gravity::release(Bodies& b)
+{
+    free(b.x); free(b.y); free(b.vx); free(b.vy); free(b.m);
+    free(b.code); free(b.code_tmp); free(b.order); free(b.order_tmp);
+    free(b.sx); free(b.sy); free(b.sm); free(b.nodes);
+    b.x = NULL; b.y = NULL; b.vx = NULL; b.vy = NULL; b.m = NULL;
+    b.code = NULL; b.code_tmp = NULL; b.order = NULL; b.order_tmp = NULL;
+    b.sx = NULL; b.sy = NULL; b.sm = NULL; b.nodes = NULL;
+    b.count = 0; b.capacity = 0; b.nnodes = 0;
+}
+
+void Gravity::add(Bodies& b, float x, float y, float vx, float vy, float m)
+{
+    assert(b.count < b.capacity);
+    int i = b.count++;
+    b.x[i] = x; b.y[i] = y; b.vx[i] = vx; b.vy[i] = vy; b.m[i] = m;
+}
+
+void Gravity::rescale(Bodies& b, float k)
+{ // Scale every length: positions, velocities, walls, softening
+    /* *************DOC***************
+     * Pull goes as G/d^2. With every distance k times bigger, G has to be
+     * k^3 times bigger for the pull (an acceleration, pixels per frame^2) to
+     * be k times bigger too. Then every orbit is the same orbit, scaled.
+     * *******************************/
+    for (int i=0; i<b.count; i++)
+    {
+        b.x[i] *= k; b.y[i] *= k; b.vx[i] *= k; b.vy[i] *= k;
+    }
+    b.w *= k; b.h *= k;
+    b.rules.soft *= k;
+    b.rules.G *= k*k*k;
+}
+
+uint32_t Gravity::morton(uint32_t gx, uint32_t gy)
+{ // Spread the 16 bits of each out to every other bit, then y bits go above x bits
+    auto spread = [](uint32_t v)
+    {
+        v &= 0x0000FFFF;
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return (spread(gy) << 1) | spread(gx);
+}
+
+void Gravity::sort(Bodies& b)
+{ // Bounding square, Morton codes, radix sort, copy into sorted order
+    if (b.count == 0) return;
+    float x0 = b.x[0]; float x1 = b.x[0]; float y0 = b.y[0]; float y1 = b.y[0];
+    for (int i=1; i<b.count; i++)
+    {
+        x0 = std::fmin(x0, b.x[i]); x1 = std::fmax(x1, b.x[i]);
+        y0 = std::fmin(y0, b.y[i]); y1 = std::fmax(y1, b.y[i]);
+    }
+    float size = std::fmax(std::fmax(x1 - x0, y1 - y0), 1e-6f);
+    b.root_x = x0; b.root_y = y0; b.root_size = size;
+    const float k = 65535.0f/size;                  // Position to grid index (0 to 65535)
+    for (int i=0; i<b.count; i++)
+    {
+        uint32_t gx = std::min(static_cast<uint32_t>((b.x[i] - x0)*k), 65535u);  // (Rounding at x1)
+        uint32_t gy = std::min(static_cast<uint32_t>((b.y[i] - y0)*k), 65535u);
+        b.code[i] = morton(gx, gy);
+        b.order[i] = i;
+    }
+    // Radix sort, 8 bits at a time (LSD: each pass keeps the order of the pass before)
+    for (int shift=0; shift<32; shift+=8)
+    {
+        int start[257] = {};
+        for (int i=0; i<b.count; i++) start[((b.code[i] >> shift) & 0xFF) + 1]++;
+        for (int d=0; d<256; d++) start[d+1] += start[d];       // Counts to starts
+        for (int i=0; i<b.count; i++)
+        {
+            int k = start[(b.code[i] >> shift) & 0xFF]++;
+            b.code_tmp[k] = b.code[i]; b.order_tmp[k] = b.order[i];
+        }
+        std::swap(b.code, b.code_tmp); std::swap(b.order, b.order_tmp);
+    }
+    for (int k=0; k<b.count; k++)
+    {
+        const int i = b.order[k];
+        b.sx[k] = b.x[i]; b.sy[k] = b.y[i]; b.sm[k] = b.m[i];
+    }
+}
+
+void Gravity::build(Bodies& b)
+{ // Depth-first nodes over the sorted bodies, then masses from the bottom up
+    /* *************DOC***************
+     * Node for sorted bodies [first:last): the codes of first and last-1 agree
+     * on their top 2*level bits, so all of them are in the same cell at that
+     * level (cell size root_size/2^level). Split the run into the (up to) 4
+     * quarters by the next 2 bits, and do the same for each quarter.
+     *
+     * Depth is at most LEVELS, so the recursion is at most 17 deep.
+     * *******************************/
+    b.nnodes = 0;
+    if (b.count == 0) return;
+    auto make = [&b](auto& make, int first, int last) -> void
+    {
+        const int i = b.nnodes++;
+        Node& n = b.nodes[i];
+        n.first = first; n.last = last;
+        const uint32_t differ = b.code[first] ^ b.code[last-1];
+        const int level = (differ == 0) ? LEVELS : std::countl_zero(differ)/2;
+        const float size = std::ldexp(b.root_size, -level);
+        n.size2 = size*size;
+        if ((last - first > LEAF) && (level < LEVELS))
+        { // Split into quarters by the 2 bits below the common prefix
+            const int shift = 2*(LEVELS - 1 - level);
+            int from = first;
+            for (uint32_t q=0; q<4; q++)
+            {
+                int to = static_cast<int>(std::upper_bound(b.code + from, b.code + last, q,
+                            [shift](uint32_t q, uint32_t c) { return q < ((c >> shift) & 3); }) - b.code);
+                if (to > from) make(make, from, to);
+                from = to;
+            }
+        }
+        Node& done = b.nodes[i];                    // (Same node: nodes never moves)
+        done.next = b.nnodes;
+        float mass = 0; float mx = 0; float my = 0;
+        if (done.next == i+1)
+        { // Leaf: add up the bodies
+            for (int k=first; k<last; k++) { mass += b.sm[k]; mx += b.sm[k]*b.sx[k]; my += b.sm[k]*b.sy[k]; }
+        }
+        else
+        { // Add up the children
+            for (int c=i+1; c<done.next; c=b.nodes[c].next)
+            {
+                const Node& ch = b.nodes[c];
+                mass += ch.mass; mx += ch.mass*ch.mx; my += ch.mass*ch.my;
+            }
+        }
+        done.mass = mass;
+        done.mx = (mass > 0) ? mx/mass : b.sx[first];
+        done.my = (mass > 0) ? my/mass : b.sy[first];
+    };
+    make(make, 0, b.count);
+    assert(b.nnodes <= 2*b.capacity + 1);
+}
+
+void Gravity::accel(const Bodies& b, float px, float py, float& ax, float& ay)
+{ // Walk the tree: far cells pull as one body, near cells are opened
+    const float theta2 = b.rules.theta*b.rules.theta;
+    const float soft2 = b.rules.soft*b.rules.soft;
+    float sum_x = 0; float sum_y = 0;
+    int i = 0;
+    while (i < b.nnodes)
+    {
+        const Node& n = b.nodes[i];
+        const float dx = n.mx - px; const float dy = n.my - py;
+        const float d2 = dx*dx + dy*dy;
+        if (n.size2 < theta2*d2)
+        { // Far enough: the whole cell pulls from its center of mass
+            const float r2 = d2 + soft2;
+            const float f = n.mass/(r2*std::sqrt(r2));
+            sum_x += f*dx; sum_y += f*dy;
+            i = n.next;
+        }
+        else if (n.next == i+1)
+        { // Near leaf: body by body (a body pulling on itself adds 0: dx=dy=0)
+            for (int k=n.first; k<n.last; k++)
+            {
+                const float bx = b.sx[k] - px; const float by = b.sy[k] - py;
+                const float r2 = bx*bx + by*by + soft2;
+                const float f = b.sm[k]/(r2*std::sqrt(r2));
+                sum_x += f*bx; sum_y += f*by;
+            }
+            i = n.next;
+        }
+        else i++;                                   // Near: open it (first child is next)
+    }
+    ax = b.rules.G*sum_x; ay = b.rules.G*sum_y;
+}
+
+void Gravity::direct(const Bodies& b, float px, float py, float& ax, float& ay)
+{ // Every body pulls: the exact sum, to check accel() against
+    const float soft2 = b.rules.soft*b.rules.soft;
+    double sum_x = 0; double sum_y = 0;
+    for (int i=0; i<b.count; i++)
+    {
+        const float dx = b.x[i] - px; const float dy = b.y[i] - py;
+        const float r2 = dx*dx + dy*dy + soft2;
+        const float f = b.m[i]/(r2*std::sqrt(r2));
+        sum_x += f*dx; sum_y += f*dy;
+    }
+    ax = b.rules.G*static_cast<float>(sum_x); ay = b.rules.G*static_cast<float>(sum_y);
+}
+
+void Gravity::pull(Bodies& b, int begin, int end)
+{ // Accelerate and move the bodies in sorted slots [begin:end)
+    const float dt = b.rules.dt;
+    for (int k=begin; k<end; k++)
+    {
+        float ax; float ay;
+        accel(b, b.sx[k], b.sy[k], ax, ay);
+        // Move (semi-implicit Euler). Safe to write: every body reads the sorted copies, not these.
+        const int i = b.order[k];
+        float vx = b.vx[i] + ax*dt; float vy = b.vy[i] + ay*dt;
+        float x = b.sx[k] + vx*dt;  float y = b.sy[k] + vy*dt;
+        if (b.w > 0)
+        { // Bounce off the walls
+            if (x < 0)   { x = -x;        vx = -vx; }
+            if (x > b.w) { x = 2*b.w - x; vx = -vx; }
+            x = std::fmin(std::fmax(x, 0.0f), b.w);      // (Too fast to bounce back inside)
+        }
+        if (b.h > 0)
+        {
+            if (y < 0)   { y = -y;        vy = -vy; }
+            if (y > b.h) { y = 2*b.h - y; vy = -vy; }
+            y = std::fmin(std::fmax(y, 0.0f), b.h);
+        }
+        b.vx[i] = vx; b.vy[i] = vy; b.x[i] = x; b.y[i] = y;
+    }
+}
+
+void Gravity::step(Bodies& b, Jobs::Pool& pool)
+{ // One frame of gravity
+    sort(b);                                        // O(count), one thread
+    build(b);                                       // O(count), one thread
+    // Neighbors in Morton order walk the same nodes: chunks of neighbors
+    Jobs::parallel_for(pool, b.count, 1<<10, [&b](int begin, int end) { pull(b, begin, end); });
+}
+
+#endif // __MG_GRAVITY_H__
@@ -0,0 +1,174 @@
+#ifndef __MG_INTERSECT_H__
+#define __MG_INTERSECT_H__
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace Intersect
+{ // Where do two quadratic dCB curves cross?
+    /* *************Intersection by subdivision***************
+     * A dCB curve stays inside the triangle of its control points, so it stays
+     * inside the box around its control points. If the boxes of two curves do
+     * not overlap, the curves do not cross. Done.
+     *
+     * If the boxes do overlap, cut the bigger curve in half and try again with
+     * each half. Cutting a dCB curve in half is de Casteljau's construction at
+     * λ=1/2, and each half is ALSO a quadratic dCB curve (with new control
+     * points), so the same box test works on the halves.
+     *
+     * The halves get flatter every cut. Once both pieces are flat (within tol
+     * of a straight line), intersect them as two line segments, and that's
+     * the crossing point. Pieces that never get flat (two curves that just
+     * touch) stop at MAX_DEPTH cuts.
+     *
+     * No recursion: the pieces waiting to be checked go on a little stack.
+     * *******************************/
+    struct Hit
+    {
+        float la;                           // λ on the first curve
+        float lb;                           // λ on the second curve
+        SDL_FPoint p;                       // Where they cross
+    };
+
+    constexpr int MAX_DEPTH = 48;                   // Cuts (of either curve) before giving up on flat
+    constexpr int STACK_SIZE = MAX_DEPTH + 2;       // Each cut pushes two pieces, pops one
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    SDL_FRect hull_box(const SDL_FPoint* cp);       // Box around the control points
+    void split(const SDL_FPoint* cp, SDL_FPoint* left, SDL_FPoint* right); // Cut in half
+    bool flat(const SDL_FPoint* cp, float tol);     // Curve within tol of its chord?
+    bool segments(SDL_FPoint a0, SDL_FPoint a1, SDL_FPoint b0, SDL_FPoint b1, float* s, float* t);
+    int dCB_dCB(const SDL_FPoint* A, const SDL_FPoint* B, float tol, Hit* hits, int max_hits);
+}
+
+SDL_FRect Intersect::hull_box(const SDL_FPoint* cp)
+{
+    float xmin = std::min(cp[0].x, std::min(cp[1].x, cp[2].x));
+    float xmax = std::max(cp[0].x, std::max(cp[1].x, cp[2].x));
+    float ymin = std::min(cp[0].y, std::min(cp[1].y, cp[2].y));
+    float ymax = std::max(cp[0].y, std::max(cp[1].y, cp[2].y));
+    return SDL_FRect{.x=xmin, .y=ymin, .w=xmax-xmin, .h=ymax-ymin};
+}
+
+void Intersect::split(const SDL_FPoint* cp, SDL_FPoint* left, SDL_FPoint* right)
+{ // de Casteljau at λ=1/2: the midpoints of the JOINs, then the midpoint of those
+    SDL_FPoint q0 = {.x=0.5f*(cp[0].x + cp[1].x), .y=0.5f*(cp[0].y + cp[1].y)};
+    SDL_FPoint q1 = {.x=0.5f*(cp[1].x + cp[2].x), .y=0.5f*(cp[1].y + cp[2].y)};
+    SDL_FPoint m  = {.x=0.5f*(q0.x + q1.x),       .y=0.5f*(q0.y + q1.y)};
+    left[0]  = cp[0]; left[1]  = q0; left[2]  = m;
+    right[0] = m;     right[1] = q1; right[2] = cp[2];
+}
+
+bool Intersect::flat(const SDL_FPoint* cp, float tol)
+{ // The curve is at most |P0-2*P1+P2|/4 from its chord (at λ=1/2)
+    float ax = cp[0].x - 2*cp[1].x + cp[2].x; float ay = cp[0].y - 2*cp[1].y + cp[2].y;
+    return (ax*ax + ay*ay) <= 16*tol*tol;
+}
+
+bool Intersect::segments(SDL_FPoint a0, SDL_FPoint a1, SDL_FPoint b0, SDL_FPoint b1, float* s, float* t)
+{ // Do segments a0-a1 and b0-b1 cross? s, t : where along each segment
+    float dax = a1.x - a0.x; float day = a1.y - a0.y;
+    float dbx = b1.x - b0.x; float dby = b1.y - b0.y;
+    float den = dax*dby - day*dbx;                  // Cross product: 0 if parallel
+    if (den == 0) return false;
+    float ex = b0.x - a0.x; float ey = b0.y - a0.y;
+    *s = (ex*dby - ey*dbx)/den;
+    *t = (ex*day - ey*dax)/den;
+    // A little slack: a crossing right at a cut shows up in both pieces (duplicates
+    // get merged), better than falling through the crack between them
+    constexpr float SLACK = 1e-4f;
+    return (*s >= -SLACK) && (*s <= 1+SLACK) && (*t >= -SLACK) && (*t <= 1+SLACK);
+}
+
+int Intersect::dCB_dCB(const SDL_FPoint* A, const SDL_FPoint* B, float tol, Hit* hits, int max_hits)
+{ // All crossings of quadratic dCB curves A and B
+    /* *************DOC***************
+     * Parameters
+     * ----------
+     * A, B : 3 control points each
+     * tol : float
+     *      pixels, how close the reported crossing is to the true crossing
+     *      (0.01 is plenty for drawing)
+     * hits : room for max_hits hits
+     *
+     * Return
+     * ------
+     * number of hits written (two quadratics cross at most 4 times)
+     * *******************************/
+    struct Piece
+    { // A piece of A and a piece of B, and where the pieces are on the whole curves
+        SDL_FPoint a[3]; SDL_FPoint b[3];
+        float a0, a1, b0, b1;                       // λ ranges: [a0:a1] of A, [b0:b1] of B
+        int depth;
+    };
+    Piece stack[STACK_SIZE];
+    int top = 0;
+    { // Start with the whole curves
+        Piece& p = stack[top++];
+        for (int j=0; j<3; j++) { p.a[j] = A[j]; p.b[j] = B[j]; }
+        p.a0 = 0; p.a1 = 1; p.b0 = 0; p.b1 = 1; p.depth = 0;
+    }
+    int n = 0;
+    while (top > 0)
+    {
+        Piece p = stack[--top];
+        SDL_FRect ba = hull_box(p.a); SDL_FRect bb = hull_box(p.b);
+        bool overlap = (ba.x <= bb.x + bb.w) && (bb.x <= ba.x + ba.w) &&
+                       (ba.y <= bb.y + bb.h) && (bb.y <= ba.y + ba.h);
+        if (!overlap) continue;                     // Most pieces end here
+        bool both_flat = flat(p.a, tol) && flat(p.b, tol);
+        if (both_flat || (p.depth >= MAX_DEPTH))
+        { // Small enough: this is a crossing
+            float s; float t;
+            Hit hit;
+            if (both_flat)
+            { // Cross the chords
+                if (!segments(p.a[0], p.a[2], p.b[0], p.b[2], &s, &t)) continue;
+                s = std::min(std::max(s, 0.0f), 1.0f); t = std::min(std::max(t, 0.0f), 1.0f);
+                hit.p = SDL_FPoint{.x=p.a[0].x + s*(p.a[2].x - p.a[0].x), .y=p.a[0].y + s*(p.a[2].y - p.a[0].y)};
+            }
+            else
+            { // Touching curves: the pieces are tiny boxes, call it the middle
+                s = 0.5f; t = 0.5f;
+                hit.p = SDL_FPoint{.x=ba.x + 0.5f*ba.w, .y=ba.y + 0.5f*ba.h};
+            }
+            hit.la = p.a0 + s*(p.a1 - p.a0);
+            hit.lb = p.b0 + t*(p.b1 - p.b0);
+            bool repeat = false;                    // Same crossing found from a neighboring piece?
+            for (int i=0; i<n; i++)
+            {
+                float dx = hits[i].p.x - hit.p.x; float dy = hits[i].p.y - hit.p.y;
+                if (dx*dx + dy*dy <= 4*tol*tol) { repeat = true; break; }
+            }
+            if (!repeat)
+            {
+                if (n == max_hits) return n;
+                hits[n++] = hit;
+            }
+            continue;
+        }
+        // Cut the bigger piece in half (the other piece stays whole)
+        Piece lo = p; Piece hi = p;
+        lo.depth = p.depth+1; hi.depth = p.depth+1;
+        if (ba.w + ba.h >= bb.w + bb.h)
+        {
+            split(p.a, lo.a, hi.a);
+            float mid = 0.5f*(p.a0 + p.a1);
+            lo.a1 = mid; hi.a0 = mid;
+        }
+        else
+        {
+            split(p.b, lo.b, hi.b);
+            float mid = 0.5f*(p.b0 + p.b1);
+            lo.b1 = mid; hi.b0 = mid;
+        }
+        assert(top+2 <= STACK_SIZE);
+        stack[top++] = hi; stack[top++] = lo;       // lo on top: find crossings in λ order
+    }
+    return n;
+}
+
+#endif // __MG_INTERSECT_H__
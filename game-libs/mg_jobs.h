@@ -0,0 +1,158 @@
+#ifndef __MG_JOBS_H__
+#define __MG_JOBS_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Jobs
+{ // Split a loop across all the CPU cores
+    /* *************How to use a Pool***************
+     * Start the worker threads once, then hand them loops:
+     *
+     *      Jobs::Pool pool;
+     *      Jobs::start(pool);                          // One worker per core (minus this one)
+     *      Jobs::parallel_for(pool, count, 1<<10, [&](int begin, int end)
+     *      {
+     *          for (int i=begin; i<end; i++) { ... }   // Same loop as before, on [begin:end)
+     *      });
+     *      Jobs::stop(pool);                           // Remember to stop(pool)
+     *
+     * parallel_for cuts [0:count) into chunks. The workers AND the calling
+     * thread grab chunks until there are none left, then parallel_for
+     * returns. So a loop over SoA arrays just works, as long as each i only
+     * writes its own slot.
+     *
+     * Chunk size: big enough that grabbing a chunk (one atomic add) is noise
+     * next to the work in it, small enough that every core gets several (a
+     * core that finishes early grabs more, so uneven chunks even out).
+     *
+     * Starting threads is slow (tens of microseconds each), so the workers
+     * are started once and sleep on a condition variable between loops.
+     * *******************************/
+    struct Pool
+    {
+        std::thread* workers;               // Worker threads (the caller is one more)
+        int nworkers;
+        std::mutex m;
+        std::condition_variable wake;       // Workers wait here for a loop
+        std::condition_variable done;       // parallel_for waits here for the workers
+        const std::function<void(int,int)>* task; // The loop body, on [begin:end)
+        std::atomic<int> next;              // Start of the next chunk nobody has taken
+        int count;                          // Loop is [0:count)
+        int chunk;                          // Chunk size
+        long generation;                    // Counts loops: a worker wakes when this changes
+        int busy;                           // Workers still in the current loop
+        bool quit;
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    void start(Pool&, int nworkers=-1);             // -1 : one worker per core, minus the caller
+    void stop(Pool&);
+    void parallel_for(Pool&, int count, int chunk, const std::function<void(int,int)>& body);
+    void run_chunks(Pool&);                         // Grab chunks until none are left
+    void worker(Pool*);                             // Worker thread main loop
+    int threads(const Pool&);                       // Workers plus the caller
+}
+
+void Jobs::start(Pool& pool, int nworkers)
+{
+    if (nworkers < 0)
+    {
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        nworkers = (cores > 1) ? cores-1 : 0;       // (0 : unknown or one core, caller does it all)
+    }
+    pool.nworkers = nworkers;
+    pool.task = NULL;
+    pool.next = 0; pool.count = 0; pool.chunk = 1;
+    pool.generation = 0; pool.busy = 0; pool.quit = false;
+    pool.workers = new std::thread[nworkers];
+    for (int i=0; i<nworkers; i++) pool.workers[i] = std::thread(worker, &pool);
+}
+
+void Jobs::stop(Pool& pool)
+{
+    {
+        std::lock_guard<std::mutex> lock(pool.m);
+        pool.quit = true;
+    }
+    pool.wake.notify_all();
+    for (int i=0; i<pool.nworkers; i++) pool.workers[i].join();
+    delete[] pool.workers;
+    pool.workers = NULL; pool.nworkers = 0;
+}
+
+int Jobs::threads(const Pool& pool)
+{
+    return pool.nworkers + 1;
+}
+
+void Jobs::run_chunks(Pool& pool)
+{
+    const std::function<void(int,int)>& body = *pool.task;
+    for (;;)
+    {
+        int begin = pool.next.fetch_add(pool.chunk);
+        if (begin >= pool.count) return;
+        int end = (begin + pool.chunk < pool.count) ? begin + pool.chunk : pool.count;
+        body(begin, end);
+    }
+}
+
+void Jobs::worker(Pool* pool)
+{
+    long seen = 0;                                  // Last loop this worker did
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(pool->m);
+            pool->wake.wait(lock, [&]{ return pool->quit || (pool->generation != seen); });
+            if (pool->quit) return;
+            seen = pool->generation;
+        }
+        run_chunks(*pool);
+        {
+            std::lock_guard<std::mutex> lock(pool->m);
+            pool->busy--;
+        }
+        pool->done.notify_one();
+    }
+}
+
+void Jobs::parallel_for(Pool& pool, int count, int chunk, const std::function<void(int,int)>& body)
+{ // Run body on [0:count) in chunks, on every thread, return when all of it is done
+    /* *************DOC***************
+     * Parameters
+     * ----------
+     * pool : started with start(pool)
+     * count : loop is [0:count)
+     * chunk : indices per grab (see "How to use a Pool")
+     * body : void(int begin, int end)
+     *      called with [begin:end) ranges that cover [0:count) exactly once,
+     *      from several threads at the same time
+     *
+     * Small loops (one chunk or less) just run on the calling thread.
+     * *******************************/
+    if (count <= 0) return;
+    if (chunk < 1) chunk = 1;
+    if ((pool.nworkers == 0) || (count <= chunk)) { body(0, count); return; }
+    {
+        std::lock_guard<std::mutex> lock(pool.m);
+        pool.task = &body;
+        pool.count = count; pool.chunk = chunk;
+        pool.next = 0;
+        pool.busy = pool.nworkers;
+        pool.generation++;
+    }
+    pool.wake.notify_all();
+    run_chunks(pool);                               // The caller works too
+    std::unique_lock<std::mutex> lock(pool.m);
+    pool.done.wait(lock, [&]{ return pool.busy == 0; });
+    pool.task = NULL;
+}
+
+#endif // __MG_JOBS_H__
@@ -0,0 +1,172 @@
+#ifndef __MG_PARTICLES_H__
+#define __MG_PARTICLES_H__
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+namespace Particles
+{ // Short-lived particles: sparks, debris, smoke
+    /* *************Pools and emitters***************
+     * A Pool holds every live particle of one kind (all the sparks, say) in
+     * structure-of-arrays, packed at the front: particles [0:count) are alive.
+     * The arrays are allocated once, at alloc(). After that nothing is ever
+     * malloc'd or freed, however many particles come and go.
+     *
+     * An Emitter spawns particles into a pool: so many per frame, from a
+     * point or off the rim of a circle, headed out at some speed, with a
+     * lifetime. When the pool is full, new particles are dropped (and
+     * counted), not squeezed in.
+     *
+     * Each frame:
+     *
+     *      - emit(): every emitter adds its particles at the end
+     *      - update(): every particle moves and gets older (a plain loop over
+     *        the arrays, splits across threads)
+     *      - kill(): one pass removes every particle that is too old. A dead
+     *        particle is overwritten by the LAST live particle (swap and pop),
+     *        so nothing shifts down and the pool stays packed. The order of
+     *        the particles changes, but particles don't care about order.
+     *
+     * Killing in one batch after update (instead of inside the update loop)
+     * keeps the update loop free of branches and copies.
+     * *******************************/
+    struct Pool
+    {
+        float* x; float* y;                 // Position
+        float* vx; float* vy;               // Velocity (pixels per frame)
+        float* age; float* life;            // Frames lived, frames to live
+        int count;                          // Live particles are [0:count)
+        int capacity;
+        float ax, ay;                       // Acceleration on every particle (like gravity)
+        float drag;                         // Fraction of velocity lost per frame
+        long spawned, killed, dropped;      // Totals (dropped : pool was full)
+    };
+
+    struct Emitter
+    {
+        float x, y;                         // Where
+        float radius;                       // Spawn on this circle, headed out (0 : a point)
+        float rate;                         // Particles per frame (a fraction carries over)
+        float carry;                        // Fraction of a particle owed from last frame
+        float heading, spread;              // Headed heading +/- spread radians (spread pi : every way)
+        float speed, speed_jitter;          // Pixels per frame, +/- jitter
+        float life, life_jitter;            // Frames, +/- jitter
+        uint32_t seed;                      // Random number state (xorshift), any nonzero value
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    void alloc(Pool&, int capacity, float ax, float ay, float drag); // Remember to release(pool)
+    void release(Pool&);
+    bool spawn(Pool&, float x, float y, float vx, float vy, float life); // false : pool is full
+    float random(Emitter&);                         // Random float in [-1:1]
+    int burst(Pool&, Emitter&, int n);              // Spawn n now, return how many fit
+    int emit(Pool&, Emitter&);                      // Spawn this frame's share of rate
+    void update(Pool&, int begin, int end);         // Move and age particles [begin:end)
+    int kill(Pool&);                                // Remove the dead (swap and pop), return how many
+    void rescale(Pool&, float k);                   // World is k times bigger (or smaller)
+    void rescale(Emitter&, float k);
+}
+
+void Particles::alloc(Pool& p, int capacity, float ax, float ay, float drag)
+{
+    p.capacity = capacity; p.count = 0;
+    p.ax = ax; p.ay = ay; p.drag = drag;
+    p.spawned = 0; p.killed = 0; p.dropped = 0;
+    p.x = (float*)malloc(sizeof(float)*capacity);   p.y = (float*)malloc(sizeof(float)*capacity);
+    p.vx = (float*)malloc(sizeof(float)*capacity);  p.vy = (float*)malloc(sizeof(float)*capacity);
+    p.age = (float*)malloc(sizeof(float)*capacity); p.life = (float*)malloc(sizeof(float)*capacity);
+}
+
+void Particles::release(Pool& p)
+{
+    free(p.x); free(p.y); free(p.vx); free(p.vy); free(p.age); free(p.life);
+    p.x = NULL; p.y = NULL; p.vx = NULL; p.vy = NULL; p.age = NULL; p.life = NULL;
+    p.count = 0; p.capacity = 0;
+}
+
+bool Particles::spawn(Pool& p, float x, float y, float vx, float vy, float life)
+{
+    if (p.count == p.capacity) { p.dropped++; return false; }
+    int i = p.count++;
+    p.x[i] = x; p.y[i] = y; p.vx[i] = vx; p.vy[i] = vy;
+    p.age[i] = 0; p.life[i] = life;
+    p.spawned++;
+    return true;
+}
+
+float Particles::random(Emitter& e)
+{ // xorshift32: three shifts and xors, good enough for sparks
+    assert(e.seed != 0);
+    e.seed ^= e.seed << 13; e.seed ^= e.seed >> 17; e.seed ^= e.seed << 5;
+    return static_cast<float>(e.seed)*(2.0f/4294967296.0f) - 1.0f;
+}
+
+int Particles::burst(Pool& p, Emitter& e, int n)
+{
+    int made = 0;
+    for (int k=0; k<n; k++)
+    {
+        const float a = e.heading + e.spread*random(e);
+        const float c = std::cos(a); const float s = std::sin(a);
+        const float speed = e.speed + e.speed_jitter*random(e);
+        const float life = e.life + e.life_jitter*random(e);
+        made += spawn(p, e.x + e.radius*c, e.y + e.radius*s, speed*c, speed*s, life);
+    }
+    return made;
+}
+
+int Particles::emit(Pool& p, Emitter& e)
+{ // rate 2.5 : 2, 3, 2, 3, ... particles a frame
+    const float due = e.rate + e.carry;
+    const int n = static_cast<int>(due);
+    e.carry = due - static_cast<float>(n);
+    return burst(p, e, n);
+}
+
+void Particles::update(Pool& p, int begin, int end)
+{ // Each particle only touches its own slot: split [begin:end) across threads
+    const float keep = 1 - p.drag;
+    for (int i=begin; i<end; i++)
+    {
+        p.vx[i] = keep*p.vx[i] + p.ax; p.vy[i] = keep*p.vy[i] + p.ay;
+        p.x[i] += p.vx[i]; p.y[i] += p.vy[i];
+        p.age[i] += 1;
+    }
+}
+
+int Particles::kill(Pool& p)
+{ // Swap and pop: the last live particle moves into the dead one's slot
+    const int before = p.count;
+    int i = 0;
+    while (i < p.count)
+    {
+        if (p.age[i] < p.life[i]) { i++; continue; }
+        const int last = --p.count;             // Check slot i again: the particle moved in may be dead too
+        p.x[i] = p.x[last]; p.y[i] = p.y[last];
+        p.vx[i] = p.vx[last]; p.vy[i] = p.vy[last];
+        p.age[i] = p.age[last]; p.life[i] = p.life[last];
+    }
+    p.killed += before - p.count;
+    return before - p.count;
+}
+
+void Particles::rescale(Pool& p, float k)
+{ // Positions, velocities, acceleration (ages don't change)
+    for (int i=0; i<p.count; i++)
+    {
+        p.x[i] *= k; p.y[i] *= k; p.vx[i] *= k; p.vy[i] *= k;
+    }
+    p.ax *= k; p.ay *= k;
+}
+
+void Particles::rescale(Emitter& e, float k)
+{
+    e.x *= k; e.y *= k; e.radius *= k;
+    e.speed *= k; e.speed_jitter *= k;
+}
+
+#endif // __MG_PARTICLES_H__
@@ -0,0 +1,505 @@
+#ifndef __MG_PATH_H__
+#define __MG_PATH_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "mg_jobs.h"
+
+namespace Path
+{ // Shortest paths on a grid of walls: A*, Jump Point Search, and a service that batches and caches them
+    /* *************A* and Jump Point Search***************
+     * The grid is uniform cost: a step to any of the 8 neighbors costs 1
+     * (straight) or sqrt(2) (diagonal), and a diagonal step can't cut the
+     * corner of a wall. A* grows the search from the start, always from the
+     * cell with the smallest f = g (cost so far) + h (octile distance left:
+     * the exact cost with no walls). Popping that cell is a binary heap.
+     *
+     * On open ground, A* pushes every cell around the path into the heap,
+     * because there are MANY shortest paths (zig-zags that cost the same).
+     * Jump Point Search only keeps one of them: from a cell it runs straight
+     * (or diagonally) until something interesting happens -- a wall corner
+     * that makes a new shortest path start there ("forced neighbor"), or the
+     * goal -- and only THAT cell, the jump point, goes in the heap. Same
+     * paths, same lengths, but the heap sees far fewer cells. Either way, a
+     * path comes out as the points where it turns: straight or diagonal runs
+     * between them.
+     *
+     * Every search needs a g and parent per cell, bits for "seen" and
+     * "closed", and a heap. A Searcher owns one of each, made once. The bits
+     * it set are remembered (touched) and cleared after the search, so a
+     * short path doesn't pay to clear a 1024x1024 grid.
+     * *******************************/
+    /* *************The service: batches and a cache***************
+     * Many agents ask for paths at the same time. find() takes a batch:
+     *
+     *      - cache first: a path is cached by (chunk of its start, goal).
+     *        Another agent in the same CHUNK x CHUNK chunk going to the same
+     *        goal re-uses it, if it can see the cached path's start (a
+     *        straight line with no walls). Then the path is the short line
+     *        plus the cached path: not always the very shortest, but close.
+     *      - the misses are searched on the job system: one Searcher per
+     *        thread (a thread takes a Searcher, then takes requests off the
+     *        batch until there are none left, so no Searcher is shared)
+     *      - then the new paths go in the cache
+     *
+     * Agents in the same batch with the same key wait for the first one's
+     * path instead of searching too. The cache is direct mapped (a key has
+     * one slot, a new path takes the slot). Change a wall : invalidate().
+     * *******************************/
+    constexpr float SQRT2 = 1.41421356f;
+    constexpr int MAX_POINTS = 1024;                    // Waypoints in a path (more : not found)
+    constexpr int CHUNK = 32;                           // Cache key: start chunk is CHUNK x CHUNK cells
+    constexpr int CACHE = 256;                          // Paths in the cache
+
+    struct Grid
+    {
+        int w, h;
+        uint8_t* wall;                      // Row-major, 1 : can't go there
+    };
+
+    struct Request { int sx, sy, gx, gy; };
+
+    struct Result
+    {
+        SDL_Point* points;                  // Caller's room for MAX_POINTS: start, jump points, goal
+        int n;                              // Points in the path (0 : no path)
+        float length;                       // In cells
+        bool cached;                        // Came from the cache
+    };
+
+    struct Node { float f; int cell; };
+
+    struct Searcher
+    { // Scratch for one search at a time
+        float* g; int* parent;              // Valid where seen
+        uint64_t* seen; uint64_t* closed;   // One bit per cell
+        int* touched; int ntouched;         // Cells with the seen bit set (clear them after)
+        Node* heap; int nheap; int heap_capacity; // Grows (realloc) if it must, then stays big
+        long searches, expanded;            // Totals
+    };
+
+    struct Service
+    {
+        const Grid* grid;
+        Searcher* searchers; int nsearchers;
+        long* keys; int* counts; float* lengths; SDL_Point* points; // Cache: slot s is points[s*MAX_POINTS]
+        int* todo; int ntodo;               // Batch scratch: requests to search
+        int* leader;                        // Batch scratch: request with the same key (-1 : none)
+        int max_batch;
+        long requests, hits, searched;      // Totals
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    void alloc(Grid&, int w, int h);                // No walls. Remember to release(grid)
+    void release(Grid&);
+    bool open(const Grid&, int x, int y);           // On the grid and not a wall
+    float octile(int dx, int dy);                   // Cost with no walls in the way
+    bool line_of_sight(const Grid&, int x0, int y0, int x1, int y1); // Straight line, no walls, no corners
+    void alloc(Searcher&, const Grid&);             // Remember to release(searcher)
+    void release(Searcher&);
+    bool astar(Searcher&, const Grid&, const Request&, Result&); // Plain A* (every neighbor)
+    bool jps(Searcher&, const Grid&, const Request&, Result&);   // Jump Point Search
+    bool jump(const Grid&, int x, int y, int dx, int dy, int gx, int gy, int* jx, int* jy);
+    void alloc(Service&, const Grid&, int nsearchers, int max_batch); // Remember to release(service)
+    void release(Service&);
+    void invalidate(Service&);                      // Walls changed: forget the cached paths
+    void find(Service&, Jobs::Pool&, const Request*, int count, Result*); // A batch (count <= max_batch)
+}
+
+void Path::alloc(Grid& g, int w, int h)
+{
+    g.w = w; g.h = h;
+    g.wall = (uint8_t*)calloc(static_cast<size_t>(w)*h, sizeof(uint8_t));
+}
+
+void Path::release(Grid& g)
+{
+    free(g.wall); g.wall = NULL;
+    g.w = 0; g.h = 0;
+}
+
+bool Path::open(const Grid& g, int x, int y)
+{
+    return (x >= 0) && (y >= 0) && (x < g.w) && (y < g.h) && (g.wall[y*g.w + x] == 0);
+}
+
+float Path::octile(int dx, int dy)
+{ // Diagonal steps for the short side, straight steps for the rest
+    dx = std::abs(dx); dy = std::abs(dy);
+    return (dx < dy) ? SQRT2*dx + (dy - dx) : SQRT2*dy + (dx - dy);
+}
+
+bool Path::line_of_sight(const Grid& g, int x0, int y0, int x1, int y1)
+{ // Bresenham from cell to cell. A diagonal step needs both side cells open (it might pass through either).
+    int dx = std::abs(x1 - x0); int dy = std::abs(y1 - y0);
+    const int sx = (x1 > x0) ? 1 : -1; const int sy = (y1 > y0) ? 1 : -1;
+    int err = dx - dy;                              // (Doubled: no halves)
+    int x = x0; int y = y0;
+    if (!open(g, x, y)) return false;
+    for (int k=0; k<dx+dy; k++)
+    {
+        const int e2 = 2*err;
+        if (e2 > -dy && e2 < dx)
+        { // Diagonal step: both side cells must be open
+            if (!open(g, x+sx, y) || !open(g, x, y+sy)) return false;
+            err += -dy + dx; x += sx; y += sy; k++;
+        }
+        else if (e2 > -dy) { err -= dy; x += sx; }
+        else               { err += dx; y += sy; }
+        if (!open(g, x, y)) return false;
+    }
+    return true;
+}
+
+void Path::alloc(Searcher& s, const Grid& g)
+{
+    const size_t n = static_cast<size_t>(g.w)*g.h;
+    const size_t words = (n + 63)/64;
+    s.g = (float*)malloc(sizeof(float)*n); s.parent = (int*)malloc(sizeof(int)*n);
+    s.seen = (uint64_t*)calloc(words, sizeof(uint64_t)); s.closed = (uint64_t*)calloc(words, sizeof(uint64_t));
+    s.touched = (int*)malloc(sizeof(int)*n); s.ntouched = 0;
+    s.heap_capacity = 1<<12; s.nheap = 0;
+    s.heap = (Node*)malloc(sizeof(Node)*s.heap_capacity);
+    s.searches = 0; s.expanded = 0;
+}
+
+void Path::release(Searcher& s)
+{
+    free(s.g); free(s.parent); free(s.seen); free(s.closed); free(s.touched); free(s.heap);
+    s.g = NULL; s.parent = NULL; s.seen = NULL; s.closed = NULL; s.touched = NULL; s.heap = NULL;
+    s.heap_capacity = 0; s.nheap = 0;
+}
+
+namespace Path
+{ // Helpers for one search (not part of the interface)
+    inline bool bit(const uint64_t* bits, int i) { return (bits[i >> 6] >> (i & 63)) & 1; }
+    inline void set_bit(uint64_t* bits, int i) { bits[i >> 6] |= uint64_t{1} << (i & 63); }
+
+    inline void push(Searcher& s, float f, int cell)
+    { // Sift up
+        if (s.nheap == s.heap_capacity)
+        {
+            s.heap_capacity *= 2;
+            s.heap = (Node*)realloc(s.heap, sizeof(Node)*s.heap_capacity);
+        }
+        int i = s.nheap++;
+        while (i > 0)
+        {
+            const int up = (i - 1)/2;
+            if (s.heap[up].f <= f) break;
+            s.heap[i] = s.heap[up]; i = up;
+        }
+        s.heap[i] = Node{f, cell};
+    }
+
+    inline Node pop(Searcher& s)
+    { // Smallest f, then sift the last node down from the top
+        const Node top = s.heap[0];
+        const Node last = s.heap[--s.nheap];
+        int i = 0;
+        for (;;)
+        {
+            int down = 2*i + 1;
+            if (down >= s.nheap) break;
+            if ((down + 1 < s.nheap) && (s.heap[down+1].f < s.heap[down].f)) down++;
+            if (last.f <= s.heap[down].f) break;
+            s.heap[i] = s.heap[down]; i = down;
+        }
+        if (s.nheap > 0) s.heap[i] = last;
+        return top;
+    }
+
+    inline void begin(Searcher& s, const Grid& g, const Request& r)
+    {
+        const int start = r.sy*g.w + r.sx;
+        s.nheap = 0;
+        s.g[start] = 0; s.parent[start] = -1;
+        set_bit(s.seen, start); s.touched[s.ntouched++] = start;
+        push(s, octile(r.gx - r.sx, r.gy - r.sy), start);
+        s.searches++;
+    }
+
+    inline void relax(Searcher& s, const Grid& g, const Request& r, int from, int to, float cost)
+    { // A cheaper way to reach to: remember it and (re)push it (an old copy in the heap is skipped when popped)
+        const float gt = s.g[from] + cost;
+        if (bit(s.closed, to)) return;
+        if (bit(s.seen, to) && (s.g[to] <= gt)) return;
+        if (!bit(s.seen, to)) { set_bit(s.seen, to); s.touched[s.ntouched++] = to; }
+        s.g[to] = gt; s.parent[to] = from;
+        push(s, gt + octile(r.gx - to%g.w, r.gy - to/g.w), to);
+    }
+
+    inline bool finish(Searcher& s, const Grid& g, int goal, bool found, Result& out)
+    { // Walk the parents back from the goal, then clear the bits this search set
+        out.n = 0; out.length = 0; out.cached = false;
+        if (found)
+        { // Keep the turns only (A* steps one cell at a time: a straight run is its two ends)
+            int n = 0; int ddx = 0; int ddy = 0;
+            for (int c=goal; c>=0; c=s.parent[c])
+            {
+                const SDL_Point p = {.x=c%g.w, .y=c/g.w};
+                if (n >= 2)
+                {
+                    const int dx = p.x - out.points[n-1].x; const int dy = p.y - out.points[n-1].y;
+                    const int ex = (dx > 0) - (dx < 0); const int ey = (dy > 0) - (dy < 0);
+                    if ((ex == ddx) && (ey == ddy)) { out.points[n-1] = p; continue; } // Same way: move the end
+                }
+                if (n == MAX_POINTS) { n = 0; break; }  // (Too many turns: no path)
+                if (n >= 1)
+                {
+                    const int dx = p.x - out.points[n-1].x; const int dy = p.y - out.points[n-1].y;
+                    ddx = (dx > 0) - (dx < 0); ddy = (dy > 0) - (dy < 0);
+                }
+                out.points[n++] = p;
+            }
+            std::reverse(out.points, out.points + n);   // (Walked goal to start)
+            out.n = n; out.length = (n > 0) ? s.g[goal] : 0;
+        }
+        for (int k=0; k<s.ntouched; k++)
+        {
+            const int c = s.touched[k];
+            s.seen[c >> 6] = 0; s.closed[c >> 6] = 0;   // (Whole words: touched cells cover every set bit)
+        }
+        s.ntouched = 0;
+        return out.n > 0;
+    }
+}
+
+bool Path::astar(Searcher& s, const Grid& g, const Request& r, Result& out)
+{ // Every open neighbor goes in the heap (no cutting wall corners)
+    if (!open(g, r.sx, r.sy) || !open(g, r.gx, r.gy)) { out.n = 0; return false; }
+    const int goal = r.gy*g.w + r.gx;
+    begin(s, g, r);
+    bool found = false;
+    while (s.nheap > 0)
+    {
+        const Node top = pop(s);
+        if (bit(s.closed, top.cell)) continue;     // (Stale copy: it was reached cheaper)
+        set_bit(s.closed, top.cell);
+        if (top.cell == goal) { found = true; break; }
+        s.expanded++;
+        const int x = top.cell%g.w; const int y = top.cell/g.w;
+        for (int dy=-1; dy<=1; dy++)
+        {
+            for (int dx=-1; dx<=1; dx++)
+            {
+                if ((dx == 0) && (dy == 0)) continue;
+                if (!open(g, x+dx, y+dy)) continue;
+                if ((dx != 0) && (dy != 0) && (!open(g, x+dx, y) || !open(g, x, y+dy))) continue;
+                relax(s, g, r, top.cell, (y+dy)*g.w + (x+dx), ((dx != 0) && (dy != 0)) ? SQRT2 : 1.0f);
+            }
+        }
+    }
+    return finish(s, g, goal, found, out);
+}
+
+bool Path::jump(const Grid& g, int x, int y, int dx, int dy, int gx, int gy, int* jx, int* jy)
+{ // Run from (x,y) in direction (dx,dy) to the next jump point. false : hit a wall first.
+    /* *************DOC***************
+     * Straight: stop where a wall beside the run ends (a path around that
+     * corner starts here). Diagonal: stop where a straight run from here
+     * would find a jump point. Either: stop at the goal.
+     * *******************************/
+    for (;;)
+    {
+        x += dx; y += dy;
+        if (!open(g, x, y)) return false;
+        if ((x == gx) && (y == gy)) break;
+        if ((dx != 0) && (dy != 0))
+        {
+            int ix, iy;
+            if (jump(g, x, y, dx, 0, gx, gy, &ix, &iy) || jump(g, x, y, 0, dy, gx, gy, &ix, &iy)) break;
+            if (!open(g, x+dx, y) || !open(g, x, y+dy)) return false;   // (Can't cut the corner)
+        }
+        else if (dx != 0)
+        {
+            if ((open(g, x, y-1) && !open(g, x-dx, y-1)) || (open(g, x, y+1) && !open(g, x-dx, y+1))) break;
+        }
+        else
+        {
+            if ((open(g, x-1, y) && !open(g, x-1, y-dy)) || (open(g, x+1, y) && !open(g, x+1, y-dy))) break;
+        }
+    }
+    *jx = x; *jy = y;
+    return true;
+}
+
+bool Path::jps(Searcher& s, const Grid& g, const Request& r, Result& out)
+{ // A*, but the neighbors are pruned by the direction we came from, and each one jumps
+    if (!open(g, r.sx, r.sy) || !open(g, r.gx, r.gy)) { out.n = 0; return false; }
+    const int goal = r.gy*g.w + r.gx;
+    begin(s, g, r);
+    bool found = false;
+    while (s.nheap > 0)
+    {
+        const Node top = pop(s);
+        if (bit(s.closed, top.cell)) continue;
+        set_bit(s.closed, top.cell);
+        if (top.cell == goal) { found = true; break; }
+        s.expanded++;
+        const int x = top.cell%g.w; const int y = top.cell/g.w;
+        int dirs[8][2]; int ndirs = 0;              // Directions worth jumping in
+        auto add = [&](int dx, int dy) { dirs[ndirs][0] = dx; dirs[ndirs][1] = dy; ndirs++; };
+        const int p = s.parent[top.cell];
+        if (p < 0)
+        { // Start: every way
+            for (int dy=-1; dy<=1; dy++) for (int dx=-1; dx<=1; dx++) if ((dx != 0) || (dy != 0)) add(dx, dy);
+        }
+        else
+        { // Keep going the way we came, plus the ways a wall corner forces
+            const int dx = (x > p%g.w) - (x < p%g.w); const int dy = (y > p/g.w) - (y < p/g.w);
+            if ((dx != 0) && (dy != 0))
+            {
+                add(0, dy); add(dx, 0); add(dx, dy);
+            }
+            else if (dx != 0)
+            {
+                add(dx, 0); add(dx, 1); add(dx, -1); add(0, 1); add(0, -1);
+            }
+            else
+            {
+                add(0, dy); add(1, dy); add(-1, dy); add(1, 0); add(-1, 0);
+            }
+        }
+        for (int k=0; k<ndirs; k++)
+        {
+            const int dx = dirs[k][0]; const int dy = dirs[k][1];
+            if (!open(g, x+dx, y+dy)) continue;
+            if ((dx != 0) && (dy != 0) && (!open(g, x+dx, y) || !open(g, x, y+dy))) continue;
+            int jx, jy;
+            if (!jump(g, x, y, dx, dy, r.gx, r.gy, &jx, &jy)) continue;
+            relax(s, g, r, top.cell, jy*g.w + jx, octile(jx - x, jy - y));
+        }
+    }
+    return finish(s, g, goal, found, out);
+}
+
+void Path::alloc(Service& sv, const Grid& g, int nsearchers, int max_batch)
+{
+    sv.grid = &g;
+    sv.nsearchers = nsearchers;
+    sv.searchers = (Searcher*)malloc(sizeof(Searcher)*nsearchers);
+    for (int i=0; i<nsearchers; i++) alloc(sv.searchers[i], g);
+    sv.keys = (long*)malloc(sizeof(long)*CACHE); sv.counts = (int*)malloc(sizeof(int)*CACHE);
+    sv.lengths = (float*)malloc(sizeof(float)*CACHE);
+    sv.points = (SDL_Point*)malloc(sizeof(SDL_Point)*CACHE*MAX_POINTS);
+    sv.max_batch = max_batch;
+    sv.todo = (int*)malloc(sizeof(int)*max_batch); sv.ntodo = 0;
+    sv.leader = (int*)malloc(sizeof(int)*max_batch);
+    sv.requests = 0; sv.hits = 0; sv.searched = 0;
+    invalidate(sv);
+}
+
+void Path::release(Service& sv)
+{
+    for (int i=0; i<sv.nsearchers; i++) release(sv.searchers[i]);
+    free(sv.searchers); free(sv.keys); free(sv.counts); free(sv.lengths); free(sv.points);
+    free(sv.todo); free(sv.leader);
+    sv.searchers = NULL; sv.keys = NULL; sv.counts = NULL; sv.lengths = NULL; sv.points = NULL;
+    sv.todo = NULL; sv.leader = NULL;
+    sv.nsearchers = 0; sv.max_batch = 0;
+}
+
+void Path::invalidate(Service& sv)
+{
+    for (int i=0; i<CACHE; i++) sv.keys[i] = -1;
+}
+
+namespace Path
+{ // Cache helpers (not part of the interface)
+    inline long key(const Grid& g, const Request& r)
+    { // (Start chunk, goal cell)
+        const long chunks_across = (g.w + CHUNK-1)/CHUNK;
+        const long chunk = (r.sy/CHUNK)*chunks_across + r.sx/CHUNK;
+        return chunk*static_cast<long>(g.w)*g.h + static_cast<long>(r.gy)*g.w + r.gx;
+    }
+
+    inline int slot(long key)
+    { // (Mix the bits: neighboring keys land in different slots)
+        uint64_t k = static_cast<uint64_t>(key)*0x9E3779B97F4A7C15ull;
+        return static_cast<int>(k >> 40) % CACHE;
+    }
+
+    inline bool reuse(const Grid& g, const Request& r, const SDL_Point* path, int n, float length, Result& out)
+    { // Walk straight to the start of a path that goes to the same goal, then follow it
+        if (n == 0) return false;
+        const bool there = (path[0].x == r.sx) && (path[0].y == r.sy);
+        if (n + !there > MAX_POINTS) return false;
+        if (!there && !line_of_sight(g, r.sx, r.sy, path[0].x, path[0].y)) return false;
+        out.n = 0;
+        if (!there) out.points[out.n++] = SDL_Point{.x=r.sx, .y=r.sy};
+        memcpy(&out.points[out.n], path, sizeof(SDL_Point)*n);
+        out.n += n;
+        out.length = length + (there ? 0 : std::sqrt(static_cast<float>(
+                        (r.sx-path[0].x)*(r.sx-path[0].x) + (r.sy-path[0].y)*(r.sy-path[0].y))));
+        out.cached = true;
+        return true;
+    }
+
+    inline void search_todo(Service& sv, Jobs::Pool& pool, const Request* req, Result* out)
+    { // Each thread takes a Searcher, then takes requests until there are none left
+        std::atomic<int> next{0};
+        const int ntodo = sv.ntodo;
+        Jobs::parallel_for(pool, sv.nsearchers, 1, [&](int begin, int end)
+        {
+            for (int w=begin; w<end; w++)
+            {
+                for (int k=next++; k<ntodo; k=next++) jps(sv.searchers[w], *sv.grid, req[sv.todo[k]], out[sv.todo[k]]);
+            }
+        });
+        sv.searched += ntodo;
+    }
+}
+
+void Path::find(Service& sv, Jobs::Pool& pool, const Request* req, int count, Result* out)
+{ // Cache, then search the misses on every thread, then cache what was found (see top of namespace)
+    assert(count <= sv.max_batch);
+    const Grid& g = *sv.grid;
+    sv.requests += count;
+    sv.ntodo = 0;
+    for (int i=0; i<count; i++)
+    {
+        out[i].n = 0; out[i].cached = false;
+        sv.leader[i] = -1;
+        const long k = key(g, req[i]);
+        const int s = slot(k);
+        if ((sv.keys[s] == k) && reuse(g, req[i], &sv.points[s*MAX_POINTS], sv.counts[s], sv.lengths[s], out[i]))
+        {
+            sv.hits++; continue;
+        }
+        for (int t=0; t<sv.ntodo; t++)
+        { // Same key as a request already going to be searched: wait for its path (batches are small)
+            if (key(g, req[sv.todo[t]]) == k) { sv.leader[i] = sv.todo[t]; break; }
+        }
+        if (sv.leader[i] < 0) sv.todo[sv.ntodo++] = i;
+    }
+    search_todo(sv, pool, req, out);
+    for (int t=0; t<sv.ntodo; t++)
+    { // New paths go in the cache
+        const int i = sv.todo[t];
+        if (out[i].n == 0) continue;
+        const int s = slot(key(g, req[i]));
+        sv.keys[s] = key(g, req[i]); sv.counts[s] = out[i].n; sv.lengths[s] = out[i].length;
+        memcpy(&sv.points[s*MAX_POINTS], out[i].points, sizeof(SDL_Point)*out[i].n);
+    }
+    // The ones that waited: follow their leader's path, or search after all (can't see its start)
+    int again = 0;
+    for (int i=0; i<count; i++)
+    {
+        const int l = sv.leader[i];
+        if (l < 0) continue;
+        if (reuse(g, req[i], out[l].points, out[l].n, out[l].length, out[i])) sv.hits++;
+        else sv.todo[again++] = i;
+    }
+    sv.ntodo = again;
+    search_todo(sv, pool, req, out);
+}
+
+#endif // __MG_PATH_H__
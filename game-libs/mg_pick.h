@@ -0,0 +1,225 @@
+#ifndef __MG_PICK_H__
+#define __MG_PICK_H__
+
+#include <cmath>
+
+namespace Pick
+{ // Find what is under the mouse: the nearest point, the nearest quadratic dCB curve
+    /* *************How to find the nearest point on a dCB curve***************
+     * Write the quadratic dCB curve as a polynomial in λ:
+     *
+     *      curve(λ) = P0 + 2λ*(P1-P0) + λ^2*(P0-2*P1+P2)
+     *               = P0 + 2λ*b        + λ^2*a
+     *
+     * The nearest point on the curve to the mouse p is where the vector from p
+     * to the curve is perpendicular to the tangent:
+     *
+     *      (curve(λ) - p) . curve'(λ) = 0
+     *
+     * Multiply it out (m = P0-p) and that's a cubic in λ:
+     *
+     *      a.a λ^3 + 3 a.b λ^2 + (2 b.b + m.a) λ + m.b = 0
+     *
+     * A cubic has a closed-form solution (Cardano), so there is no searching
+     * along the curve. The nearest point is one of the real roots in [0:1] or
+     * one of the two ends of the curve: try them all, keep the closest.
+     *
+     * With lots of curves, most are nowhere near the mouse. Cull them first
+     * with their bounding boxes, then only solve the cubic for the curves that
+     * are left. Control points and bounding boxes are structure-of-arrays, so
+     * the cull and the nearest-control-point search are plain loops over
+     * contiguous floats with no branches.
+     * *******************************/
+    struct Hit
+    {
+        int index;                          // Which curve or point, -1 : nothing within reach
+        float lambda;                       // Where on the curve (0 for points)
+        float d2;                           // Quadrance (distance squared) from the query point
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    int solve_cubic(float a, float b, float c, float d, float* roots); // Real roots, return how many
+    float nearest_lambda(SDL_FPoint P0, SDL_FPoint P1, SDL_FPoint P2, SDL_FPoint p, float* d2);
+    Hit nearest_point(const float* x, const float* y, int count, SDL_FPoint p); // Over SoA points
+    int cull(const SDL_FRect* boxes, int count, SDL_FPoint p, float reach, int* out); // Boxes near p
+    Hit nearest_curve(const float* const* x, const float* const* y, const SDL_FRect* boxes,
+            int count, SDL_FPoint p, float reach, int* scratch); // Cull, then solve the cubics
+}
+
+int Pick::solve_cubic(float a, float b, float c, float d, float* roots)
+{ // Real roots of a*x^3 + b*x^2 + c*x + d = 0
+    /* *************DOC***************
+     * Cardano: divide by a, then shift x = u - b/(3a) to get rid of the x^2 term:
+     *
+     *      u^3 + p*u + q = 0
+     *
+     * disc = (q/2)^2 + (p/3)^3 says how many real roots:
+     *      disc > 0  : one real root, u = cbrt(-q/2 + sqrt(disc)) + cbrt(-q/2 - sqrt(disc))
+     *      disc <= 0 : three real roots, u = 2*sqrt(-p/3)*cos((θ - 2πk)/3), k=0,1,2
+     *                  where cos(θ) = (-q/2)/sqrt(-p/3)^3
+     *
+     * If a is tiny compared to the other coefficients the cubic is really a
+     * quadratic (or a line), so solve that instead of dividing by almost zero.
+     *
+     * roots : room for 3 floats
+     * Return : number of real roots written to roots
+     * *******************************/
+    const float big = std::fmax(std::fabs(b), std::fmax(std::fabs(c), std::fabs(d)));
+    constexpr float EPS = 1e-6f;
+    if (std::fabs(a) <= EPS*big)
+    { // Quadratic: b*x^2 + c*x + d = 0
+        if (std::fabs(b) <= EPS*std::fmax(std::fabs(c), std::fabs(d)))
+        { // Line: c*x + d = 0
+            if (c == 0) return 0;
+            roots[0] = -d/c;
+            return 1;
+        }
+        float disc = c*c - 4*b*d;
+        if (disc < 0) return 0;
+        float s = std::sqrt(disc);
+        // Avoid subtracting nearly equal numbers: get the big root first, then x0*x1 = d/b
+        float k = -0.5f*(c + std::copysign(s, c));
+        roots[0] = k/b;
+        if (k == 0) return 1;
+        roots[1] = d/k;
+        return 2;
+    }
+    const float B = b/a; const float C = c/a; const float D = d/a;
+    const float offset = -B/3;                      // x = u + offset
+    const float p = C - B*B/3;
+    const float q = 2*B*B*B/27 - B*C/3 + D;
+    const float disc = 0.25f*q*q + p*p*p/27;
+    if (disc > 0)
+    { // One real root
+        float s = std::sqrt(disc);
+        roots[0] = std::cbrt(-0.5f*q + s) + std::cbrt(-0.5f*q - s) + offset;
+        return 1;
+    }
+    if (p >= 0)
+    { // disc <= 0 and p >= 0 : p == q == 0, a triple root
+        roots[0] = offset;
+        return 1;
+    }
+    // Three real roots (some may be repeated)
+    constexpr float TWO_PI = 6.28318530718f;
+    const float r = std::sqrt(-p/3);
+    float cos_theta = (-0.5f*q)/(r*r*r);
+    cos_theta = std::fmin(std::fmax(cos_theta, -1.0f), 1.0f);   // Round-off can push it past 1
+    const float theta = std::acos(cos_theta);
+    for (int k=0; k<3; k++)
+    {
+        roots[k] = 2*r*std::cos((theta - TWO_PI*k)/3) + offset;
+    }
+    return 3;
+}
+
+float Pick::nearest_lambda(SDL_FPoint P0, SDL_FPoint P1, SDL_FPoint P2, SDL_FPoint p, float* d2)
+{ // λ of the point on the quadratic dCB curve P0,P1,P2 nearest to p
+    /* *************DOC***************
+     * Parameters
+     * ----------
+     * P0,P1,P2 : control points of the quadratic dCB curve
+     * p : the query point (the mouse)
+     * d2 : float*
+     *      set to the quadrance from p to the nearest point
+     *
+     * Return
+     * ------
+     * λ in [0:1] of the nearest point on the curve
+     * *******************************/
+    const float ax = P0.x - 2*P1.x + P2.x; const float ay = P0.y - 2*P1.y + P2.y;
+    const float bx = P1.x - P0.x;          const float by = P1.y - P0.y;
+    const float mx = P0.x - p.x;           const float my = P0.y - p.y;
+    // Cubic coefficients (see "How to find the nearest point on a dCB curve")
+    const float c3 = ax*ax + ay*ay;
+    const float c2 = 3*(ax*bx + ay*by);
+    const float c1 = 2*(bx*bx + by*by) + (mx*ax + my*ay);
+    const float c0 = mx*bx + my*by;
+    // Candidates: both ends and the roots of the cubic
+    float lambdas[5] = {0, 1};
+    int n = 2 + solve_cubic(c3, c2, c1, c0, &lambdas[2]);
+    float best_l = 0; float best_d2 = INFINITY;
+    for (int i=0; i<n; i++)
+    {
+        float l = lambdas[i];
+        if (i >= 2)
+        { // Polish the root with one Newton step (float Cardano loses a few bits)
+            float g  = ((c3*l + c2)*l + c1)*l + c0;
+            float dg = (3*c3*l + 2*c2)*l + c1;
+            if (dg != 0) l -= g/dg;
+        }
+        l = std::fmin(std::fmax(l, 0.0f), 1.0f);    // Stay on the curve
+        float ex = mx + (2*bx + ax*l)*l;            // curve(λ) - p
+        float ey = my + (2*by + ay*l)*l;
+        float e2 = ex*ex + ey*ey;
+        if (e2 < best_d2) { best_d2 = e2; best_l = l; }
+    }
+    *d2 = best_d2;
+    return best_l;
+}
+
+Pick::Hit Pick::nearest_point(const float* x, const float* y, int count, SDL_FPoint p)
+{ // Nearest of count points (x[i],y[i]) to p
+    Hit hit = {.index=-1, .lambda=0, .d2=INFINITY};
+    for (int i=0; i<count; i++)
+    {
+        float dx = x[i] - p.x; float dy = y[i] - p.y;
+        float d2 = dx*dx + dy*dy;
+        bool closer = d2 < hit.d2;
+        hit.d2 = closer ? d2 : hit.d2;              // Select, don't branch
+        hit.index = closer ? i : hit.index;
+    }
+    return hit;
+}
+
+int Pick::cull(const SDL_FRect* boxes, int count, SDL_FPoint p, float reach, int* out)
+{ // Write the index of every box within reach of p to out, return how many
+    // Same trick as Polyline::snap_unique: always write, only move n forward on a hit
+    int n = 0;
+    for (int i=0; i<count; i++)
+    {
+        const SDL_FRect& b = boxes[i];
+        bool near = (p.x >= b.x - reach) & (p.x <= b.x + b.w + reach) &
+                    (p.y >= b.y - reach) & (p.y <= b.y + b.h + reach);
+        out[n] = i;
+        n += static_cast<int>(near);
+    }
+    return n;
+}
+
+Pick::Hit Pick::nearest_curve(const float* const* x, const float* const* y, const SDL_FRect* boxes,
+        int count, SDL_FPoint p, float reach, int* scratch)
+{ // Nearest quadratic dCB curve to p, if any is within reach
+    /* *************DOC***************
+     * Parameters
+     * ----------
+     * x, y : 3 arrays each, structure-of-arrays control points
+     *      x[j][i] is the x of control point j of curve i
+     * boxes : bounding box of each curve
+     * count : number of curves
+     * p : the query point (the mouse)
+     * reach : only report a curve closer than this
+     * scratch : room for count ints
+     *
+     * Return
+     * ------
+     * Hit with the curve index (-1 if none within reach), λ, and quadrance
+     * *******************************/
+    Hit hit = {.index=-1, .lambda=0, .d2=reach*reach};
+    int ncand = cull(boxes, count, p, reach, scratch);
+    for (int k=0; k<ncand; k++)
+    {
+        int i = scratch[k];
+        float d2;
+        float l = nearest_lambda(
+                SDL_FPoint{x[0][i], y[0][i]},
+                SDL_FPoint{x[1][i], y[1][i]},
+                SDL_FPoint{x[2][i], y[2][i]}, p, &d2);
+        if (d2 <= hit.d2) hit = Hit{.index=i, .lambda=l, .d2=d2};
+    }
+    return hit;
+}
+
+#endif // __MG_PICK_H__
@@ -0,0 +1,150 @@
+#ifndef __MG_PIXFMT_H__
+#define __MG_PIXFMT_H__
+
+#include <algorithm>
+#include <cstdio>
+
+namespace PixFmt
+{ // Use the 32-bit pixel format the renderer and window already use: no pixel gets converted
+    /* *************Why negotiate a pixel format***************
+     * A texture in a format the renderer does not list in
+     * SDL_GetRendererInfo() is really kept in some other format, and SDL
+     * converts every pixel on every SDL_UpdateTexture. With the software
+     * renderer, every SDL_RenderCopy also converts every pixel if the texture
+     * is not laid out like the window surface. A 1280x720 copy is ~1M
+     * pixels: a shift-and-mask per channel per pixel, every frame.
+     *
+     * Many renderers and window surfaces use ARGB8888 (or XRGB8888, which is
+     * ARGB8888 with the alpha byte ignored), not the RGBA8888 that was
+     * hard-coded before. So at startup, negotiate():
+     *
+     *      - the window format, with an alpha byte (XRGB8888 -> ARGB8888), if
+     *        the renderer lists it: then both uploads and copies are plain
+     *      - else the renderer's first listed format that has a Packing
+     *      - else ARGB8888 (SDL's default) and count the conversions
+     *
+     * Anything I pack myself (the stroke rasterizer) picks its Packing at
+     * COMPILE time: a template per format, so the shifts are constants, and
+     * one switch on the negotiated format picks the template. Colors that
+     * SDL packs (SDL_SetRenderDrawColor) are already packed in the native
+     * format by the renderer.
+     * *******************************/
+    template<Uint32 FORMAT> struct Packing;         // Bit position of each channel in a Uint32
+    template<> struct Packing<SDL_PIXELFORMAT_RGBA8888> { static constexpr int R=24, G=16, B= 8, A= 0; };
+    template<> struct Packing<SDL_PIXELFORMAT_ARGB8888> { static constexpr int R=16, G= 8, B= 0, A=24; };
+    template<> struct Packing<SDL_PIXELFORMAT_ABGR8888> { static constexpr int R= 0, G= 8, B=16, A=24; };
+    template<> struct Packing<SDL_PIXELFORMAT_BGRA8888> { static constexpr int R= 8, G=16, B=24, A= 0; };
+
+    constexpr int MAX_LISTED = 16;                  // (SDL_RendererInfo has room for 16)
+
+    struct Native
+    {
+        Uint32 format;                      // Negotiated: make textures and canvases in this format
+        Uint32 window;                      // Window (or CPU_PRESENT surface) format
+        Uint32 listed[MAX_LISTED];          // Formats the renderer takes without converting
+        int nlisted;
+        bool software;                      // Software renderer: copies convert too
+        long uploads, converted_uploads;    // SDL_UpdateTexture calls, and how many converted
+        long copies, converted_copies;      // SDL_RenderCopy calls, and how many converted
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    template<Uint32 FORMAT> Uint32 pack(Uint32 r, Uint32 g, Uint32 b, Uint32 a); // Channels are 0-255
+    template<Uint32 FORMAT> Uint32 alpha(Uint32 pixel);
+    bool packable(Uint32 format);                   // There is a Packing<format>
+    Uint32 with_alpha(Uint32 format);               // XRGB8888 -> ARGB8888, etc.
+    Native negotiate(SDL_Renderer*, Uint32 window_format);
+    bool listed(const Native&, Uint32 format);
+    bool upload(Native&, Uint32 format);            // Count an SDL_UpdateTexture, true : it converts
+    bool copy(Native&, Uint32 format);              // Count an SDL_RenderCopy, true : it converts
+    void print(const Native&, long frames);         // Formats, and conversions per frame
+}
+
+template<Uint32 FORMAT> Uint32 PixFmt::pack(Uint32 r, Uint32 g, Uint32 b, Uint32 a)
+{
+    using P = Packing<FORMAT>;
+    return (r << P::R) | (g << P::G) | (b << P::B) | (a << P::A);
+}
+
+template<Uint32 FORMAT> Uint32 PixFmt::alpha(Uint32 pixel)
+{
+    return (pixel >> Packing<FORMAT>::A) & 0xFF;
+}
+
+bool PixFmt::packable(Uint32 format)
+{
+    return (format == SDL_PIXELFORMAT_RGBA8888) || (format == SDL_PIXELFORMAT_ARGB8888) ||
+           (format == SDL_PIXELFORMAT_ABGR8888) || (format == SDL_PIXELFORMAT_BGRA8888);
+}
+
+Uint32 PixFmt::with_alpha(Uint32 format)
+{ // Same layout, the unused byte is alpha
+    switch (format)
+    {
+        case SDL_PIXELFORMAT_RGB888:   return SDL_PIXELFORMAT_ARGB8888;   // (a.k.a. XRGB8888)
+        case SDL_PIXELFORMAT_BGR888:   return SDL_PIXELFORMAT_ABGR8888;   // (a.k.a. XBGR8888)
+        case SDL_PIXELFORMAT_RGBX8888: return SDL_PIXELFORMAT_RGBA8888;
+        case SDL_PIXELFORMAT_BGRX8888: return SDL_PIXELFORMAT_BGRA8888;
+        default:                       return format;
+    }
+}
+
+PixFmt::Native PixFmt::negotiate(SDL_Renderer* ren, Uint32 window_format)
+{ // Ask the renderer what it takes, pick the format (see top of namespace)
+    Native n{};
+    n.window = window_format;
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(ren, &info) == 0)
+    {
+        n.nlisted = std::min(static_cast<int>(info.num_texture_formats), MAX_LISTED);
+        for (int i=0; i<n.nlisted; i++) n.listed[i] = info.texture_formats[i];
+        n.software = (info.flags & SDL_RENDERER_SOFTWARE) != 0;
+    }
+    const Uint32 win = with_alpha(window_format);
+    n.format = SDL_PIXELFORMAT_ARGB8888;
+    if (packable(win) && listed(n, win)) n.format = win;
+    else
+    {
+        for (int i=n.nlisted-1; i>=0; i--)          // (Backwards: first listed wins)
+        {
+            if (packable(n.listed[i])) n.format = n.listed[i];
+        }
+    }
+    return n;
+}
+
+bool PixFmt::listed(const Native& n, Uint32 format)
+{
+    for (int i=0; i<n.nlisted; i++) if (n.listed[i] == format) return true;
+    return false;
+}
+
+bool PixFmt::upload(Native& n, Uint32 format)
+{ // A format the renderer doesn't list is stored as one it does: SDL converts the pixels
+    const bool converts = !listed(n, format);
+    n.uploads++; n.converted_uploads += converts;
+    return converts;
+}
+
+bool PixFmt::copy(Native& n, Uint32 format)
+{ // GPU: the GPU samples any format it listed. Software: a blit, converts unless laid out like the window.
+    const bool converts = n.software ? (with_alpha(format) != with_alpha(n.window)) : !listed(n, format);
+    n.copies++; n.converted_copies += converts;
+    return converts;
+}
+
+void PixFmt::print(const Native& n, long frames)
+{
+    printf("pixel format             : %s (window %s, %s renderer)\n",
+            SDL_GetPixelFormatName(n.format), SDL_GetPixelFormatName(n.window), n.software ? "software" : "GPU");
+    if (frames > 0)
+    {
+        printf("pixel conversions        : %.2f per frame (uploads %ld of %ld, copies %ld of %ld)\n",
+                static_cast<double>(n.converted_uploads + n.converted_copies)/frames,
+                n.converted_uploads, n.uploads, n.converted_copies, n.copies);
+    }
+}
+
+#endif // __MG_PIXFMT_H__
@@ -0,0 +1,153 @@
+#ifndef __MG_POLYLINE_H__
+#define __MG_POLYLINE_H__
+
+#include <cassert>
+#include <cmath>
+
+namespace Polyline
+{ // Clean up lists of points before handing them to SDL_RenderDrawLinesF
+    /* *************Why simplify polylines***************
+     * A dCB curve is K=128 points, so SDL_RenderDrawLinesF gets 127 line
+     * segments. But game art pixels are chunky. Where the curve is flat, lots of
+     * those points sit on the same straight line (to within a pixel), and SDL
+     * draws 127 tiny line segments where one long one looks the same.
+     *
+     * Ramer-Douglas-Peucker (RDP) throws away the points that are within a
+     * tolerance of the straight line between the points that are kept:
+     *
+     *      - keep the first and last point
+     *      - find the point farthest from the JOIN of first and last
+     *      - if it is within tolerance, drop everything in between
+     *      - otherwise keep it and do the same thing on both halves
+     *
+     * The usual way to write "both halves" is recursion. I use a little stack of
+     * [first,last] index pairs instead, and both the stack and the "keep" flags
+     * live on the call stack, so there is no malloc.
+     * *******************************/
+    constexpr int MAX_POINTS = 1<<10;               // Longest polyline rdp() handles
+
+    /* *************Why snap points to pixels***************
+     * At GameArt::scale=10 the game art is 160x90. A small spinner or a short
+     * dCB curve covers just a few chunky pixels, but I still hand SDL all of its
+     * points, so the same pixel gets drawn over and over.
+     *
+     * Snap each point to the integer pixel it lands in, and only keep a point if
+     * it lands in a different pixel than the point before it. Curves and circles
+     * are traced in order, so repeats are always neighbors.
+     * *******************************/
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    int rdp(SDL_FPoint* points, int count, float tol); // Simplify in place, return new count
+    SDL_Point snap(SDL_FPoint p);                   // The GameArt pixel that p lands in
+    int snap_unique(const SDL_FPoint* in, int count, SDL_Point* out); // Snap, drop repeats
+}
+
+int Polyline::rdp(SDL_FPoint* points, int count, float tol)
+{ // Ramer-Douglas-Peucker, iterative and allocation-free
+    /* *************DOC***************
+     * Remove points that are within tol of the polyline through the kept points.
+     * The kept points are packed to the front of the array (order unchanged).
+     *
+     * Works for closed shapes too (first point == last point, like the Blob).
+     *
+     * Parameters
+     * ----------
+     * points : SDL_FPoint array, simplified in place
+     * count : int
+     *      number of points in, at most MAX_POINTS
+     * tol : float
+     *      tolerance in GameArt pixels (0.5 : within half a chunky pixel)
+     *
+     * Return
+     * ------
+     * number of points kept
+     * *******************************/
+    if (count <= 2) return count;
+    assert(count <= MAX_POINTS);
+    bool keep[MAX_POINTS];                          // keep[i] : point i survives
+    for (int i=0; i<count; i++) keep[i] = false;
+    keep[0] = true; keep[count-1] = true;
+    int stack[2*MAX_POINTS];                        // Pairs: first, last
+    int top = 0;
+    stack[top++] = 0; stack[top++] = count-1;
+    const float tol2 = tol*tol;
+    while (top > 0)
+    {
+        int last = stack[--top]; int first = stack[--top];
+        SDL_FPoint a = points[first]; SDL_FPoint b = points[last];
+        float dx = b.x - a.x; float dy = b.y - a.y;
+        float len2 = dx*dx + dy*dy;                 // Quadrance of JOIN(a,b)
+        // Find the point farthest from JOIN(a,b).
+        // Compare quadrances scaled by len2 to skip the divide and the sqrt:
+        //      distance^2 * len2 = cross^2
+        float far2 = 0; int far = -1;
+        for (int i=first+1; i<last; i++)
+        {
+            float px = points[i].x - a.x; float py = points[i].y - a.y;
+            float d2 = (len2 > 0) ?
+                (px*dy - py*dx)*(px*dy - py*dx) :   // cross^2 (distance^2 * len2)
+                (px*px + py*py);                    // a==b : distance to the point a
+            if (d2 > far2) { far2 = d2; far = i; }
+        }
+        float limit = (len2 > 0) ? tol2*len2 : tol2;
+        if ((far >= 0) && (far2 > limit))
+        { // Keep the farthest point and simplify both halves
+            keep[far] = true;
+            stack[top++] = first; stack[top++] = far;
+            stack[top++] = far;   stack[top++] = last;
+        }
+    }
+    // Pack the kept points to the front
+    int n = 0;
+    for (int i=0; i<count; i++)
+    {
+        if (keep[i]) points[n++] = points[i];
+    }
+    return n;
+}
+
+SDL_Point Polyline::snap(SDL_FPoint p)
+{ // Pixel [i,j] covers x in [i:i+1), y in [j:j+1)
+    return SDL_Point{
+        .x=static_cast<int>(std::floor(p.x)),
+        .y=static_cast<int>(std::floor(p.y))
+    };
+}
+
+int Polyline::snap_unique(const SDL_FPoint* in, int count, SDL_Point* out)
+{ // Snap points to pixels and drop consecutive repeats
+    /* *************DOC***************
+     * Write the pixel of each point to out, skipping a pixel if it is the same
+     * as the previous one. Draw the result with SDL_RenderDrawPoints.
+     *
+     * No if-statement in the loop: ALWAYS write the pixel to out[n], then only
+     * move n forward if the pixel is new. A repeat just gets written over by the
+     * next pixel. So there is nothing for the CPU to mispredict.
+     *
+     * Parameters
+     * ----------
+     * in : SDL_FPoint array
+     * count : int
+     *      number of points in
+     * out : SDL_Point array
+     *      room for count points
+     *
+     * Return
+     * ------
+     * number of unique pixels written to out
+     * *******************************/
+    if (count <= 0) return 0;
+    out[0] = snap(in[0]);
+    int n = 1;
+    for (int i=1; i<count; i++)
+    {
+        SDL_Point p = snap(in[i]);
+        out[n] = p;
+        n += static_cast<int>((p.x != out[n-1].x) | (p.y != out[n-1].y));
+    }
+    return n;
+}
+
+#endif // __MG_POLYLINE_H__
@@ -0,0 +1,160 @@
+#ifndef __MG_PRESENT_H__
+#define __MG_PRESENT_H__
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+namespace Present
+{ // Put the game art in the OS window on the CPU: integer upscale, no SDL_RenderCopy
+    /* *************Why a CPU presenter***************
+     * Without a GPU, SDL's renderer is software. Then every frame the OS
+     * WINDOW section clears the whole window (every pixel, bars and all), and
+     * SDL_RenderCopy does a generic scaled blit: for every window pixel, work
+     * out which game art pixel it came from.
+     *
+     * But the game art is always scaled by a whole number K (see
+     * scale_src_to_win). Every game art pixel is a KxK block:
+     *
+     *      - a row of game art becomes ONE window row: each pixel written K
+     *        times in a row (a loop specialized for each K, so it is just
+     *        K stores per pixel, no divides)
+     *      - the other K-1 window rows are copies of that row (memcpy)
+     *
+     * And the letterbox bars around the game art never change, so clear them
+     * only when the window surface changes (resize) or the game art moves
+     * (a new scale), not every frame. After that, only the game art rectangle
+     * is sent to the OS.
+     *
+     * Pixels are copied, never converted: the game art surface must have the
+     * same 32-bit format as the window surface.
+     * *******************************/
+    struct Presenter
+    {
+        int win_w, win_h;                   // Window surface at the last present (changed : clear the bars)
+        uint32_t format;                    // Its pixel format
+        SDL_Rect shown;                     // Where the game art went (moved : clear the bars)
+        long frames;                        // Frames presented
+        long bar_clears;                    // Frames that cleared the bars (first frame, resizes, new scales)
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    void init(Presenter&);
+    template<int K> void expand_row(const uint32_t* src, int n, uint32_t* dst); // Each pixel K times
+    void expand_row(const uint32_t* src, int n, uint32_t* dst, int K);  // Pick the specialized loop
+    void upscale(const uint32_t* src, int w, int h, int src_pitch, uint32_t* dst, int dst_pitch, int K);
+    void clear_bars(SDL_Surface*, const SDL_Rect& art);             // Black outside art
+    bool present(Presenter&, SDL_Window*, SDL_Surface* art, const SDL_Rect& dstrect);
+}
+
+void Present::init(Presenter& p)
+{
+    p.win_w = -1; p.win_h = -1; p.format = 0;       // (No window yet: first present clears the bars)
+    p.shown = SDL_Rect{.x=0, .y=0, .w=0, .h=0};
+    p.frames = 0; p.bar_clears = 0;
+}
+
+template<int K> void Present::expand_row(const uint32_t* src, int n, uint32_t* dst)
+{
+    for (int i=0; i<n; i++)
+    {
+        const uint32_t c = src[i];
+        for (int k=0; k<K; k++) dst[i*K + k] = c;   // K is a constant: unrolled
+    }
+}
+
+void Present::expand_row(const uint32_t* src, int n, uint32_t* dst, int K)
+{
+    switch (K)
+    {
+        case 1: memcpy(dst, src, sizeof(uint32_t)*n); break;
+        case 2: expand_row<2>(src, n, dst); break;
+        case 3: expand_row<3>(src, n, dst); break;
+        case 4: expand_row<4>(src, n, dst); break;
+        case 5: expand_row<5>(src, n, dst); break;
+        case 6: expand_row<6>(src, n, dst); break;
+        case 8: expand_row<8>(src, n, dst); break;
+        default:
+            for (int i=0; i<n; i++) for (int k=0; k<K; k++) dst[i*K + k] = src[i];
+            break;
+    }
+}
+
+void Present::upscale(const uint32_t* src, int w, int h, int src_pitch, uint32_t* dst, int dst_pitch, int K)
+{ // Nearest neighbor by a whole number K: w x h pixels become Kw x Kh
+    /* *************DOC***************
+     * Pitches are in pixels (uint32_t), not bytes. dst is the top left of the
+     * Kw x Kh block it fills.
+     * *******************************/
+    assert(K >= 1);
+    for (int y=0; y<h; y++)
+    {
+        uint32_t* row = dst + static_cast<long>(y)*K*dst_pitch;
+        expand_row(src + static_cast<long>(y)*src_pitch, w, row, K);
+        for (int k=1; k<K; k++) memcpy(row + static_cast<long>(k)*dst_pitch, row, sizeof(uint32_t)*w*K);
+    }
+}
+
+void Present::clear_bars(SDL_Surface* surf, const SDL_Rect& art)
+{ // Up to 4 bars: above, below, left, right of the game art
+    const int right = art.x + art.w; const int bottom = art.y + art.h;
+    SDL_Rect bars[4] = {
+        {.x=0, .y=0, .w=surf->w, .h=art.y},
+        {.x=0, .y=bottom, .w=surf->w, .h=surf->h - bottom},
+        {.x=0, .y=art.y, .w=art.x, .h=art.h},
+        {.x=right, .y=art.y, .w=surf->w - right, .h=art.h}
+    };
+    for (const SDL_Rect& bar : bars)
+    {
+        if ((bar.w > 0) && (bar.h > 0)) SDL_FillRect(surf, &bar, 0);
+    }
+}
+
+bool Present::present(Presenter& p, SDL_Window* win, SDL_Surface* art, const SDL_Rect& dstrect)
+{ // Upscale art into the window surface at dstrect (from scale_src_to_win), show it
+    /* *************DOC***************
+     * Return false if the window surface can't take the game art as is (no
+     * surface, or not the same 32-bit format): present some other way.
+     *
+     * If the window is smaller than the game art, there is no scaling (K=1)
+     * and the game art is clipped to the window.
+     * *******************************/
+    SDL_Surface* surf = SDL_GetWindowSurface(win);
+    if (  (surf == NULL) || (surf->format->BytesPerPixel != 4) || (surf->format->format != art->format->format)  )
+    {
+        return false;
+    }
+    const int K = (dstrect.w >= art->w) ? dstrect.w/art->w : 1;
+    // Part of the game art that lands in the window (all of it, unless the window is small and K=1)
+    const int skip_x = std::max(0, -dstrect.x); const int skip_y = std::max(0, -dstrect.y);
+    SDL_Rect shown = {.x=std::max(0, dstrect.x), .y=std::max(0, dstrect.y), .w=0, .h=0};
+    const int cols = std::min(art->w - skip_x, (surf->w - shown.x)/K);
+    const int rows = std::min(art->h - skip_y, (surf->h - shown.y)/K);
+    shown.w = std::max(0, cols*K); shown.h = std::max(0, rows*K);
+    const bool resized = (surf->w != p.win_w) || (surf->h != p.win_h) || (surf->format->format != p.format) ||
+                         !SDL_RectEquals(&shown, &p.shown);
+    if (resized)
+    { // New window surface (or the game art moved): clear the bars (once)
+        clear_bars(surf, shown);
+        p.win_w = surf->w; p.win_h = surf->h; p.format = surf->format->format; p.shown = shown;
+        p.bar_clears++;
+    }
+    if ((cols > 0) && (rows > 0))
+    {
+        if (SDL_MUSTLOCK(surf)) SDL_LockSurface(surf);
+        const uint32_t* src = static_cast<const uint32_t*>(art->pixels) + static_cast<long>(skip_y)*(art->pitch/4) + skip_x;
+        uint32_t* dst = static_cast<uint32_t*>(surf->pixels) + static_cast<long>(shown.y)*(surf->pitch/4) + shown.x;
+        upscale(src, cols, rows, art->pitch/4, dst, surf->pitch/4, K);
+        if (SDL_MUSTLOCK(surf)) SDL_UnlockSurface(surf);
+    }
+    // Only the game art changed, unless the bars were just cleared
+    if (resized) SDL_UpdateWindowSurface(win);
+    else         SDL_UpdateWindowSurfaceRects(win, &shown, 1);
+    p.frames++;
+    return true;
+}
+
+#endif // __MG_PRESENT_H__
@@ -0,0 +1,381 @@
+#ifndef __MG_RASTER_H__
+#define __MG_RASTER_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "mg_jobs.h"
+#include "mg_pixfmt.h"
+
+namespace Raster
+{ // Software rasterizer: draw into CPU memory, then stream it to a texture
+    /* *************Why a software stroke rasterizer***************
+     * SDL_RenderDrawLinesF draws 1-pixel lines with no anti-aliasing. At high
+     * GameArt::scale the lines look jagged, and there is no way to make them
+     * thicker.
+     *
+     * So draw thick lines myself into a Canvas (a plain array of pixels in CPU
+     * memory), then copy the Canvas to a streaming texture once per frame and
+     * copy that texture onto the game art.
+     *
+     * A thick line segment is a "capsule": every pixel within half the width of
+     * the segment. The coverage of a pixel is how much of it is inside the
+     * capsule. Approximate that with the distance d from the pixel center to the
+     * segment:
+     *
+     *      coverage = clamp(half_width + 0.5 - d, 0, 1)
+     *
+     * Fully inside : 1. Fully outside : 0. On the edge : a smooth ramp one pixel
+     * wide. That ramp is the anti-aliasing.
+     *
+     * A polyline is a chain of capsules. Where two capsules meet, their round
+     * ends overlap and make a round join. The first and last capsule ends are
+     * round caps. Do NOT blend each capsule separately (the join pixels would
+     * get blended twice and look darker). Instead take the max coverage of all
+     * capsules in a scratch buffer, then blend the whole polyline once.
+     * *******************************/
+    /* *************Many polylines on many threads***************
+     * Collect the frame's polylines in a Batch, then stroke the whole Batch
+     * with a Jobs::Pool. Two threads must not blend the same pixel, so the
+     * threads split the canvas, not the polylines: the canvas is cut into
+     * bands of BAND_ROWS rows, and a thread grabs a band and strokes every
+     * polyline whose box touches it (only the rows in the band). Polylines
+     * are blended in Batch order in every band, so the result is the same as
+     * stroking them one at a time.
+     *
+     * Each thread has its own Spans. The coverage scratch is shared: bands
+     * don't share rows, so threads never touch the same coverage.
+     * *******************************/
+    struct Spans
+    { // Scratch: row spans a polyline touches (h is unused)
+        SDL_Rect* rects;
+        int count;                          // Number in use
+        int room;                           // Room in rects (grows, see stroke_rows)
+    };
+
+    struct Canvas
+    {
+        Uint32* pixels;                     // w*h in format, transparent is 0
+        Uint32 format;                      // A PixFmt::Packing format (PixFmt::negotiate picks it)
+        float* coverage;                    // Scratch: coverage of the polylines being drawn (kept 0)
+        Spans* spans;                       // Scratch: one per thread (spans[0] when there is no Pool)
+        int threads;                        // Number of Spans
+        int w, h;                           // Size in pixels
+        SDL_Rect dirty;                     // Area drawn since the last clear
+    };
+
+    struct Batch
+    { // Polylines to stroke together
+        SDL_FPoint* points;                 // Every polyline, one after the other
+        int* first;                         // Polyline i is points[first[i]:first[i+1])
+        SDL_Color* colors;                  // Color of polyline i
+        SDL_FRect* boxes;                   // Bounding box of polyline i's points
+        int count;                          // Number of polylines
+        int capacity;                       // Room for polylines
+        int max_points;                     // Room for points (all polylines)
+    };
+
+    constexpr int MAX_SPANS = 1<<16;                // Row spans room to start with (doubles when a polyline needs more)
+    constexpr int BAND_ROWS = 16;                   // Rows in a band (one band is one grab of a thread)
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    void alloc(Canvas&, int w, int h, Uint32 format); // Remember to release(canvas)
+    void release(Canvas&);
+    SDL_Rect clear(Canvas&);                        // Clear to transparent, return area cleared
+    void stroke(Canvas&, const SDL_FPoint* points, int count, float width, SDL_Color c);
+    void stroke(Canvas&, Jobs::Pool&, Batch&, float width); // Every polyline in the batch, then empty it
+    void stroke_rows(Canvas&, Spans&, const SDL_FPoint* points, int count, float width, int y0, int y1); // Coverage of rows [y0:y1)
+    void alloc(Batch&, int capacity, int max_points); // Remember to release(batch)
+    void release(Batch&);
+    bool add(Batch&, const SDL_FPoint* points, int count, SDL_Color c); // false : no room (stroke the batch first)
+    void blend_spans(Canvas&, Spans&, SDL_Color c); // Blend the coverage in the spans, zero it
+    template<Uint32 FORMAT> void blend_spans(Canvas&, Spans&, SDL_Color c); // (Packing known at compile time)
+}
+
+void Raster::alloc(Canvas& canvas, int w, int h, Uint32 format)
+{ // Allocate a transparent canvas
+    assert(PixFmt::packable(format));
+    canvas.w = w; canvas.h = h;
+    canvas.format = format;
+    canvas.pixels = (Uint32*)malloc(sizeof(Uint32)*w*h);
+    canvas.coverage = (float*)malloc(sizeof(float)*w*h);
+    memset(canvas.pixels, 0, sizeof(Uint32)*w*h);
+    memset(canvas.coverage, 0, sizeof(float)*w*h);
+    canvas.spans = (Spans*)malloc(sizeof(Spans));
+    canvas.spans[0] = Spans{.rects=(SDL_Rect*)malloc(sizeof(SDL_Rect)*MAX_SPANS), .count=0, .room=MAX_SPANS};
+    canvas.threads = 1;                             // (More when a Pool strokes a Batch)
+    canvas.dirty = SDL_Rect{.x=0, .y=0, .w=0, .h=0};
+}
+
+void Raster::release(Canvas& canvas)
+{
+    free(canvas.pixels);
+    free(canvas.coverage);
+    for (int j=0; j<canvas.threads; j++) free(canvas.spans[j].rects);
+    free(canvas.spans);
+    canvas.pixels = NULL; canvas.coverage = NULL; canvas.spans = NULL; canvas.threads = 0;
+}
+
+void Raster::alloc(Batch& batch, int capacity, int max_points)
+{ // Allocate an empty batch
+    batch.points = (SDL_FPoint*)malloc(sizeof(SDL_FPoint)*max_points);
+    batch.first = (int*)malloc(sizeof(int)*(capacity+1));
+    batch.colors = (SDL_Color*)malloc(sizeof(SDL_Color)*capacity);
+    batch.boxes = (SDL_FRect*)malloc(sizeof(SDL_FRect)*capacity);
+    batch.first[0] = 0;
+    batch.count = 0; batch.capacity = capacity; batch.max_points = max_points;
+}
+
+void Raster::release(Batch& batch)
+{
+    free(batch.points); free(batch.first); free(batch.colors); free(batch.boxes);
+    batch = Batch{.points=NULL, .first=NULL, .colors=NULL, .boxes=NULL, .count=0, .capacity=0, .max_points=0};
+}
+
+bool Raster::add(Batch& batch, const SDL_FPoint* points, int count, SDL_Color c)
+{ // Copy the polyline into the batch
+    if (count <= 0) return true;                    // (Nothing to draw)
+    const int at = batch.first[batch.count];
+    if ((batch.count == batch.capacity) || (at + count > batch.max_points)) return false;
+    float xmin=points[0].x, xmax=points[0].x, ymin=points[0].y, ymax=points[0].y;
+    for (int i=0; i<count; i++)
+    {
+        batch.points[at+i] = points[i];
+        xmin = std::min(xmin, points[i].x); xmax = std::max(xmax, points[i].x);
+        ymin = std::min(ymin, points[i].y); ymax = std::max(ymax, points[i].y);
+    }
+    batch.colors[batch.count] = c;
+    batch.boxes[batch.count] = SDL_FRect{.x=xmin, .y=ymin, .w=xmax-xmin, .h=ymax-ymin};
+    batch.first[++batch.count] = at + count;
+    return true;
+}
+
+SDL_Rect Raster::clear(Canvas& canvas)
+{ // Clearing the whole canvas every frame is a lot of memory traffic. Clear what got drawn.
+    SDL_Rect d = canvas.dirty;
+    for (int y=d.y; y<d.y+d.h; y++)
+    {
+        memset(&canvas.pixels[y*canvas.w + d.x], 0, sizeof(Uint32)*d.w);
+    }
+    canvas.dirty = SDL_Rect{.x=0, .y=0, .w=0, .h=0};
+    return d;
+}
+
+void Raster::stroke(Canvas& canvas, const SDL_FPoint* points, int count, float width, SDL_Color c)
+{ // Draw an anti-aliased polyline of the given width
+    /* *************DOC***************
+     * Parameters
+     * ----------
+     * canvas : Canvas to draw on
+     * points : SDL_FPoint array
+     *      the polyline, in canvas pixels (same coordinates as GameArt::rect)
+     * count : int
+     *      number of points (a single point draws a dot)
+     * width : float
+     *      line width in pixels
+     * c : SDL_Color
+     *      color, c.a is the opacity of the fully covered pixels
+     * *******************************/
+    if (count <= 0) return;
+    const float reach = 0.5f*width + 0.5f;          // Coverage is 0 beyond this distance
+    // Bounding box of the whole polyline, clipped to the canvas
+    float xmin=points[0].x, xmax=points[0].x, ymin=points[0].y, ymax=points[0].y;
+    for (int i=1; i<count; i++)
+    {
+        xmin = std::min(xmin, points[i].x); xmax = std::max(xmax, points[i].x);
+        ymin = std::min(ymin, points[i].y); ymax = std::max(ymax, points[i].y);
+    }
+    int X0 = static_cast<int>(floorf(xmin - reach)); if (X0 < 0) X0 = 0;
+    int Y0 = static_cast<int>(floorf(ymin - reach)); if (Y0 < 0) Y0 = 0;
+    int X1 = static_cast<int>(ceilf(xmax + reach));  if (X1 > canvas.w) X1 = canvas.w;
+    int Y1 = static_cast<int>(ceilf(ymax + reach));  if (Y1 > canvas.h) Y1 = canvas.h;
+    if ((X0 >= X1) || (Y0 >= Y1)) return;           // Off canvas
+
+    stroke_rows(canvas, canvas.spans[0], points, count, width, Y0, Y1);
+    blend_spans(canvas, canvas.spans[0], c);
+
+    // Grow the dirty area
+    SDL_Rect box = {.x=X0, .y=Y0, .w=X1-X0, .h=Y1-Y0};
+    SDL_UnionRect(&canvas.dirty, &box, &canvas.dirty);  // (Union with an empty rect is box)
+}
+
+void Raster::stroke(Canvas& canvas, Jobs::Pool& pool, Batch& batch, float width)
+{ // Draw every polyline in the batch (see "Many polylines on many threads"), then empty the batch
+    if (batch.count == 0) return;
+    const float reach = 0.5f*width + 0.5f;
+    const int threads = Jobs::threads(pool);
+    if (canvas.threads < threads)
+    { // First time with this pool: a Spans for every thread
+        Spans* grown = (Spans*)realloc(canvas.spans, sizeof(Spans)*threads);
+        if (grown != NULL)
+        {
+            canvas.spans = grown;
+            for (int j=canvas.threads; j<threads; j++)
+            {
+                canvas.spans[j] = Spans{.rects=(SDL_Rect*)malloc(sizeof(SDL_Rect)*MAX_SPANS), .count=0, .room=MAX_SPANS};
+            }
+            canvas.threads = threads;
+        }
+    }
+    const int nbands = (canvas.h + BAND_ROWS-1)/BAND_ROWS;
+    std::atomic<int> next_band{0};
+    // One job per thread, and each job grabs bands until there are none left (a job
+    // is never on two threads at once, so job j can use canvas.spans[j])
+    Jobs::parallel_for(pool, std::min(threads, canvas.threads), 1, [&](int begin, int end)
+    {
+        for (int j=begin; j<end; j++)
+        {
+            for (int band=next_band++; band<nbands; band=next_band++)
+            {
+                const int y0 = band*BAND_ROWS;
+                const int y1 = std::min(y0 + BAND_ROWS, canvas.h);
+                for (int i=0; i<batch.count; i++)
+                {
+                    const SDL_FRect& box = batch.boxes[i];
+                    if ((box.y - reach >= y1) || (box.y + box.h + reach <= y0)) continue; // Not in this band
+                    stroke_rows(canvas, canvas.spans[j], &batch.points[batch.first[i]],
+                                batch.first[i+1] - batch.first[i], width, y0, y1);
+                    blend_spans(canvas, canvas.spans[j], batch.colors[i]);
+                }
+            }
+        }
+    });
+
+    // Grow the dirty area
+    for (int i=0; i<batch.count; i++)
+    {
+        const SDL_FRect& b = batch.boxes[i];
+        int X0 = static_cast<int>(floorf(b.x - reach));       if (X0 < 0) X0 = 0;
+        int Y0 = static_cast<int>(floorf(b.y - reach));       if (Y0 < 0) Y0 = 0;
+        int X1 = static_cast<int>(ceilf(b.x + b.w + reach));  if (X1 > canvas.w) X1 = canvas.w;
+        int Y1 = static_cast<int>(ceilf(b.y + b.h + reach));  if (Y1 > canvas.h) Y1 = canvas.h;
+        if ((X0 >= X1) || (Y0 >= Y1)) continue;     // Off canvas
+        SDL_Rect box = {.x=X0, .y=Y0, .w=X1-X0, .h=Y1-Y0};
+        SDL_UnionRect(&canvas.dirty, &box, &canvas.dirty);
+    }
+    batch.count = 0;
+}
+
+void Raster::stroke_rows(Canvas& canvas, Spans& spans, const SDL_FPoint* points, int count, float width, int Y0, int Y1)
+{ // Max coverage of the polyline's capsules, in rows [Y0:Y1) only, and the spans it touches
+    const float reach = 0.5f*width + 0.5f;          // Coverage is 0 beyond this distance
+
+    //////////////////////////////
+    // COVERAGE: MAX OVER CAPSULES
+    //////////////////////////////
+    // Only visit pixels near the capsule. For each row, find the part of the segment
+    // within reach of the row (vertically), then the pixels within reach of that part
+    // (horizontally). Long diagonal segments (RDP makes lots of those) stay cheap.
+    const int nseg = (count > 1) ? count-1 : 1;     // One point: a zero-length capsule (a dot)
+    for (int s=0; s<nseg; s++)
+    {
+        SDL_FPoint a = points[s];
+        SDL_FPoint b = (count > 1) ? points[s+1] : points[s];
+        float dx = b.x - a.x; float dy = b.y - a.y;
+        float len2 = dx*dx + dy*dy;
+        float inv_len2 = (len2 > 0) ? 1.0f/len2 : 0.0f;
+        float inv_dy = (dy != 0) ? 1.0f/dy : 0.0f;
+        int y0 = static_cast<int>(floorf(std::min(a.y,b.y) - reach)); if (y0 < Y0) y0 = Y0;
+        int y1 = static_cast<int>(ceilf(std::max(a.y,b.y) + reach));  if (y1 > Y1) y1 = Y1;
+        for (int y=y0; y<y1; y++)
+        {
+            const float yc = static_cast<float>(y) + 0.5f;  // Pixel center
+            // λ range of the segment within reach of this row
+            float t0 = 0; float t1 = 1;
+            if (dy != 0)
+            {
+                t0 = (yc - reach - a.y)*inv_dy; t1 = (yc + reach - a.y)*inv_dy;
+                if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+                t0 = std::max(t0, 0.0f); t1 = std::min(t1, 1.0f);
+                if (t0 > t1) continue;
+            }
+            float xa = a.x + t0*dx; float xb = a.x + t1*dx;
+            // (Truncate instead of floor/ceil: the clip to the canvas fixes up negative values,
+            //  and one extra pixel on the right has coverage 0 anyway.)
+            int x0 = static_cast<int>(std::min(xa,xb) - reach - 0.5f);     if (x0 < 0) x0 = 0;
+            int x1 = static_cast<int>(std::max(xa,xb) + reach + 0.5f) + 1; if (x1 > canvas.w) x1 = canvas.w;
+            if (x0 >= x1) continue;
+            if (spans.count == spans.room)
+            { // Out of room: grow (NOT blend_spans: the capsules still to come would blend their joins again)
+                SDL_Rect* grown = (SDL_Rect*)realloc(spans.rects, sizeof(SDL_Rect)*2*spans.room);
+                if (grown == NULL) continue;        // (No memory: this row of the capsule is left out)
+                spans.rects = grown; spans.room *= 2;
+            }
+            spans.rects[spans.count++] = SDL_Rect{.x=x0, .y=y, .w=x1-x0, .h=1};
+            // One span: a plain loop along the row (GCC keeps it scalar: sqrtf may set errno,
+            // and the clamps are not if-converted while float math may trap)
+            float* cov = &canvas.coverage[y*canvas.w];
+            const float py = yc - a.y;
+            for (int x=x0; x<x1; x++)
+            {
+                float px = (static_cast<float>(x) + 0.5f) - a.x;
+                // Closest point on the segment is at λ = clamp(dot(p,ab)/|ab|^2, 0, 1)
+                float t = std::min(std::max((px*dx + py*dy)*inv_len2, 0.0f), 1.0f);
+                float ex = px - t*dx; float ey = py - t*dy;
+                float d = sqrtf(ex*ex + ey*ey);
+                float coverage = std::min(std::max(reach - d, 0.0f), 1.0f);
+                cov[x] = std::max(cov[x], coverage);
+            }
+        }
+    }
+}
+
+void Raster::blend_spans(Canvas& canvas, Spans& spans, SDL_Color c)
+{ // Pick the blend loop for the canvas format
+    switch (canvas.format)
+    {
+        case SDL_PIXELFORMAT_ARGB8888: blend_spans<SDL_PIXELFORMAT_ARGB8888>(canvas, spans, c); break;
+        case SDL_PIXELFORMAT_ABGR8888: blend_spans<SDL_PIXELFORMAT_ABGR8888>(canvas, spans, c); break;
+        case SDL_PIXELFORMAT_BGRA8888: blend_spans<SDL_PIXELFORMAT_BGRA8888>(canvas, spans, c); break;
+        default:                       blend_spans<SDL_PIXELFORMAT_RGBA8888>(canvas, spans, c); break;
+    }
+}
+
+template<Uint32 FORMAT> void Raster::blend_spans(Canvas& canvas, Spans& spans, SDL_Color c)
+{ // Blend color c onto the canvas with the coverage in the recorded spans
+    /* *************DOC***************
+     * Spans from neighboring capsules overlap. The first span to visit a pixel
+     * blends it and sets its coverage back to 0, so later spans skip it. That
+     * way every pixel is blended exactly once (with the max coverage), and the
+     * coverage scratch is all zeros again for the next polyline.
+     *
+     * Straight (not premultiplied) alpha, "over" operator. FORMAT is the
+     * canvas format: the shifts are constants in the loop.
+     * *******************************/
+    using P = PixFmt::Packing<FORMAT>;
+    const float ca = static_cast<float>(c.a)/255.0f;
+    for (int i=0; i<spans.count; i++)
+    {
+        const SDL_Rect& span = spans.rects[i];
+        float* cov = &canvas.coverage[span.y*canvas.w];
+        Uint32* row = &canvas.pixels[span.y*canvas.w];
+        for (int x=span.x; x<span.x+span.w; x++)
+        {
+            float sa = ca*cov[x];                   // Source alpha
+            cov[x] = 0;                             // Leave the scratch clean
+            if (sa <= 0) continue;
+            Uint32 dst = row[x];
+            if (PixFmt::alpha<FORMAT>(dst) == 0)
+            { // Usual case: nothing drawn here yet, so just write the color
+                row[x] = PixFmt::pack<FORMAT>(c.r, c.g, c.b, static_cast<Uint32>(255.0f*sa + 0.5f));
+                continue;
+            }
+            float da = static_cast<float>(PixFmt::alpha<FORMAT>(dst))/255.0f;
+            float oa = sa + da*(1-sa);              // Output alpha
+            float ks = sa/oa; float kd = 1-ks;      // Weights of source and destination color
+            float r = ks*c.r + kd*static_cast<float>((dst >> P::R) & 0xFF);
+            float g = ks*c.g + kd*static_cast<float>((dst >> P::G) & 0xFF);
+            float b = ks*c.b + kd*static_cast<float>((dst >> P::B) & 0xFF);
+            row[x] = PixFmt::pack<FORMAT>(static_cast<Uint32>(r + 0.5f), static_cast<Uint32>(g + 0.5f),
+                                          static_cast<Uint32>(b + 0.5f), static_cast<Uint32>(255.0f*oa + 0.5f));
+        }
+    }
+    spans.count = 0;
+}
+
+#endif // __MG_RASTER_H__
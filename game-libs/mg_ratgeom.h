@@ -0,0 +1,213 @@
+#ifndef __MG_RATGEOM_H__
+#define __MG_RATGEOM_H__
+
+#include <cassert>
+#include <cstdlib>
+#include <numeric>
+
+namespace RatGeom
+{ // Rational trigonometry: quadrance, spread, and rotations with no sin or cos
+    /* *************Quadrance and spread***************
+     * Wildberger's rational trigonometry swaps distance and angle for two
+     * numbers that don't need square roots or transcendentals:
+     *
+     *      quadrance : distance squared
+     *                  Q(A,B) = (Bx-Ax)^2 + (By-Ay)^2
+     *
+     *      spread    : how far apart two directions are, 0 (parallel) to 1
+     *                  (perpendicular). For direction vectors u and v:
+     *
+     *                             (u x v)^2          (ux*vy - uy*vx)^2
+     *                  s(u,v) = ------------- = ----------------------------
+     *                            Q(u) * Q(v)     (ux^2 + uy^2)*(vx^2 + vy^2)
+     *
+     *                  (It's sin^2 of the angle, without ever finding the angle.)
+     *
+     * Compare quadrances instead of distances and the sqrt goes away (picking
+     * already does this, see Pick::Hit::d2).
+     * *******************************/
+    /* *************Exact rational rotations***************
+     * The circle parametrization (see RatCircle::x and RatCircle::y) is also a
+     * rotation. Pick integers n, d. Then
+     *
+     *      a = d^2 - n^2       b = 2*n*d       q = d^2 + n^2
+     *
+     * and a^2 + b^2 = q^2, so [a/q, b/q] is EXACTLY on the unit circle. Use it
+     * as [cos, sin] and that's a rotation with no sin or cos anywhere:
+     *
+     *      x' = (a*x - b*y)/q
+     *      y' = (b*x + a*y)/q
+     *
+     * A Turn keeps a, b, q as integers, so it is exact. Think of [a, b] as the
+     * complex number a + ib (it is (d + in)^2). Doing one Turn after another is
+     * multiplying the complex numbers, still all integers:
+     *
+     *      [a1, b1, q1] then [a2, b2, q2] = [a1*a2 - b1*b2, a1*b2 + b1*a2, q1*q2]
+     *
+     * The numbers grow with every compose (a common factor is divided out),
+     * so an exact Turn is for building a shape, not for adding up a spin every
+     * frame. For that, use a Rotation: the same [cos, sin] as floats, composed
+     * the same way, with a cheap fix (no sqrt) to keep it on the unit circle.
+     *
+     *      RatGeom::turn(1,1)  : quarter turn, [0, 1]
+     *      RatGeom::turn(1,2)  : [3/5, 4/5], the 3-4-5 triangle
+     *      RatGeom::turn(1,16) : about 7.15 degrees
+     *
+     * The angle of turn(n,d) is twice the angle of the vector [d, n] (the
+     * half-angle tangent is n/d). Small n/d : small turn.
+     * *******************************/
+    struct Turn
+    { // Exact rotation by [a/q, b/q], a^2 + b^2 = q^2
+        long long a;                        // q*cos
+        long long b;                        // q*sin
+        long long q;                        // Always > 0
+    };
+
+    struct Rotation
+    { // Rotation as floats: multiply a point by this
+        float c;                            // cos (but computed rationally)
+        float s;                            // sin
+    };
+
+    constexpr Turn QUARTER_TURN = {.a=0, .b=1, .q=1};   // x=-y, y=x
+    constexpr Turn NO_TURN = {.a=1, .b=0, .q=1};
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    float quadrance(SDL_FPoint A, SDL_FPoint B);        // Distance squared from A to B
+    float quadrance(SDL_FPoint v);                      // Length squared of vector v
+    float spread(SDL_FPoint u, SDL_FPoint v);           // sin^2 of the angle between directions u, v
+    float spread(SDL_FPoint A, SDL_FPoint B, SDL_FPoint C); // Spread at vertex B of triangle ABC
+    Turn turn(int n, int d);                            // Exact rotation with half-angle tangent n/d
+    Turn compose(Turn first, Turn second);              // first, then second
+    Turn inverse(Turn t);                               // Undo t
+    float spread(Turn t);                               // Spread between a vector and the vector turned
+    Rotation rotation(Turn t);                          // Exact Turn to float Rotation
+    Rotation compose(Rotation first, Rotation second);  // (Renormalized: stays a rotation)
+    SDL_FPoint rotate(Rotation r, SDL_FPoint p);        // Rotate p about [0,0]
+    void rotate(Rotation r, const float* x, const float* y, float* out_x, float* out_y, int count);
+    void rotate(Rotation r, const SDL_FPoint* points, SDL_FPoint* out, int count, SDL_FPoint center);
+}
+
+float RatGeom::quadrance(SDL_FPoint A, SDL_FPoint B)
+{
+    float dx = B.x - A.x; float dy = B.y - A.y;
+    return dx*dx + dy*dy;
+}
+
+float RatGeom::quadrance(SDL_FPoint v)
+{
+    return v.x*v.x + v.y*v.y;
+}
+
+float RatGeom::spread(SDL_FPoint u, SDL_FPoint v)
+{ // 0 : parallel, 1 : perpendicular. (Either vector [0,0] : 0, no direction to compare.)
+    float cross = u.x*v.y - u.y*v.x;
+    float qq = quadrance(u)*quadrance(v);
+    return (qq > 0) ? (cross*cross)/qq : 0.0f;
+}
+
+float RatGeom::spread(SDL_FPoint A, SDL_FPoint B, SDL_FPoint C)
+{ // Spread between lines BA and BC
+    return spread(SDL_FPoint{.x=A.x-B.x, .y=A.y-B.y}, SDL_FPoint{.x=C.x-B.x, .y=C.y-B.y});
+}
+
+RatGeom::Turn RatGeom::turn(int n, int d)
+{ // Exact rotation: [d^2 - n^2, 2nd] / (d^2 + n^2)
+    /* *************DOC***************
+     * Parameters
+     * ----------
+     * n, d : int, not both 0
+     *      half-angle tangent n/d. n/d from 0 to 1 turns 0 to 90 degrees,
+     *      same as λ on the RatCircle quarter circle. Negative n turns the
+     *      other way.
+     *
+     * Return
+     * ------
+     * Turn with the common factor divided out (turn(1,1) is [0,1,1], not [0,2,2])
+     * *******************************/
+    assert((n != 0) || (d != 0));
+    const long long N = n; const long long D = d;
+    Turn t = {.a=D*D - N*N, .b=2*N*D, .q=D*D + N*N};
+    long long g = std::gcd(std::gcd(t.a, t.b), t.q);
+    t.a /= g; t.b /= g; t.q /= g;
+    return t;
+}
+
+RatGeom::Turn RatGeom::compose(Turn first, Turn second)
+{ // Multiply the complex numbers a+ib, divide out the common factor
+    // Products must fit in a long long: keep every number under 2^31 going in
+    constexpr long long BIG = 1LL<<31;
+    assert((std::llabs(first.a) < BIG) && (std::llabs(first.b) < BIG) && (first.q < BIG));
+    assert((std::llabs(second.a) < BIG) && (std::llabs(second.b) < BIG) && (second.q < BIG));
+    Turn t = {
+        .a=first.a*second.a - first.b*second.b,
+        .b=first.a*second.b + first.b*second.a,
+        .q=first.q*second.q
+    };
+    long long g = std::gcd(std::gcd(t.a, t.b), t.q);
+    t.a /= g; t.b /= g; t.q /= g;
+    return t;
+}
+
+RatGeom::Turn RatGeom::inverse(Turn t)
+{ // Same turn, the other way
+    return Turn{.a=t.a, .b=-t.b, .q=t.q};
+}
+
+float RatGeom::spread(Turn t)
+{ // sin^2 of the turn
+    return static_cast<float>(static_cast<double>(t.b*t.b)/static_cast<double>(t.q*t.q));
+}
+
+RatGeom::Rotation RatGeom::rotation(Turn t)
+{
+    const double inv_q = 1.0/static_cast<double>(t.q);
+    return Rotation{.c=static_cast<float>(t.a*inv_q), .s=static_cast<float>(t.b*inv_q)};
+}
+
+RatGeom::Rotation RatGeom::compose(Rotation first, Rotation second)
+{ // Same as composing Turns, in floats. Then nudge it back onto the unit circle.
+    /* *************DOC***************
+     * Float round-off makes c^2 + s^2 drift away from 1 (the shape would slowly
+     * grow or shrink). c^2 + s^2 = 1 + e with e tiny, so 1/sqrt(1 + e) is almost
+     * exactly (3 - (1 + e))/2: one Newton step for 1/sqrt starting from 1. No
+     * sqrt, and the drift goes from e to about e^2.
+     * *******************************/
+    Rotation r = {
+        .c=first.c*second.c - first.s*second.s,
+        .s=first.c*second.s + first.s*second.c
+    };
+    float k = 0.5f*(3.0f - (r.c*r.c + r.s*r.s));
+    return Rotation{.c=k*r.c, .s=k*r.s};
+}
+
+SDL_FPoint RatGeom::rotate(Rotation r, SDL_FPoint p)
+{
+    return SDL_FPoint{.x=r.c*p.x - r.s*p.y, .y=r.s*p.x + r.c*p.y};
+}
+
+void RatGeom::rotate(Rotation r, const float* x, const float* y, float* out_x, float* out_y, int count)
+{ // Rotate count points about [0,0], structure-of-arrays (out can be x, y : rotate in place)
+    // Plain loop over contiguous floats: the compiler vectorizes it
+    const float c = r.c; const float s = r.s;
+    for (int i=0; i<count; i++)
+    {
+        float px = x[i]; float py = y[i];
+        out_x[i] = c*px - s*py;
+        out_y[i] = s*px + c*py;
+    }
+}
+
+void RatGeom::rotate(Rotation r, const SDL_FPoint* points, SDL_FPoint* out, int count, SDL_FPoint center)
+{ // Rotate count points about center (out can be points : rotate in place)
+    const float c = r.c; const float s = r.s;
+    for (int i=0; i<count; i++)
+    {
+        float px = points[i].x - center.x; float py = points[i].y - center.y;
+        out[i] = SDL_FPoint{.x=c*px - s*py + center.x, .y=s*px + c*py + center.y};
+    }
+}
+
+#endif // __MG_RATGEOM_H__
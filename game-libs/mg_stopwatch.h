@@ -0,0 +1,98 @@
+#ifndef __MG_STOPWATCH_H__
+#define __MG_STOPWATCH_H__
+
+#include <chrono>
+#include <cstdio>
+
+namespace Stopwatch
+{ // Time chunks of the game loop without a profiler
+    /* *************How to use a Tally***************
+     * A Tally adds up the time of many "laps" of the same chunk of code, like
+     * one lap per video frame:
+     *
+     *      Stopwatch::Tally render{"render"};     // Name it
+     *      while(!quit)
+     *      {
+     *          render.start();
+     *          // ...chunk of code to time...
+     *          render.stop();
+     *      }
+     *      render.print();                         // Average and worst lap
+     *
+     * The game loop is locked to VSYNC, so total frame time always looks like
+     * 16.7ms. Time the chunk itself to see what it costs.
+     * *******************************/
+    /* *************How to use a Timeline***************
+     * A Timeline times code that runs once, one phase after another (like
+     * startup). Each mark() ends a phase: it took from the last mark to now.
+     *
+     *      Stopwatch::Timeline startup;            // Clock starts here
+     *      SDL_Init(SDL_INIT_VIDEO);
+     *      startup.mark("SDL_Init");
+     *      // ...
+     *      startup.print();                        // When each phase started, ended, how long it took
+     *
+     * Work on another thread goes on the same timeline with span(): it ran
+     * from start to end, next to whatever the main thread was doing.
+     * *******************************/
+    using Clock = std::chrono::steady_clock;
+
+    struct Tally
+    {
+        const char* name;                   // Printed with the results
+        double total_us{};                  // Sum of all laps
+        double max_us{};                    // Worst lap
+        double last_us{};                   // Latest lap (for a live readout)
+        long laps{};                        // Number of laps
+        Clock::time_point t0{};             // Start of current lap
+
+        void start(void) { t0 = Clock::now(); }
+        void stop(void)
+        { // End the lap and add it to the tally
+            double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+            last_us = us;
+            total_us += us;
+            if (us > max_us) max_us = us;
+            laps++;
+        }
+        double avg_us(void) const { return (laps>0) ? total_us/laps : 0; }
+        void print(void) const
+        {
+            printf("%-24s: %9.1f us avg, %9.1f us max (%ld laps)\n", name, avg_us(), max_us, laps);
+        }
+    };
+
+    struct Timeline
+    {
+        static constexpr int MAX_PHASES = 32;
+        Clock::time_point t0{Clock::now()}; // Time 0 (made)
+        Clock::time_point last{t0};         // Last mark
+        const char* names[MAX_PHASES]{};
+        double from_us[MAX_PHASES]{};       // Phase start, since t0
+        double to_us[MAX_PHASES]{};         // Phase end, since t0
+        int phases{};
+
+        double since(Clock::time_point t) const { return std::chrono::duration<double, std::micro>(t - t0).count(); }
+        void span(const char* name, Clock::time_point start, Clock::time_point end)
+        { // (More than MAX_PHASES : not kept)
+            if (phases == MAX_PHASES) return;
+            names[phases] = name; from_us[phases] = since(start); to_us[phases] = since(end);
+            phases++;
+        }
+        void mark(const char* name)
+        { // Phase from the last mark to now
+            const Clock::time_point now = Clock::now();
+            span(name, last, now);
+            last = now;
+        }
+        void print(void) const
+        {
+            for (int i=0; i<phases; i++)
+            {
+                printf("%-24s: %9.1f us, %9.1f to %9.1f ms\n", names[i], to_us[i] - from_us[i], from_us[i]/1e3, to_us[i]/1e3);
+            }
+        }
+    };
+}
+
+#endif // __MG_STOPWATCH_H__
@@ -0,0 +1,238 @@
+#ifndef __MG_TILEMAP_H__
+#define __MG_TILEMAP_H__
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "mg_camera.h"
+
+namespace Tilemap
+{ // A grid of tiles, drawn a chunk at a time from textures that are only redrawn when a tile changes
+    /* *************Chunks and cached textures***************
+     * A tile is one byte: which kind of tile it is (0 is empty), and the
+     * palette says what color each kind is. A 4096x4096 map is 16 MB. (Need
+     * more than 256 kinds? Make Tile a uint16_t: two bytes a tile.)
+     *
+     * Tiles are grouped in CHUNK x CHUNK chunks, and each chunk's tiles are
+     * contiguous (chunk-major, not row-major): redrawing a chunk reads one
+     * 1 KB block.
+     *
+     * Drawing every tile every frame costs a fill per tile on screen (tens of
+     * thousands zoomed out). But tiles hardly ever change. So each chunk is
+     * drawn ONCE into its own texture, and each frame the camera just copies
+     * the textures of the chunks it sees: one SDL_RenderCopy per chunk.
+     *
+     *      - set() a tile : its chunk is marked dirty (nothing is drawn yet)
+     *      - draw() : each chunk on screen gets a texture from the cache, is
+     *        redrawn if it is dirty (or the texture was someone else's), then
+     *        copied to the game art
+     *
+     * The cache holds CACHE textures, all the same size. When it is full, the
+     * chunk that was on screen longest ago gives up its texture (it is redrawn
+     * if it comes back). So the textures are made once and re-used, and the
+     * per-frame cost goes with the chunks on screen, not the map size: a huge
+     * map costs the same as a small one.
+     * *******************************/
+    using Tile = uint8_t;                               // Kind of tile (0 : empty). uint16_t : 65536 kinds
+    constexpr int CHUNK = 32;                           // Chunk is CHUNK x CHUNK tiles
+    constexpr int KINDS = 1 << (8*sizeof(Tile));        // Kinds of tile (all a Tile can say)
+    constexpr int CACHE = 96;                           // Chunk textures kept (more than fit on screen)
+
+    struct Slot
+    { // A chunk texture in the cache
+        int chunk;                          // Chunk drawn in it (-1 : none)
+        SDL_Texture* tex;                   // (NULL : not made yet)
+        long used;                          // Last frame it was on screen
+    };
+
+    struct Map
+    {
+        int w, h;                           // Size in tiles
+        int cw, ch;                         // Size in chunks
+        int tile;                           // Tile size in world pixels
+        Tile* tiles;                        // Chunk-major: see index()
+        uint8_t* dirty;                     // Chunk tiles changed since its texture was drawn
+        int* slot_of;                       // Chunk's slot in the cache (-1 : no texture)
+        Slot cache[CACHE];
+        SDL_Color palette[KINDS];           // Color of each kind (kind 0 is not drawn)
+        Uint32 format;                      // Texture format (see PixFmt)
+        long frame;                         // draw() calls so far
+        long changes, redraws, copies, evictions; // Totals
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    void alloc(Map&, int w, int h, int tile, Uint32 format); // All empty. Remember to release(map)
+    void release(Map&);                             // (Also destroys the textures)
+    int index(const Map&, int tx, int ty);          // Where tile (tx,ty) is in tiles
+    Tile get(const Map&, int tx, int ty);           // (Off the map : 0)
+    void set(Map&, int tx, int ty, Tile);           // Change a tile, its chunk is dirty
+    void invalidate(Map&);                          // Every chunk is dirty (like a new palette)
+    void set_tile_size(Map&, int tile);             // New tile size: new textures (see scale switch)
+    void redraw(Map&, SDL_Renderer*, int chunk, SDL_Texture*); // Draw the chunk's tiles into tex
+    SDL_Texture* texture(Map&, SDL_Renderer*, int chunk); // Cached, up to date texture of the chunk
+    int draw(Map&, SDL_Renderer*, SDL_Texture* target, const Camera::View&); // Return chunks copied
+}
+
+void Tilemap::alloc(Map& m, int w, int h, int tile, Uint32 format)
+{
+    m.w = w; m.h = h; m.tile = tile; m.format = format;
+    m.cw = (w + CHUNK-1)/CHUNK; m.ch = (h + CHUNK-1)/CHUNK; // (Last chunks hang off the map: empty tiles)
+    const int nchunks = m.cw*m.ch;
+    m.tiles = (Tile*)calloc(static_cast<size_t>(nchunks)*CHUNK*CHUNK, sizeof(Tile));
+    m.dirty = (uint8_t*)malloc(sizeof(uint8_t)*nchunks);
+    m.slot_of = (int*)malloc(sizeof(int)*nchunks);
+    for (int c=0; c<nchunks; c++) { m.dirty[c] = 1; m.slot_of[c] = -1; }
+    for (Slot& s : m.cache) s = Slot{.chunk=-1, .tex=NULL, .used=0};
+    for (SDL_Color& c : m.palette) c = SDL_Color{0,0,0,0};
+    m.frame = 0; m.changes = 0; m.redraws = 0; m.copies = 0; m.evictions = 0;
+}
+
+void Tilemap::release(Map& m)
+{
+    set_tile_size(m, m.tile);                       // (Destroys the textures)
+    free(m.tiles); free(m.dirty); free(m.slot_of);
+    m.tiles = NULL; m.dirty = NULL; m.slot_of = NULL;
+    m.w = 0; m.h = 0; m.cw = 0; m.ch = 0;
+}
+
+int Tilemap::index(const Map& m, int tx, int ty)
+{ // Chunk (tx/CHUNK, ty/CHUNK), then the tile in it
+    const int chunk = (ty/CHUNK)*m.cw + tx/CHUNK;
+    return chunk*CHUNK*CHUNK + (ty%CHUNK)*CHUNK + tx%CHUNK;
+}
+
+Tilemap::Tile Tilemap::get(const Map& m, int tx, int ty)
+{
+    if ((tx < 0) || (ty < 0) || (tx >= m.w) || (ty >= m.h)) return 0;
+    return m.tiles[index(m, tx, ty)];
+}
+
+void Tilemap::set(Map& m, int tx, int ty, Tile t)
+{ // (Off the map : ignored. Same tile : nothing to redraw.)
+    if ((tx < 0) || (ty < 0) || (tx >= m.w) || (ty >= m.h)) return;
+    Tile& old = m.tiles[index(m, tx, ty)];
+    if (old == t) return;
+    old = t;
+    m.dirty[(ty/CHUNK)*m.cw + tx/CHUNK] = 1;
+    m.changes++;
+}
+
+void Tilemap::invalidate(Map& m)
+{
+    memset(m.dirty, 1, static_cast<size_t>(m.cw)*m.ch);
+}
+
+void Tilemap::set_tile_size(Map& m, int tile)
+{ // The textures are the wrong size now: destroy them all, make them again as chunks come on screen
+    for (Slot& s : m.cache)
+    {
+        if (s.tex != NULL) SDL_DestroyTexture(s.tex);
+        if (s.chunk >= 0) m.slot_of[s.chunk] = -1;
+        s = Slot{.chunk=-1, .tex=NULL, .used=0};
+    }
+    m.tile = tile;
+    invalidate(m);
+}
+
+void Tilemap::redraw(Map& m, SDL_Renderer* ren, int chunk, SDL_Texture* tex)
+{ // One fill per run of same-kind tiles in a row
+    /* *************DOC***************
+     * Draws with blending off: the texture gets the palette color as is (its
+     * alpha too), and blending happens once, when the texture is copied.
+     * Leaves the render target on tex.
+     * *******************************/
+    SDL_SetRenderTarget(ren, tex);
+    SDL_BlendMode mode;
+    SDL_GetRenderDrawBlendMode(ren, &mode);
+    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(ren, 0, 0, 0, 0);
+    SDL_RenderClear(ren);
+    const Tile* t = &m.tiles[static_cast<size_t>(chunk)*CHUNK*CHUNK];
+    for (int ty=0; ty<CHUNK; ty++)
+    {
+        int tx = 0;
+        while (tx < CHUNK)
+        {
+            const Tile kind = t[ty*CHUNK + tx];
+            int run = 1;
+            while ((tx + run < CHUNK) && (t[ty*CHUNK + tx + run] == kind)) run++;
+            if (kind != 0)
+            {
+                const SDL_Color c = m.palette[kind];
+                SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+                const SDL_Rect r = {.x=tx*m.tile, .y=ty*m.tile, .w=run*m.tile, .h=m.tile};
+                SDL_RenderFillRect(ren, &r);
+            }
+            tx += run;
+        }
+    }
+    SDL_SetRenderDrawBlendMode(ren, mode);
+    m.dirty[chunk] = 0;
+    m.redraws++;
+}
+
+SDL_Texture* Tilemap::texture(Map& m, SDL_Renderer* ren, int chunk)
+{ // Hit : its texture (redrawn if dirty). Miss : a free slot or the least recently used one.
+    int s = m.slot_of[chunk];
+    if (s < 0)
+    {
+        s = 0;
+        for (int i=1; i<CACHE; i++) if (m.cache[i].used < m.cache[s].used) s = i; // (Free slots: used=0)
+        Slot& slot = m.cache[s];
+        if (slot.chunk >= 0) { m.slot_of[slot.chunk] = -1; m.evictions++; }
+        if (slot.tex == NULL)
+        { // First use of this slot: make its texture (every chunk texture is the same size)
+            slot.tex = SDL_CreateTexture(ren, m.format, SDL_TEXTUREACCESS_TARGET, CHUNK*m.tile, CHUNK*m.tile);
+            if (slot.tex == NULL) return NULL;
+            SDL_SetTextureBlendMode(slot.tex, SDL_BLENDMODE_BLEND);
+        }
+        slot.chunk = chunk; m.slot_of[chunk] = s;
+        m.dirty[chunk] = 1;                         // (Texture has some other chunk in it)
+    }
+    Slot& slot = m.cache[s];
+    slot.used = m.frame;
+    if (m.dirty[chunk]) redraw(m, ren, chunk, slot.tex);
+    return slot.tex;
+}
+
+int Tilemap::draw(Map& m, SDL_Renderer* ren, SDL_Texture* target, const Camera::View& cam)
+{ // Copy the chunks the camera sees into target (redraw the dirty ones first)
+    /* *************DOC***************
+     * target is the render target to draw the map on (NULL : the default
+     * target), and it is the render target again when this returns. Chunks
+     * are CHUNK*tile world pixels across; each lands where the camera puts
+     * it, stretched by the zoom.
+     * *******************************/
+    m.frame++;                                      // (frame 0 is never used: free slots are oldest)
+    const SDL_FRect see = Camera::visible(cam);
+    const float size = static_cast<float>(CHUNK*m.tile);
+    if (!Camera::overlaps(see, SDL_FRect{.x=0, .y=0, .w=m.cw*size, .h=m.ch*size})) return 0;
+    auto clamp = [](int v, int hi) { return (v < 0) ? 0 : ((v > hi) ? hi : v); };
+    const int cx0 = clamp(static_cast<int>(std::floor(see.x/size)), m.cw-1);
+    const int cy0 = clamp(static_cast<int>(std::floor(see.y/size)), m.ch-1);
+    const int cx1 = clamp(static_cast<int>(std::floor((see.x + see.w)/size)), m.cw-1);
+    const int cy1 = clamp(static_cast<int>(std::floor((see.y + see.h)/size)), m.ch-1);
+    int n = 0;
+    for (int cy=cy0; cy<=cy1; cy++)
+    {
+        for (int cx=cx0; cx<=cx1; cx++)
+        {
+            const int chunk = cy*m.cw + cx;
+            const bool redrawn = (m.slot_of[chunk] < 0) || m.dirty[chunk];
+            SDL_Texture* tex = texture(m, ren, chunk);
+            if (tex == NULL) continue;
+            if (redrawn) SDL_SetRenderTarget(ren, target);
+            const SDL_FRect dst = Camera::to_art(cam, SDL_FRect{.x=cx*size, .y=cy*size, .w=size, .h=size});
+            SDL_RenderCopyF(ren, tex, NULL, &dst);
+            n++;
+        }
+    }
+    m.copies += n;
+    return n;
+}
+
+#endif // __MG_TILEMAP_H__
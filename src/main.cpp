@@ -3,7 +3,29 @@
 #include <SDL.h>
 #include "mg_colors.h"
 #include <chrono>
+#include <thread>
 #include <cassert>
+#include "mg_stopwatch.h"
+#include "mg_polyline.h"
+#include "mg_fastmath.h"
+#include "mg_raster.h"
+#include "mg_pick.h"
+#include "mg_fit.h"
+#include "mg_broadphase.h"
+#include "mg_intersect.h"
+#include "mg_ratgeom.h"
+#include "mg_jobs.h"
+#include "mg_boids.h"
+#include "mg_gravity.h"
+#include "mg_flow.h"
+#include "mg_particles.h"
+#include "mg_present.h"
+#include "mg_pixfmt.h"
+#include "mg_camera.h"
+#include "mg_tilemap.h"
+#include "mg_path.h"
+#include "mg_audio.h"
+#include "mg_fft.h"
 
 namespace GameDemo
 {
@@ -14,8 +36,37 @@ namespace GameDemo
     constexpr bool RAINBOW_STATIC = false;              // Just random colors
     constexpr bool RAT_CIRCLE = true;                   // FAVORITE: Rational parametrization of a circle
     constexpr bool BLOB = false;                        // Be an ameoba-plasma-ball-thing (uses RatCircle)
+    constexpr bool BLOB_SPIN = false;                   // The Blob turns a little every frame, exact rational turns (uses BLOB)
     constexpr bool GEN_CURVE = false;                   // Generate a curve with dCB quadratics
     constexpr bool FIT_CURVE = false;                   // Fit a curve with dCB quadratics
+    constexpr bool CURVE_HITS = false;                  // Animate the curves, mark where they cross
+    constexpr bool BOIDS = false;                       // Spinner centers flock (uses RAT_CIRCLE)
+    constexpr bool GRAVITY = false;                     // Spinner centers pull on each other (uses RAT_CIRCLE, not with BOIDS)
+    constexpr bool FLOW = false;                        // Spinner centers blow in the wind (uses RAT_CIRCLE, not with BOIDS or GRAVITY)
+    constexpr bool PARTICLES = false;                   // Sparks off the Blob, debris where curves cross (BLOB, CURVE_HITS)
+    constexpr bool CAMERA = false;                      // World is bigger than the game art: arrows pan, wheel zooms
+    constexpr int WORLD = 4;                            // CAMERA: world is WORLD x WORLD game arts
+    constexpr bool TILEMAP = false;                     // Tiles under everything, the Blob leaves a trail (try with CAMERA)
+    constexpr bool PATHS = false;                       // Walkers find their way around the tilemap hilltops (uses TILEMAP)
+    constexpr bool AUDIO = false;                       // The Blob blips when it moves (uses BLOB)
+    constexpr bool SONIFY = false;                      // Every spinner hums: pitch from speed (j/k), pan from x (uses RAT_CIRCLE)
+    constexpr bool REACT = false;                       // Spinners spin and swell, the Blob shakes, to a WAV file (uses RAT_CIRCLE)
+    constexpr const char* REACT_WAV = "music.wav";      // REACT: played over and over
+    constexpr int REACT_SPIN = 8;                       // REACT: extra steps a frame when a spinner's band is loudest
+    constexpr float REACT_SWELL = 0.5;                  // REACT: radius grows by this much when its band is loudest
+    constexpr int AUDIO_SAMPLES = 128;                  // AUDIO: samples per buffer (128 at 48 kHz : 2.7 ms)
+    constexpr int SONIFY_MAX = 4096;                    // SONIFY: most oscillators (Makefile's -O2: ~0.85 ms of a 2.7 ms buffer)
+
+    ///////////////////////////
+    // USER: PICK RENDER TRICKS
+    ///////////////////////////
+    constexpr bool SIMPLIFY_LINES = true;               // RDP: fewer line segments for flat curve runs
+    constexpr float SIMPLIFY_TOL = 0.5;                 // RDP tolerance in GameArt pixels
+    constexpr bool SNAP_POINTS = true;                  // Draw each chunky pixel once, not once per sample
+    constexpr bool STROKE_CURVES = false;               // Thick anti-aliased curves (software rasterizer)
+    constexpr float STROKE_WIDTH = 2.5;                 // Stroke width in GameArt pixels
+    constexpr float FIT_TOL = 1.0;                      // FIT_CURVE: RMS error in GameArt pixels before a new segment
+    constexpr bool CPU_PRESENT = false;                 // No GPU: software render, integer upscale to the window ourselves
 }
 
 namespace GameArt
@@ -26,16 +77,53 @@ namespace GameArt
                                                         //      scale <----  Try scale=10, 20, 40, 60, 80
                                                         //      |  10: max chunky! 20: retro game
                                                         //      v  80: high-res
-    constexpr int scale = 80;                           // Ex: 20*(16:9) = 320:180
-    constexpr SDL_Rect rect = {.x=0, .y=0, .w=scale*16, .h=scale*9}; // Game art has a 16:9 aspect ratio
+    int scale = 80;                                     // Ex: 20*(16:9) = 320:180 (- and = keys: step through SCALES)
+    constexpr int SCALES[] = {10, 20, 40, 50, 60, 80};  // Scales the - and = keys step through
+    SDL_Rect rect = {.x=0, .y=0, .w=scale*16, .h=scale*9}; // Game art has a 16:9 aspect ratio
+    SDL_Rect world;                                     // Where things live: rect (CAMERA: WORLD times rect)
     SDL_Texture* tex;                                   // Render game art to this texture
+    SDL_Surface* surface;                               // CPU_PRESENT: render game art here instead (tex is NULL)
+    SDL_Texture* stroke_tex;                            // Stream software-rasterized strokes to this texture
+    Raster::Canvas strokes;                             // Software-rasterize strokes here
+    PixFmt::Native native;                              // Pixel format for textures and canvases (no conversions)
+
+    ///////////////////////////////////
+    // GAME ART TARGETS, POOLED BY SIZE
+    ///////////////////////////////////
+    // Switching scale needs game art textures (and a stroke canvas) of the new size. Keep the last
+    // few sizes around: switching back and forth re-uses them instead of making them again.
+    struct Target
+    { // Everything that is the size of the game art
+        int w, h;                                       // Size (0 : free slot)
+        SDL_Texture* tex;                               // (CPU_PRESENT: NULL)
+        SDL_Surface* surface;                           // CPU_PRESENT: the game art...
+        SDL_Renderer* ren;                              // ...and the software renderer that draws on it
+        SDL_Texture* stroke_tex;                        // STROKE_CURVES
+        Raster::Canvas strokes;
+        long used;                                      // Last use (when full, make in place of the oldest)
+    };
+    constexpr int POOL = 3;                             // Sizes kept
+    Target pool[POOL];
+    Target* current;                                    // Target in use (tex, surface, ... are its)
+    long uses;                                          // Switches so far (Target::used is one of these)
+    long made;                                          // Targets made (the rest of the switches re-used one)
 
     //////////////////////////////////////////////
     // FUNCTIONS TO STRETCH TEXTURE OVER OS WINDOW
     //////////////////////////////////////////////
     SDL_Rect center_src_in_win(const SDL_Rect& window, const SDL_Rect& texture);
     SDL_Rect  scale_src_to_win(const SDL_Rect& window, const SDL_Rect& texture);
-
+    SDL_FPoint win_to_art(const SDL_Rect& dstrect, const SDL_Point& p); // Mouse -> game art
+
+    ////////////////////////////
+    // FUNCTIONS TO SWITCH SCALE
+    ////////////////////////////
+    int step_scale(int s, int step);                    // Next scale in SCALES (step -1 : smaller, +1 : bigger)
+    bool use(int s);                                    // Switch to scale s (false : SDL can't make the textures)
+    SDL_Rect world_at(int s);                           // What use(s) makes the world (no SDL: call it any time)
+    bool make(Target&, int w, int h);
+    void destroy(Target&);
+    void release_pool(void);
 }
 SDL_Rect GameArt::center_src_in_win(const SDL_Rect& winrect, const SDL_Rect& srcrect)
 {
@@ -77,6 +165,26 @@ SDL_Rect GameArt::scale_src_to_win(const SDL_Rect& winrect, const SDL_Rect& srcr
     return GameArt::center_src_in_win(winrect, scalerect);
 
 }
+SDL_FPoint GameArt::win_to_art(const SDL_Rect& dstrect, const SDL_Point& p)
+{
+    /* *************DOC***************
+     * Return OS window pixel p (like the mouse) in game art pixels.
+     *
+     * Undo the stretch that put the game art in the OS window: subtract the
+     * letterbox offset, then divide by the scaling factor. Use the center of
+     * the OS window pixel, so a big scaling factor does not round everything
+     * to the top-left of the chunky pixel.
+     *
+     * Parameters
+     * ------------
+     * dstrect : SDL_Rect where the game art is in the OS window (see scale_src_to_win)
+     * p : SDL_Point in OS window pixels
+     * *******************************/
+    return SDL_FPoint{
+        .x=(static_cast<float>(p.x - dstrect.x) + 0.5f)*rect.w/dstrect.w,
+        .y=(static_cast<float>(p.y - dstrect.y) + 0.5f)*rect.h/dstrect.h
+    };
+}
 
 // Control whether DEBUG stuff generates code or not
 enum { DEBUG = 1 };                                     // USER! Set DEBUG : 0 or 1
@@ -119,10 +227,118 @@ WindowInfo::WindowInfo(int argc, char* argv[])
 SDL_Window* win;
 SDL_Renderer* ren;
 
+int GameArt::step_scale(int s, int step)
+{
+    constexpr int n = sizeof(SCALES)/sizeof(SCALES[0]);
+    int i = 0;
+    while ((i < n-1) && (SCALES[i] < s)) i++;           // First scale >= s
+    i = std::min(std::max(i + step, 0), n-1);
+    return SCALES[i];
+}
+
+bool GameArt::use(int s)
+{ // Make scale s the game art size: its Target comes from the pool (or is made)
+    /* *************DOC***************
+     * Only the game art size changes here. The caller rescales the world
+     * (everything in game art pixels) by the new scale / the old scale.
+     * *******************************/
+    const int w = s*16; const int h = s*9;
+    if (current != NULL) current->strokes = strokes;    // (Canvas dirty rect goes back with it)
+    Target* t = NULL;
+    for (Target& p : pool) if ((p.w == w) && (p.h == h)) t = &p;
+    if (t == NULL)
+    { // Not in the pool: make it in a free slot, or in place of the least recently used
+        t = &pool[0];
+        for (Target& p : pool) if (p.used < t->used) t = &p;   // (Free slots are never used: used=0)
+        if (t->w > 0) destroy(*t);
+        if (!make(*t, w, h)) return false;
+        made++;
+    }
+    t->used = ++uses;
+    current = t;
+    scale = s; rect = SDL_Rect{.x=0, .y=0, .w=w, .h=h};
+    world = world_at(s);
+    tex = t->tex; surface = t->surface; stroke_tex = t->stroke_tex; strokes = t->strokes;
+    if (GameDemo::CPU_PRESENT) ren = t->ren;
+    return true;
+}
+
+SDL_Rect GameArt::world_at(int s)
+{
+    const int n = (GameDemo::CAMERA) ? GameDemo::WORLD : 1;
+    return SDL_Rect{.x=0, .y=0, .w=n*s*16, .h=n*s*9};
+}
+
+bool GameArt::make(Target& t, int w, int h)
+{ // Textures (or surface and renderer) and stroke canvas of size w x h
+    t = Target{};
+    if (GameDemo::CPU_PRESENT)
+    { // Software renderer that draws into a game art sized surface, in the window's pixel format.
+      // Its default target IS the game art, so tex is NULL (SetRenderTarget NULL : the surface).
+        t.surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_GetWindowPixelFormat(win));
+        if (t.surface == NULL) return false;
+        t.ren = SDL_CreateSoftwareRenderer(t.surface);
+        if (t.ren == NULL) { destroy(t); return false; } // (Frees the surface: t.w is still 0, so nothing else would)
+        SDL_SetRenderDrawBlendMode(t.ren, SDL_BLENDMODE_BLEND); // Draw with alpha
+    }
+    // Negotiate once, with the first renderer there is (see PixFmt)
+    SDL_Renderer* r = (GameDemo::CPU_PRESENT) ? t.ren : ren;
+    if (native.format == 0)
+    {
+        native = PixFmt::negotiate(r, (GameDemo::CPU_PRESENT) ? t.surface->format->format : SDL_GetWindowPixelFormat(win));
+    }
+    t.w = w; t.h = h;                                   // (destroy() frees what got made, even on failure)
+    if (!GameDemo::CPU_PRESENT)
+    { // Create a texture for game art
+        t.tex = SDL_CreateTexture(r, native.format,
+                SDL_TEXTUREACCESS_TARGET,               // Render to this texture
+                w, h);
+        // Set up game art texture for blending to draw on transparent background.
+        if(SDL_SetTextureBlendMode(t.tex, SDL_BLENDMODE_BLEND) < 0)
+        { // Texture blending is not supported
+            puts("Cannot set texture to blendmode blend.");
+            destroy(t);
+            return false;
+        }
+    }
+    if (GameDemo::STROKE_CURVES)
+    { // Create a streaming texture for the software-rasterized strokes
+        t.stroke_tex = SDL_CreateTexture(r, native.format,
+                SDL_TEXTUREACCESS_STREAMING,            // Copy CPU pixels to this texture
+                w, h);
+        SDL_SetTextureBlendMode(t.stroke_tex, SDL_BLENDMODE_BLEND);
+        Raster::alloc(t.strokes, w, h, native.format);
+        // Start transparent (after this, only the area that changes is uploaded)
+        SDL_UpdateTexture(t.stroke_tex, NULL, t.strokes.pixels, sizeof(Uint32)*w);
+    }
+    return true;
+}
+
+void GameArt::destroy(Target& t)
+{ // Textures before the renderer that made them
+    if (GameDemo::STROKE_CURVES)
+    {
+        if (t.stroke_tex != NULL) SDL_DestroyTexture(t.stroke_tex);
+        if (t.strokes.pixels != NULL) Raster::release(t.strokes);
+    }
+    if (t.tex != NULL) SDL_DestroyTexture(t.tex);
+    if (t.ren != NULL) SDL_DestroyRenderer(t.ren);
+    if (t.surface != NULL) SDL_FreeSurface(t.surface);
+    if (current == &t) current = NULL;
+    t = Target{};
+}
+
+void GameArt::release_pool(void)
+{
+    if (current != NULL) current->strokes = strokes;
+    for (Target& t : pool) if (t.w > 0) destroy(t);
+    tex = NULL; surface = NULL; stroke_tex = NULL; strokes = Raster::Canvas{};
+}
+
 void shutdown(void)
 {
-    SDL_DestroyTexture(GameArt::tex);
-    SDL_DestroyRenderer(ren);
+    GameArt::release_pool();                            // (CPU_PRESENT: ren is one of the pool's)
+    if (!GameDemo::CPU_PRESENT) SDL_DestroyRenderer(ren);
     SDL_DestroyWindow(win);
     SDL_Quit();
 }
@@ -130,6 +346,410 @@ void shutdown(void)
 ///////////////
 // GAME GLOBALS
 ///////////////
+namespace BezierCurves
+{
+    constexpr int ORDER = 2;                    // 2nd-order dCB curve
+    constexpr int NC = ORDER+1;                 // 'N'umber of 'C'ontrol points
+    constexpr int K = 128;                      // Sample curve at K points
+    // Define Bmatrix: evaluate the three Bernstein λ-Polynomials at all K values of λ
+    // Make Bmatrix global and only calculate this once!
+    float B0[K]{}; float B1[K]{}; float B2[K]{}; // Zero-initialize the Bmatrix
+    float* Bmatrix[NC] = {B0,B1,B2};            // Bmatrix is size (NC rows x K cols)
+    // Define dBmatrix: evaluate the derivative (hodograph) of each Bernstein polynomial
+    // at the same K values of λ. Also only calculate this once!
+    float dB0[K]{}; float dB1[K]{}; float dB2[K]{};
+    float* dBmatrix[NC] = {dB0,dB1,dB2};        // dBmatrix is size (NC rows x K cols)
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    void calc_Bmatrix(void);                    // Bmatrix never changes! Call this once (during setup).
+    void calc_Bmatrix(float* const*, int);      // Fill any (NC rows x k cols) table with B(λ=i/k)
+    void calc_rational_Bmatrix(float* const*, int, const float*); // Fold weights into the table
+    void calc_dBmatrix(void);                   // dBmatrix never changes either. Call once.
+    void dCB_curve_points(SDL_FPoint*, SDL_FPoint*); // Calc points on dCB curve using Bmatrix
+    void dCB_curve_points(const SDL_FPoint*, float* const*, int, SDL_FPoint*); // Same, any table
+    void dCB_curve_points(const SDL_FPoint*, SDL_FPoint*, SDL_FPoint*, SDL_FPoint*); // + tangents, normals
+    SDL_FRect dCB_box(const SDL_FPoint*);       // Tight bounding box of a dCB curve
+}
+
+void BezierCurves::calc_Bmatrix(void)
+{ // Calculate B = P*T for the K-point curve table
+    calc_Bmatrix(Bmatrix, K);
+}
+
+void BezierCurves::calc_Bmatrix(float* const* B, int k)
+{ // Calculate B = P*T for a table with k columns: λ = i/k for i in [0:k)
+    // Define Pmatrix: matrix of degree 2 Bernstein λ-Polynomial Coefficients
+    constexpr float B_02[NC] = {1, -2,  1}; // 1 - 2λ +  λ^2
+    constexpr float B_12[NC] = {0,  2, -2}; // 0 + 2λ - 2λ^2
+    constexpr float B_22[NC] = {0,  0,  1}; // 0 + 0λ +  λ^2
+    const float* Pmatrix[NC] = {B_02,B_12,B_22};
+    // Tmatrix is (NC rows x k cols). Each column is {λ^0, λ^1, λ^2}, so just make
+    // the column when I need it instead of storing the whole thing.
+    for (int c=0; c<k; c++)                         // c : column of Tmatrix
+    { // Iterate over columns of Tmatrix
+        float t = static_cast<float>(c)/static_cast<float>(k);
+        float Tcol[NC] = {1, t, t*t};               // λ^0, λ^1, λ^2
+        for (int i=0; i<NC; i++)                    // i : row of Pmatrix
+        { // Find entry Bic = Pi0*T0c + Pi1*T1c + Pi2*T2c
+            B[i][c] = 0;
+            for (int j=0; j<NC; j++)                // j : walk ith row of P and cth col of T
+            {
+                B[i][c] += Pmatrix[i][j]*Tcol[j];
+            }
+        }
+    }
+}
+
+void BezierCurves::calc_dBmatrix(void)
+{ // Calculate dB = dP*T : the hodograph table
+    /* *************DOC***************
+     * The tangent to the curve is the derivative with respect to λ. Control points
+     * do not depend on λ, so just take the derivative of the Bernstein polynomials:
+     *
+     *      d/dλ (1 - 2λ +  λ^2) = -2 + 2λ
+     *      d/dλ (0 + 2λ - 2λ^2) =  2 - 4λ
+     *      d/dλ (0 + 0λ +  λ^2) =  0 + 2λ
+     *
+     * Same matrix multiplication as the Bmatrix, just a different Pmatrix. Then
+     * the tangent at every λ is {P0,P1,P2} x dB, just like the points are
+     * {P0,P1,P2} x B. No finite differences between neighboring points!
+     *
+     * (The tangent of a quadratic dCB curve is itself a 1st-order dCB curve with
+     * control points 2*(P1-P0) and 2*(P2-P1). That's the hodograph.)
+     * *******************************/
+    // Define dPmatrix: coefficients of the derivatives of the Bernstein λ-Polynomials
+    constexpr float dB_02[NC] = {-2,  2,  0};   // -2 + 2λ
+    constexpr float dB_12[NC] = { 2, -4,  0};   //  2 - 4λ
+    constexpr float dB_22[NC] = { 0,  2,  0};   //  0 + 2λ
+    const float* dPmatrix[NC] = {dB_02,dB_12,dB_22};
+    for (int c=0; c<K; c++)                         // c : column of Tmatrix
+    {
+        float t = static_cast<float>(c)/static_cast<float>(K);
+        float Tcol[NC] = {1, t, t*t};               // λ^0, λ^1, λ^2
+        for (int i=0; i<NC; i++)                    // i : row of dPmatrix
+        {
+            dBmatrix[i][c] = 0;
+            for (int j=0; j<NC; j++)
+            {
+                dBmatrix[i][c] += dPmatrix[i][j]*Tcol[j];
+            }
+        }
+    }
+}
+
+void BezierCurves::calc_rational_Bmatrix(float* const* R, int k, const float* weights)
+{ // Calculate the homogeneous Bmatrix for a weighted (rational) dCB curve
+    /* *************DOC***************
+     * A rational dCB curve gives each control point a weight w. Do the usual dCB
+     * curve in homogeneous coordinates [w*x, w*y, w], then divide by the third
+     * coordinate to get back to the plane:
+     *
+     *      ------------------------------------------------
+     *      |          w0*B0*P0 + w1*B1*P1 + w2*B2*P2      |
+     *      | R(λ) = --------------------------------      |
+     *      |               w0*B0 + w1*B1 + w2*B2          |
+     *      ------------------------------------------------
+     *
+     * If the weights never change, the division does not depend on the control
+     * points either! So fold the weights AND the division into the table:
+     *
+     *      Rj(λ) = wj*Bj(λ) / (w0*B0(λ) + w1*B1(λ) + w2*B2(λ))
+     *
+     * Then a rational curve is the exact same matrix multiplication as a plain
+     * dCB curve: {P0,P1,P2} x R = curve. Same evaluator, different table.
+     *
+     * Weights {1,1,1} give back the plain Bmatrix. Weights {1,1,2} with
+     * control points {[1,0],[1,1],[0,1]} give the RatCircle quarter circle.
+     *
+     * Parameters
+     * ----------
+     * R : (NC rows x k cols) table to fill
+     * k : int
+     *      number of samples, λ = i/k for i in [0:k)
+     * weights : NC floats
+     *      weight of each control point (keep them positive)
+     * *******************************/
+    calc_Bmatrix(R, k);                             // Start with the plain Bmatrix
+    for (int c=0; c<k; c++)                         // c : column of R
+    { // Weight the column, then divide it by its homogeneous coordinate
+        float w = 0;
+        for (int j=0; j<NC; j++) w += weights[j]*R[j][c];
+        for (int j=0; j<NC; j++) R[j][c] *= weights[j]/w;
+    }
+}
+
+void BezierCurves::dCB_curve_points(SDL_FPoint* control_points, SDL_FPoint* points)
+{ // Calculate K dCB curve points
+    dCB_curve_points(control_points, Bmatrix, K, points);
+}
+
+void BezierCurves::dCB_curve_points(const SDL_FPoint* control_points, float* const* B, int k, SDL_FPoint* points)
+{ // Calculate k dCB curve points using table B (plain Bmatrix or rational Bmatrix)
+    // Matrix multiplication: control_points x B
+    //                    (1 rows x NC cols) x (NC rows x k cols)
+    //                            {P0,P1,P2} x B = curve
+    for (int c=0; c<k; c++)                 // c : column of B matrix
+    { // Iterate over columns of B
+        points[c]=SDL_FPoint{0,0};          // Clear out old value for cth point on dCB curve
+        for (int j=0; j<NC; j++)            // j : walk control points and walk the cth col of B
+        { // Find cth point = control_points[j]*B[j][c]
+            points[c].x += control_points[j].x*B[j][c];
+            points[c].y += control_points[j].y*B[j][c];
+        }
+    }
+}
+
+void BezierCurves::dCB_curve_points(const SDL_FPoint* control_points, SDL_FPoint* points,
+        SDL_FPoint* tangents, SDL_FPoint* normals)
+{ // Calculate K dCB curve points, tangents, and unit normals in one pass
+    /* *************DOC***************
+     * Same as dCB_curve_points(control_points, points), plus:
+     *
+     * tangents : K points
+     *      {P0,P1,P2} x dBmatrix : velocity of the curve point as λ increases
+     *      (length is NOT normalized -- length is useful for speed and curvature)
+     * normals : K points
+     *      tangent rotated a quarter turn [x,y] -> [-y,x], normalized to length 1
+     *      (a zero tangent gives a zero normal)
+     *
+     * Call calc_Bmatrix() and calc_dBmatrix() once during setup.
+     * *******************************/
+    for (int k=0; k<K; k++)                 // k : column of Bmatrix and dBmatrix
+    {
+        float x=0; float y=0; float tx=0; float ty=0;
+        for (int j=0; j<NC; j++)
+        {
+            x  += control_points[j].x*Bmatrix[j][k];
+            y  += control_points[j].y*Bmatrix[j][k];
+            tx += control_points[j].x*dBmatrix[j][k];
+            ty += control_points[j].y*dBmatrix[j][k];
+        }
+        float inv_len = FastMath::rsqrt(tx*tx + ty*ty);
+        points[k]   = SDL_FPoint{.x=x, .y=y};
+        tangents[k] = SDL_FPoint{.x=tx, .y=ty};
+        normals[k]  = SDL_FPoint{.x=-ty*inv_len, .y=tx*inv_len};
+    }
+}
+
+SDL_FRect BezierCurves::dCB_box(const SDL_FPoint* control_points)
+{ // Smallest box around the dCB curve (not just around the control points)
+    /* *************DOC***************
+     * The curve starts at P0 and ends at P2, but it does not reach P1. Boxing
+     * the three control points works (the curve stays in their triangle), but
+     * the box is too big when P1 is far out.
+     *
+     * Instead, box the two ends plus the turning point of each coordinate. The
+     * x coordinate of the curve is a quadratic in λ, so its derivative
+     *
+     *      dx/dλ = 2*(1-λ)*(x1-x0) + 2*λ*(x2-x1)
+     *
+     * is zero at λ = (x0-x1)/(x0-2*x1+x2). If that λ is on the curve (between
+     * 0 and 1), that's where x turns around. Same for y.
+     * *******************************/
+    float lo[2]; float hi[2];
+    for (int axis=0; axis<2; axis++)
+    {
+        float c0 = (axis==0) ? control_points[0].x : control_points[0].y;
+        float c1 = (axis==0) ? control_points[1].x : control_points[1].y;
+        float c2 = (axis==0) ? control_points[2].x : control_points[2].y;
+        lo[axis] = std::min(c0, c2); hi[axis] = std::max(c0, c2);
+        float den = c0 - 2*c1 + c2;
+        if (den != 0)
+        {
+            float t = (c0 - c1)/den;
+            if ((t > 0) && (t < 1))
+            { // Turning point is on the curve
+                float v = (1-t)*(1-t)*c0 + 2*t*(1-t)*c1 + t*t*c2;
+                lo[axis] = std::min(lo[axis], v); hi[axis] = std::max(hi[axis], v);
+            }
+        }
+    }
+    return SDL_FRect{.x=lo[0], .y=lo[1], .w=hi[0]-lo[0], .h=hi[1]-lo[1]};
+}
+
+namespace Curves
+{ // Pool of quadratic dCB curves: physics, picking, and rendering all see the same curves
+    constexpr int MAX_CURVES = 1<<14;                   // Pool size
+    constexpr int NCURVES = 1<<3;                       // Curves spawned at startup (try 1<<13)
+    float pick_radius(void) { return GameArt::scale/8.0f; }  // Mouse reach in game art pixels
+    float max_speed(void) { return GameArt::scale/40.0f; }   // CURVE_HITS: curve pixels per frame
+    int count;                                          // Curves in the pool
+
+    // Control points are structure-of-arrays: X[j][i] is the x of control point j of curve i.
+    // Picking loops over every curve, so keep each coordinate contiguous.
+    float X0[MAX_CURVES]; float X1[MAX_CURVES]; float X2[MAX_CURVES];
+    float Y0[MAX_CURVES]; float Y1[MAX_CURVES]; float Y2[MAX_CURVES];
+    float* X[BezierCurves::NC] = {X0,X1,X2};
+    float* Y[BezierCurves::NC] = {Y0,Y1,Y2};
+    SDL_FRect boxes[MAX_CURVES];                        // Bounding box of each curve
+    int scratch[MAX_CURVES];                            // Picking scratch: curves that survive the cull
+    // Velocity of each curve (GameDemo::CURVE_HITS slides the curves around)
+    float VX[MAX_CURVES]; float VY[MAX_CURVES];
+
+    // Where curves cross (GameDemo::CURVE_HITS)
+    constexpr float HIT_TOL = 0.01;                     // Crossing accuracy in game art pixels
+    constexpr int MAX_PAIRS = 1<<18;                    // Overlapping boxes per frame
+    constexpr int MAX_HITS = 1<<14;                     // Crossings per frame
+    // Broad phase boxes: box 0 is the Blob, box 1+i is curve i. The Blob stays box 0 as curves
+    // get added, so the edges the Sweep sorted last frame still belong to the same things.
+    SDL_FRect objects[1+MAX_CURVES];
+    Broadphase::Sweep sweep;                            // Box edges, kept sorted frame to frame
+    Broadphase::Pair pairs[MAX_PAIRS]; int npairs;      // Boxes that overlap (indices into objects)
+    int nblob;                                          // Pairs that are the Blob and a curve
+    Intersect::Hit hits[MAX_HITS]; int nhits;           // Crossings
+    // Narrow phase on the job pool: chunk c of the pairs writes its crossings to chunk_hits[c],
+    // then they are copied into hits in chunk order (same order as one thread would find them)
+    constexpr int CHUNK_PAIRS = 256;                    // Pairs per chunk
+    constexpr int CHUNK_HITS = 256;                     // Crossings room per chunk (a chunk that finds more drops the rest)
+    constexpr int MAX_CHUNKS = MAX_PAIRS/CHUNK_PAIRS;
+    Intersect::Hit chunk_hits[MAX_CHUNKS][CHUNK_HITS];
+    int chunk_nhits[MAX_CHUNKS]; int chunk_nblob[MAX_CHUNKS];
+
+    struct Grab
+    { // What the mouse is dragging
+        int curve;                                      // -1 : nothing
+        int point;                                      // Control point 0,1,2 or -1 : the whole curve
+        SDL_FPoint last;                                // Mouse position last frame
+    };
+
+    ////////////
+    // FUNCTIONS
+    ////////////
+    int add(const SDL_FPoint* control_points);          // Add a curve, return its index
+    void get(int i, SDL_FPoint* control_points);        // Copy out the NC control points of curve i
+    void set(int i, int j, SDL_FPoint p);               // Move control point j of curve i to p
+    void move(int i, SDL_FPoint delta);                 // Move all of curve i by delta
+    void calc_box(int i);                               // Update the bounding box of curve i
+    void rescale(float k);                              // Game art scale changed: every curve k times bigger
+    void animate(int skip);                             // Slide every curve (except curve skip)
+    void find_pairs(const SDL_FRect& blob);             // Broad phase: boxes that overlap
+    void find_hits(Jobs::Pool&);                        // Narrow phase: where those curves cross (pairs split across jobs)
+    Pick::Hit nearest_control_point(SDL_FPoint p, int* which); // Over every curve in the pool
+}
+
+int Curves::add(const SDL_FPoint* control_points)
+{
+    assert(count < MAX_CURVES);
+    int i = count++;
+    for (int j=0; j<BezierCurves::NC; j++)
+    {
+        X[j][i] = control_points[j].x;
+        Y[j][i] = control_points[j].y;
+    }
+    VX[i] = 0; VY[i] = 0;                               // Curves sit still unless told otherwise
+    calc_box(i);
+    return i;
+}
+
+void Curves::get(int i, SDL_FPoint* control_points)
+{
+    for (int j=0; j<BezierCurves::NC; j++)
+    {
+        control_points[j] = SDL_FPoint{.x=X[j][i], .y=Y[j][i]};
+    }
+}
+
+void Curves::set(int i, int j, SDL_FPoint p)
+{
+    X[j][i] = p.x; Y[j][i] = p.y;
+    calc_box(i);
+}
+
+void Curves::move(int i, SDL_FPoint delta)
+{
+    for (int j=0; j<BezierCurves::NC; j++)
+    {
+        X[j][i] += delta.x; Y[j][i] += delta.y;
+    }
+    calc_box(i);
+}
+
+void Curves::calc_box(int i)
+{ // Picking culls with these boxes, so keep them tight
+    SDL_FPoint control_points[BezierCurves::NC];
+    get(i, control_points);
+    boxes[i] = BezierCurves::dCB_box(control_points);
+}
+
+void Curves::rescale(float k)
+{ // Control points and velocities scale about the game art origin (the broad phase keeps up on its own)
+    for (int i=0; i<count; i++)
+    {
+        for (int j=0; j<BezierCurves::NC; j++) { X[j][i] *= k; Y[j][i] *= k; }
+        VX[i] *= k; VY[i] *= k;
+        calc_box(i);
+    }
+}
+
+void Curves::animate(int skip)
+{ // Curves slide at their velocity and bounce off the edges of the world
+    const float W = static_cast<float>(GameArt::world.w);
+    const float H = static_cast<float>(GameArt::world.h);
+    for (int i=0; i<count; i++)
+    {
+        if (i == skip) continue;                        // The mouse is holding this one
+        move(i, SDL_FPoint{.x=VX[i], .y=VY[i]});        // (Also updates the box)
+        const SDL_FRect& b = boxes[i];
+        // Point the velocity back inside (not just flip it: a curve dragged off the edge
+        // would flip every frame and get stuck)
+        if (b.x < 0)       VX[i] =  std::fabs(VX[i]);
+        if (b.x + b.w > W) VX[i] = -std::fabs(VX[i]);
+        if (b.y < 0)       VY[i] =  std::fabs(VY[i]);
+        if (b.y + b.h > H) VY[i] = -std::fabs(VY[i]);
+    }
+}
+
+void Curves::find_pairs(const SDL_FRect& blob)
+{ // Which pairs of boxes overlap? (incremental sweep and prune, not all pairs)
+    objects[0] = blob;
+    memcpy(&objects[1], boxes, sizeof(SDL_FRect)*count);
+    npairs = Broadphase::update(sweep, objects, 1+count, pairs, MAX_PAIRS);
+}
+
+void Curves::find_hits(Jobs::Pool& pool)
+{ // Where do the curves in the overlapping pairs actually cross?
+    const int nchunks = (npairs + CHUNK_PAIRS-1)/CHUNK_PAIRS;
+    // Every pair is its own problem: chunks of pairs go to whichever thread is free
+    Jobs::parallel_for(pool, nchunks, 1, [](int begin, int end)
+    {
+        for (int c=begin; c<end; c++)
+        {
+            int n = 0; int blob = 0;
+            const int last = std::min((c+1)*CHUNK_PAIRS, npairs);
+            for (int k=c*CHUNK_PAIRS; k<last; k++)
+            {
+                if (pairs[k].a == 0) { blob++; continue; }  // The Blob is not a curve (a < b, so a is box 0)
+                SDL_FPoint a[BezierCurves::NC]; SDL_FPoint b[BezierCurves::NC];
+                get(pairs[k].a-1, a); get(pairs[k].b-1, b);
+                n += Intersect::dCB_dCB(a, b, HIT_TOL, &chunk_hits[c][n], CHUNK_HITS-n);
+            }
+            chunk_nhits[c] = n; chunk_nblob[c] = blob;
+        }
+    });
+    // Merge the chunks
+    nhits = 0; nblob = 0;
+    for (int c=0; c<nchunks; c++)
+    {
+        const int n = std::min(chunk_nhits[c], MAX_HITS-nhits);
+        memcpy(&hits[nhits], chunk_hits[c], sizeof(Intersect::Hit)*n);
+        nhits += n; nblob += chunk_nblob[c];
+    }
+}
+
+Pick::Hit Curves::nearest_control_point(SDL_FPoint p, int* which)
+{ // Nearest control point of any curve to p; which is set to the control point (0,1,2)
+    Pick::Hit hit = {.index=-1, .lambda=0, .d2=INFINITY};
+    *which = -1;
+    for (int j=0; j<BezierCurves::NC; j++)
+    { // One pass over each row: contiguous floats, no branches in the inner loop
+        Pick::Hit row = Pick::nearest_point(X[j], Y[j], count, p);
+        if (row.d2 < hit.d2) { hit = row; *which = j; }
+    }
+    return hit;
+}
+
 namespace RatCircle
 {
     ////////////////////////////////////////////
@@ -139,10 +759,31 @@ namespace RatCircle
     /////////////
     // GAME STATE
     /////////////
-    // TODO: work out the weird periodic aliasing effects and the rules for "good" numbers
+    // Periodic aliasing: see "Where spinner aliasing comes from" (mg_alias.h), and rank other
+    // numbers with `make alias`. COUNT = 4*127 = 508 ties for best of every COUNT from 4 to 2048
+    // over speeds 1-31: N is prime, so only speeds with a factor of 2 or 4 skip points.
     constexpr uint16_t MAX_NUM_POINTS = (1<<9)-3;       // Max points in circle
     constexpr uint16_t MAX_SPEED = MAX_NUM_POINTS/(1<<4);   // Max counter increments per video frame
 
+    ////////////////////////////////
+    // QUARTER CIRCLE AS A dCB CURVE
+    ////////////////////////////////
+    // The rational parametrization x(t),y(t) below is a rational quadratic dCB curve:
+    //      denominator: 1*(1-t)^2 + 1*2t(1-t) + 2*t^2 = 1+t*t
+    //      x numerator: 1*(1-t)^2 + 1*2t(1-t)         = 1-t*t
+    //      y numerator:             1*2t(1-t) + 2*t^2 = 2*t
+    // So the quarter circle comes out of the same curve engine as the dCB curves.
+    constexpr SDL_FPoint QUARTER[BezierCurves::NC] = {{1,0},{1,1},{0,1}}; // Control points
+    constexpr float WEIGHTS[BezierCurves::NC] = {1,1,2};                  // Control point weights
+    constexpr int QN = MAX_NUM_POINTS/(1<<2);           // Spinner N points in a quarter circle
+    // Rational Bmatrix for the quarter circle sampled at t = i/QN. Calculate this once!
+    float Q0[QN]{}; float Q1[QN]{}; float Q2[QN]{};
+    float* Qmatrix[BezierCurves::NC] = {Q0,Q1,Q2};    // Qmatrix is size (NC rows x QN cols)
+    // Every spinner with N=QN has this same unit circle, scaled by its RADIUS. Calculate it once
+    // (after Qmatrix): then spawning a spinner is a scaled copy, not a curve and three rotations.
+    SDL_FPoint UNIT[4*QN]{};
+    void calc_unit_circle(void);
+
     /////////////////
     // PURE FUNCTIONS
     /////////////////
@@ -188,13 +829,22 @@ namespace RatCircle
         float t = static_cast<float>(n)/static_cast<float>(d);
         return (2*t)/(1+(t*t));
     }
+    void calc_unit_circle(void)
+    { // Quarter circle from the Qmatrix, then the other three quarters (exact: x=-y, y=x)
+        BezierCurves::dCB_curve_points(QUARTER, Qmatrix, QN, UNIT);
+        const RatGeom::Rotation quarter = RatGeom::rotation(RatGeom::QUARTER_TURN);
+        for(int q=1; q<4; q++)
+        {
+            RatGeom::rotate(quarter, &UNIT[(q-1)*QN], &UNIT[q*QN], QN, SDL_FPoint{0,0});
+        }
+    }
 
     struct Spinner
     { // Dots that spin around the rational parametrized circle
         /////////////
         // GAME STATE
         /////////////
-        SDL_FPoint* points;                 // Array of points in circle
+        SDL_FPoint* points;                 // Array of points in circle (relative to the center)
         uint16_t counter;                   // counter : cycle through points in circle, phase = counter%COUNT
         uint16_t speed;                     // Counter increments per video frame; controlled by j/k
         int N, COUNT;                       // N points in a quarter circle, COUNT is 4*N
@@ -233,26 +883,34 @@ namespace RatCircle
     }
     void Spinner::calc_circle_points(void)
     { // Write to array of rational points: 4*N in full circle
+        // Scale the circle of points (NOT offset: the center moves when the spinners flock,
+        // so the center gets added when the points are drawn)
+        if (N == QN)
+        { // Usual case: the unit circle is pre-computed (see calc_unit_circle)
+            for(int i=0; i<COUNT; i++)
+            {
+                points[i] = SDL_FPoint{.x = RADIUS*UNIT[i].x, .y = RADIUS*UNIT[i].y};
+            }
+            return;
+        }
         // Make a quarter circle
         for(int i=0; i<N; i++)
-        {
+        { // N changed (see increase_resolution): no table for this N
             // Express parameter t as an integer ratio
             int n=i; int d=N;                       // t = n/d
             // Calculate point [x(t), y(t)]
             points[i] = SDL_FPoint{.x=x(n,d), .y=y(n,d)};
         }
         // Make the other three-quarters of the circle
-        for(int i=N; i<COUNT; i++)
+        // Each quarter is the quarter before it, rotated a quarter-circle (exact: x=-y, y=x)
+        const RatGeom::Rotation quarter = RatGeom::rotation(RatGeom::QUARTER_TURN);
+        for(int q=1; q<4; q++)
         {
-            // Next point is the point N indices back, rotated a quarter-circle
-            points[i] = SDL_FPoint{.x=-1*points[i-N].y, .y=points[i-N].x};
+            RatGeom::rotate(quarter, &points[(q-1)*N], &points[q*N], N, SDL_FPoint{0,0});
         }
-        // Offset and scale the circle of points
         for(int i=0; i<COUNT; i++)
         {
-            points[i] = SDL_FPoint{
-                .x = (RADIUS*points[i].x) + center_x,
-                .y = (RADIUS*points[i].y) + center_y };
+            points[i] = SDL_FPoint{.x = RADIUS*points[i].x, .y = RADIUS*points[i].y};
         }
     }
     ///////////////////////////////////////
@@ -298,79 +956,12 @@ namespace Blob
     constexpr int FULL = N*4;                           // Num points in full-circle
     SDL_FPoint* points;                                 // The jiggly circle points
     SDL_FPoint* points_debug;                           // Circle points without jiggle
-}
-
-namespace BezierCurves
-{
-    constexpr int ORDER = 2;                    // 2nd-order dCB curve
-    constexpr int NC = ORDER+1;                 // 'N'umber of 'C'ontrol points
-    constexpr int K = 128;                      // Sample curve at K points
-    // Define Bmatrix: evaluate the three Bernstein λ-Polynomials at all K values of λ
-    // Make Bmatrix global and only calculate this once!
-    float B0[K]{}; float B1[K]{}; float B2[K]{}; // Zero-initialize the Bmatrix
-    float* Bmatrix[NC] = {B0,B1,B2};            // Bmatrix is size (NC rows x K cols)
-
-    ////////////
-    // FUNCTIONS
-    ////////////
-    void calc_Bmatrix(void);                    // Bmatrix never changes! Call this once (during setup).
-    void dCB_curve_points(SDL_FPoint*, SDL_FPoint*); // Calc points on dCB curve using Bmatrix
-}
-
-void BezierCurves::calc_Bmatrix(void)
-{ // Calculate B = P*T
-    // Define Pmatrix: matrix of degree 2 Bernstein λ-Polynomial Coefficients
-    constexpr float B_02[NC] = {1, -2,  1}; // 1 - 2λ +  λ^2
-    constexpr float B_12[NC] = {0,  2, -2}; // 0 + 2λ - 2λ^2
-    constexpr float B_22[NC] = {0,  0,  1}; // 0 + 0λ +  λ^2
-    const float* Pmatrix[NC] = {B_02,B_12,B_22};
-    // Define Tmatrix: matrix of K values for each power of λ
-    float T_0[K];                               // λ^0
-    for (int i=0; i<K; i++)
-    {
-        T_0[i] = 1;
-    }
-    float T_1[K];                               // λ^1
-    for (int i=0; i<K; i++)
-    {
-        float t = static_cast<float>(i)/static_cast<float>(K);
-        T_1[i] = t;
-    }
-    float T_2[K];                               // λ^2
-    for (int i=0; i<K; i++)
-    {
-        float t = static_cast<float>(i)/static_cast<float>(K);
-        T_2[i] = t*t;
-    }
-    float* Tmatrix[NC] = {T_0, T_1, T_2};     // Tmatrix is size (NC rows x K cols)
-    { // Matrix multiplication: P * T = B     // (NC rows x NC cols) x (NC rows x K cols)
-        for (int i=0; i<NC; i++)                    // i : row of Pmatrix
-        { // Iterate over rows of Pmatrix
-            for (int k=0; k<K; k++)                 // k : column of Tmatrix
-            { // For each row of Pmatrix, iterate over columns of Tmatrix
-                for (int j=0; j<NC; j++)            // j : walk ith row of P and kth col of T
-                { // Find entry Bik = Pi0*T0k + Pi1*T1k + Pi2*T2k
-                    Bmatrix[i][k] += Pmatrix[i][j]*Tmatrix[j][k];
-                }
-            }
-        }
-    }
-}
-
-void BezierCurves::dCB_curve_points(SDL_FPoint* control_points, SDL_FPoint* points)
-{ // Calculate K dCB curve points
-    // Matrix multiplication: control_points x Bmatrix
-    //                    (1 rows x NC cols) x (NC rows x K cols)
-    //                            {P0,P1,P2} x B = curve
-    for (int k=0; k<K; k++)                 // k : column of B matrix
-    { // Iterate over columns of Bmatrix
-        points[k]=SDL_FPoint{0,0};          // Clear out old value for kth point on dCB curve
-        for (int j=0; j<NC; j++)            // j : walk control points and walk the kth col of B
-        { // Find kth point = control_points[j]*B[j][k]
-            points[k].x += control_points[j].x*Bmatrix[j][k];
-            points[k].y += control_points[j].y*Bmatrix[j][k];
-        }
-    }
+    // Rational Bmatrix for the Blob quarter circle (see RatCircle::QUARTER)
+    float Q0[N]{}; float Q1[N]{}; float Q2[N]{};
+    float* Qmatrix[BezierCurves::NC] = {Q0,Q1,Q2};    // Qmatrix is size (NC rows x N cols)
+    // GameDemo::BLOB_SPIN: the Blob spins by a rational turn every frame (no sin or cos)
+    const RatGeom::Rotation SPIN = RatGeom::rotation(RatGeom::turn(1,64)); // About 1.8 degrees per frame
+    RatGeom::Rotation heading = RatGeom::rotation(RatGeom::NO_TURN);       // Spin so far
 }
 
 ///////
@@ -382,35 +973,114 @@ int main(int argc, char* argv[])
     ////////
     // SETUP
     ////////
+    /* *************Startup***************
+     * Target: the first frame on screen in under 50 ms. The startup Timeline
+     * says where the time goes (DEBUG prints it after the first frame).
+     *
+     *      - SDL makes the window and the renderer (tens of ms, mostly the
+     *        driver). Meanwhile a setup thread builds the curve tables and
+     *        spawns the spinners (that takes no SDL, just the world size).
+     *        Its span is on the timeline next to SDL's phases: if "wait for
+     *        setup thread" is not ~0, the setup thread is the long pole.
+     *      - Only the video subsystem is started. The sound device (it can
+     *        take as long as the renderer) is opened after the first frame:
+     *        nothing is heard before then anyway. See Audio::open.
+     * *******************************/
+    Stopwatch::Timeline startup;                        // Startup phases (clock starts here)
 
     std::srand(std::time(0));                           // Seed RNG with current time
     WindowInfo wI(argc, argv);
     if (DEBUG) printf("Window info: %d x %d at %d,%d\n", wI.w, wI.h, wI.x, wI.y);
     if (DEBUG) printf("Number of colors in palette: %d\n", (int)(sizeof(Colors::list)/sizeof(SDL_Color)));
+
+    // RAT_CIRCLE demo -- spinners (spawned on the setup thread, see Startup)
+    // NSPIN: Number of spinners on screen
+    constexpr int NSPIN = 1<<12;                        // Max on my 32GB Linux desktop
+    /* constexpr int NSPIN = 1<<9;                         // Max on my 8GB Windows laptop: */
+    RatCircle::Spinner *spinners[NSPIN];                // Just a giant array of pointers
+    struct Spawn { float x, y; uint8_t r; uint16_t s, p; }; // Where and how each spinner starts
+    Spawn* spawns = NULL;                               // (Picked here: std::rand stays on this thread)
+    if (GameDemo::RAT_CIRCLE)
+    {
+        SDL_FRect border;
+        { // Spawn spinners within this border (all over the world)
+            const SDL_Rect world = GameArt::world_at(GameArt::scale);
+            float W = static_cast<float>(world.w);
+            float H = static_cast<float>(world.h);
+            float M = 0.01*W;                           // M : Margin in pixels
+            border = {.x=M, .y=M, .w=W-2*M, .h=H-2*M};
+        }
+        spawns = (Spawn*)malloc(sizeof(Spawn)*NSPIN);
+        for(int i=0; i<NSPIN; i++)
+        { // Randowm spawn a bunch of spinners
+            Spawn& sp = spawns[i];
+            // Spawn within the border
+            sp.x = (static_cast<float>(std::rand()) * (border.w-3)) / RAND_MAX + (border.x+1);
+            sp.y = (static_cast<float>(std::rand()) * (border.h-3)) / RAND_MAX + (border.y+1);
+            // Start off with a radius between 2 and 64
+            sp.r = (std::rand() % 62)+ 2;
+            // Start off with a random speed between 1 and 11
+            sp.s = (std::rand() % 10)+1; // Initial speed
+            sp.p = std::rand() % RatCircle::MAX_NUM_POINTS; // Initial phase
+        }
+    }
+    startup.mark("args, spawn points");
+    Stopwatch::Clock::time_point setup_start, setup_end; // Setup thread's span
+    std::thread setup([&](void)
+    { // Tables and spinners: no SDL calls in here
+        setup_start = Stopwatch::Clock::now();
+        if (GameDemo::RAT_CIRCLE)
+        { // Pre-compute the circle tables BEFORE spawning (spawning copies the unit circle)
+            BezierCurves::calc_rational_Bmatrix(RatCircle::Qmatrix, RatCircle::QN, RatCircle::WEIGHTS);
+            RatCircle::calc_unit_circle();
+            for(int i=0; i<NSPIN; i++)
+            {
+                const Spawn& sp = spawns[i];
+                spinners[i] = new RatCircle::Spinner(sp.x, sp.y, sp.r, sp.s, sp.p);
+            }
+        }
+        if (GameDemo::BLOB)
+        { // Pre-compute the quarter circle table
+            BezierCurves::calc_rational_Bmatrix(Blob::Qmatrix, Blob::N, RatCircle::WEIGHTS);
+        }
+        if (GameDemo::GEN_CURVE || GameDemo::FIT_CURVE)
+        { // The B matrix is constant if K (number of desired points) is constant: compute it once
+            BezierCurves::calc_Bmatrix();               // Pre-compute the B matrix
+            BezierCurves::calc_dBmatrix();              // Pre-compute the derivative B matrix
+        }
+        setup_end = Stopwatch::Clock::now();
+    });
     { // SDL Setup
-        SDL_Init(SDL_INIT_VIDEO|SDL_INIT_AUDIO);
+        SDL_Init(SDL_INIT_VIDEO);                       // (Audio starts later, when the sound opens)
+        startup.mark("SDL_Init (video)");
         win = SDL_CreateWindow(argv[0], wI.x, wI.y, wI.w, wI.h, wI.flags);
-        Uint32 ren_flags = 0;
-        ren_flags |= SDL_RENDERER_PRESENTVSYNC;         // 60 fps! No SDL_Delay()
-        ren_flags |= SDL_RENDERER_ACCELERATED;          // Hardware acceleration
-        ren = SDL_CreateRenderer(win, -1, ren_flags);
-
-        // Set up transparency blending for a transparent heads-up overlay.
-        // Just this line is enough to start using the alpha channel on my overlay.
-        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND); // Draw with alpha
+        startup.mark("window");
+        if (!GameDemo::CPU_PRESENT)
+        { // (CPU_PRESENT: each game art surface gets its own software renderer, see GameArt::make)
+            Uint32 ren_flags = 0;
+            ren_flags |= SDL_RENDERER_PRESENTVSYNC;     // 60 fps! No SDL_Delay()
+            ren_flags |= SDL_RENDERER_ACCELERATED;      // Hardware acceleration
+            ren = SDL_CreateRenderer(win, -1, ren_flags);
+            // Set up transparency blending for a transparent heads-up overlay.
+            // Just this line is enough to start using the alpha channel on my overlay.
+            SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND); // Draw with alpha
+            startup.mark("renderer");
+        }
 
-        // Create a texture for game art
-        GameArt::tex = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888,
-                SDL_TEXTUREACCESS_TARGET,               // Render to this texture
-                GameArt::rect.w, GameArt::rect.h);
-        // Set up game art texture for blending to draw on transparent background.
-        if(SDL_SetTextureBlendMode(GameArt::tex, SDL_BLENDMODE_BLEND) < 0)
-        { // Texture blending is not supported
-            puts("Cannot set texture to blendmode blend.");
+        // Game art textures, in the format the renderer and window already use (see PixFmt)
+        if (!GameArt::use(GameArt::scale))
+        {
+            setup.join();
             shutdown();
             return EXIT_FAILURE;
         }
+        startup.mark("game art textures");
+        if (DEBUG) PixFmt::print(GameArt::native, 0);
     }
+    setup.join();
+    startup.span("(setup thread)", setup_start, setup_end);
+    startup.mark("wait for setup thread");
+    free(spawns);
 
     /////////////////////
     // INITIAL GAME STATE
@@ -430,39 +1100,164 @@ int main(int argc, char* argv[])
     bool flag_up{};                                     // Pressed key for up
     bool flag_left{};                                   // Pressed key for left
     bool flag_right{};                                  // Pressed key for right
+    int next_scale = GameArt::scale;                    // - and = keys: switch the game art to this scale
+    // CAMERA: the part of the world in the game art (without CAMERA: all of it, at zoom 1)
+    Camera::View cam = {.x=0, .y=0, .zoom=1,
+        .w=static_cast<float>(GameArt::rect.w), .h=static_cast<float>(GameArt::rect.h)};
+    if (GameDemo::CAMERA)
+    { // Start in the middle of the world
+        cam.x = static_cast<float>(GameArt::world.w - GameArt::rect.w)/2;
+        cam.y = static_cast<float>(GameArt::world.h - GameArt::rect.h)/2;
+    }
+    SDL_FPoint cam_pan{};                               // Arrow keys: pan this frame (game art pixels)
+    int wheel{};                                        // Mouse wheel clicks this frame (+ : zoom in)
+    bool flag_whole_zoom{};                             // Shift-wheel: whole number zoom steps
+    bool flag_zoom_reset{};                             // Pressed key for zoom 1
+    bool flag_mouse_moved{};                            // Mouse moved since last frame
+    bool flag_grab{};                                   // Pressed left mouse button
+    bool flag_drop{};                                   // Released left mouse button
+    bool flag_mouse_down{};                             // Left mouse button is held
+    SDL_Point mouse_win{};                              // Latest mouse position in OS window pixels
+    Curves::Grab hover = {.curve=-1, .point=-1, .last={0,0}}; // Curve under the mouse
+    Curves::Grab grab = {.curve=-1, .point=-1, .last={0,0}}; // Curve the mouse is dragging
+    // FIT_CURVE: every mouse sample of a stroke counts, so queue them (no coalescing)
+    constexpr int MAX_STROKE_SAMPLES = 1<<8;            // Mouse samples per video frame
+    SDL_Point stroke_win[MAX_STROKE_SAMPLES];           // Mouse samples in OS window pixels
+    int nstroke{};                                      // Mouse samples queued this frame
+    bool drawing{};                                     // Fitting a stroke right now
+    Fit::Stroke stroke{};                               // The stroke being fitted
+    // Game location & size in OS window (updated every frame when the game art is copied)
+    SDL_Rect dstrect = GameArt::scale_src_to_win(SDL_Rect{.x=0,.y=0,.w=wI.w,.h=wI.h}, GameArt::rect);
+
+    // Frame stats (printed on quit if DEBUG)
+    Stopwatch::Tally game_art_time{"render game art"};  // Time to draw the game art
+    Stopwatch::Tally simplify_time{"simplify lines (RDP)"}; // Time spent in RDP
+    Stopwatch::Tally stroke_time{"stroke rasterizer"};  // Time to rasterize and stream strokes
+    Stopwatch::Tally pick_time{"pick curves"};          // Time to find the curve under the mouse
+    long motion_events{};                               // SDL_MOUSEMOTION events received
+    long motion_updates{};                              // Frames that acted on mouse motion
+    Stopwatch::Tally fit_time{"fit mouse strokes"};     // Time to fit the queued mouse samples
+    long fit_samples{};                                 // Mouse samples fitted
+    long fit_segments{};                                // dCB segments closed into the curve pool
+    Stopwatch::Tally pairs_time{"broad phase (sweep)"}; // Time to find overlapping boxes
+    Stopwatch::Tally hits_time{"curve crossings"};      // Time to find where curves cross
+    long pairs_total{};                                 // Overlapping curve boxes, all frames
+    long hits_total{};                                  // Curve crossings, all frames
+    long blob_total{};                                  // Curve boxes touching the Blob, all frames
+    long swaps_total{};                                 // Broad phase insertion sort swaps, all frames
+    long resorts{};                                     // Frames the broad phase gave up and used std::sort
+    Stopwatch::Tally boids_time{"flock spinners"};      // Time for one step of the boids
+    Stopwatch::Tally gravity_time{"spinner gravity"};   // Time for one step of Barnes-Hut
+    Stopwatch::Tally flow_time{"spinner flow field"};   // Time to blend the wind and move the spinners
+    Stopwatch::Tally particles_time{"particles"};       // Time to emit, move, and kill sparks and debris
+    long segments_in{};                                 // Line segments before RDP
+    long segments_out{};                                // Line segments submitted to SDL
+    long samples_in{};                                  // Curve/circle sample points before snapping
+    long samples_out{};                                 // Unique pixels submitted to SDL
+    Stopwatch::Tally present_time{"present to OS window"}; // Time to put the game art in the OS window
+    Stopwatch::Tally rescale_time{"switch scale"};      // Time to switch game art textures and rescale the world
+    Stopwatch::Tally cull_time{"cull (camera)"};        // Time to bin the spinners and keep the ones on screen
+    Stopwatch::Tally tilemap_time{"tilemap"};           // Time to redraw dirty chunks and copy the ones on screen
+    long chunks_copied{};                               // TILEMAP: chunk textures copied, all frames
+    Stopwatch::Tally path_time{"paths"};                // Time to find the batch of paths and walk along them
+    long spinners_drawn{};                              // CAMERA: spinners on screen, all frames
+    long curves_drawn{};                                // CAMERA: curves on screen, all frames
+    constexpr bool SOUND = GameDemo::AUDIO || GameDemo::SONIFY || GameDemo::REACT; // Open the sound device
+    Audio::Engine audio{};                              // SOUND: mixer in the audio callback (must not move)
+    int blip_voice = 0;                                 // AUDIO: next voice to play a blip on (round robin)
+    Stopwatch::Tally sonify_time{"sonify (publish)"};   // Time to retune the spinner bank and publish it
+    Audio::Track track{};                               // REACT: the WAV file
+    Fft::Analyzer analyzer;                             // REACT: band levels of the track, ahead of playback
+    bool reacting = false;                              // REACT: the track loaded and is playing
+    float levels[Fft::BANDS] = {};                      // REACT: band levels where playback is (0 : quiet)
+    Stopwatch::Tally react_time{"react (levels)"};      // Time to get this frame's levels (no FFT here)
+    bool first_frame = true;                            // Sound opens after the first frame (see Startup)
+    Present::Presenter presenter;                       // CPU_PRESENT: knows when to clear the bars
+    Present::init(presenter);
+    Uint32 last_present = 0;                            // CPU_PRESENT: no VSYNC, so wait out the frame
+
+    // PARTICLES demo: every array is allocated here, once
+    constexpr int MAX_PARTICLES = 1<<14;                // Per pool
+    Particles::Pool sparks;                             // Fly off the Blob's rim
+    Particles::Pool debris;                             // Fall from where curves cross
+    Particles::Emitter blob_sparks = {
+        .x=0, .y=0, .radius=0, .rate=6, .carry=0,       // (Follows the Blob: x, y, radius set every frame)
+        .heading=0, .spread=3.1415927f, .speed=1.0f, .speed_jitter=0.5f,
+        .life=30, .life_jitter=10, .seed=0x2545F491
+    };
+    Particles::Emitter hit_debris = {
+        .x=0, .y=0, .radius=0, .rate=0, .carry=0,       // (Bursts at each crossing)
+        .heading=-1.5707963f, .spread=1.0f, .speed=0.8f, .speed_jitter=0.4f,
+        .life=40, .life_jitter=15, .seed=0x9E3779B9
+    };
+    SDL_FPoint* particle_points;                        // Scratch for SDL_RenderDrawPointsF
+    if (GameDemo::PARTICLES)
+    {
+        Particles::alloc(sparks, MAX_PARTICLES, 0, 0, 0.04f);       // Sparks slow down
+        Particles::alloc(debris, MAX_PARTICLES, 0, 0.03f, 0.01f);   // Debris falls
+        particle_points = (SDL_FPoint*)malloc(sizeof(SDL_FPoint)*MAX_PARTICLES);
+    }
 
     // RAT_CIRCLE demo -- globals
     // Spinner struct is 32 bytes:
     if(DEBUG) printf("%d: sizeof(RatCircle::Spinner): %d\n", __LINE__, (int)sizeof(RatCircle::Spinner));
     RatCircle::Spinner *ali, *bob;                      // Example code for individual spinners
-    // Each spinner is an 8 byte pointer plus 32 bytes of data
-    // (8+32)*pow(2,12) = 163840.0 <--- WHY DOES THAT TERMINATE ON MY LAPTOP?
-    // NSPIN: Number of spinners on screen
-    constexpr int NSPIN = 1<<12;                        // Max on my 32GB Linux desktop
-    /* constexpr int NSPIN = 1<<9;                         // Max on my 8GB Windows laptop: */
+    // Each spinner is an 8 byte pointer plus 32 bytes of data
+    // (8+32)*pow(2,12) = 163840.0 <--- WHY DOES THAT TERMINATE ON MY LAPTOP?
+    // (NSPIN and spinners are up in SETUP: the setup thread spawns them)
     constexpr int NTRAIL = 25;                          // Number of pixels in spinner trail : 1 - 25
-    RatCircle::Spinner *spinners[NSPIN];                // Just a giant array of pointers
-
+    Jobs::Pool jobs;                                    // Worker threads (BOIDS, GRAVITY, FLOW, PATHS, STROKE_CURVES, CURVE_HITS)
+    constexpr bool SPIN_JOBS = GameDemo::RAT_CIRCLE && (GameDemo::BOIDS || GameDemo::GRAVITY || GameDemo::FLOW);
+    constexpr bool JOBS = SPIN_JOBS || GameDemo::PATHS || GameDemo::STROKE_CURVES || GameDemo::CURVE_HITS; // Something uses the pool
+    Boids::Flock flock;                                 // BOIDS: agent i is the center of spinner i
+    Gravity::Bodies bodies;                             // GRAVITY: body i is the center of spinner i
+    Flow::Field wind;                                   // FLOW: the wind, snapshot every FLOW_EVERY frames
+    float* flow_x; float* flow_y;                       // FLOW: particle i is the center of spinner i
+    constexpr int FLOW_EVERY = 6;                       // 10 snapshots a second at 60 Hz
+    Camera::Grid spin_grid;                             // CAMERA: spinners binned by center, to cull them
+    float* spin_x; float* spin_y; float* spin_r;        // CAMERA: what the grid bins (centers and radii)
+    int* spin_shown;                                    // CAMERA: spinners the camera sees this frame
+    Audio::Bank hum{};                                  // SONIFY: oscillator i is spinner i
+    constexpr int NHUM = std::min(NSPIN, GameDemo::SONIFY_MAX); // SONIFY: spinners that hum (the rest are quiet)
+
+    if (JOBS) Jobs::start(jobs);
     if (GameDemo::RAT_CIRCLE)
-    { // Allocate memory for spinners only if RAT_CIRCLE==true
-        SDL_FRect border;
-        { // Spawn spinners within this border
-            float W = static_cast<float>(GameArt::rect.w);
-            float H = static_cast<float>(GameArt::rect.h);
-            float M = 0.01*W;                           // M : Margin in pixels
-            border = {.x=M, .y=M, .w=W-2*M, .h=H-2*M};
+    { // Allocate memory for spinners only if RAT_CIRCLE==true (the setup thread spawned them)
+        if (GameDemo::CAMERA)
+        { // 64 pixel cells (at scale 80: a grid of 80x45 cells)
+            Camera::alloc(spin_grid, NSPIN, static_cast<float>(GameArt::world.w), static_cast<float>(GameArt::world.h),
+                    0.8f*GameArt::scale);
+            spin_x = (float*)malloc(sizeof(float)*NSPIN); spin_y = (float*)malloc(sizeof(float)*NSPIN);
+            spin_r = (float*)malloc(sizeof(float)*NSPIN);
+            spin_shown = (int*)malloc(sizeof(int)*NSPIN);
         }
-        for(int i=0; i<NSPIN; i++)
-        { // Randowm spawn a bunch of spinners
-            // Spawn within the border
-            float x = (static_cast<float>(std::rand()) * (border.w-3)) / RAND_MAX + (border.x+1);
-            float y = (static_cast<float>(std::rand()) * (border.h-3)) / RAND_MAX + (border.y+1);
-            // Start off with a radius between 2 and 64
-            uint8_t r = (std::rand() % 62)+ 2;
-            // Start off with a random speed between 1 and 11
-            uint16_t s = (std::rand() % 10)+1; // Initial speed
-            uint16_t p = std::rand() % RatCircle::MAX_NUM_POINTS; // Initial phase
-            spinners[i] = new RatCircle::Spinner(x,y,r,s,p);
+        if (GameDemo::BOIDS)
+        { // Each spinner's center is an agent in the flock, headed in a random direction
+            Boids::alloc(flock, NSPIN, static_cast<float>(GameArt::world.w), static_cast<float>(GameArt::world.h),
+                    Boids::default_rules());
+            for(int i=0; i<NSPIN; i++)
+            {
+                float vx = (static_cast<float>(std::rand()) / RAND_MAX) - 0.5;
+                float vy = (static_cast<float>(std::rand()) / RAND_MAX) - 0.5;
+                Boids::add(flock, spinners[i]->center_x, spinners[i]->center_y, vx, vy);
+            }
+        }
+        if (GameDemo::GRAVITY)
+        { // Each spinner's center is a body, starting at rest. Bigger spinners are heavier.
+            Gravity::alloc(bodies, NSPIN, static_cast<float>(GameArt::world.w), static_cast<float>(GameArt::world.h),
+                    Gravity::default_rules());
+            for(int i=0; i<NSPIN; i++)
+            {
+                Gravity::add(bodies, spinners[i]->center_x, spinners[i]->center_y, 0, 0,
+                        static_cast<float>(spinners[i]->RADIUS)/32);
+            }
+        }
+        if (GameDemo::FLOW)
+        { // Each spinner's center is a particle in the wind (32 pixel cells: 40x23 grid nodes)
+            Flow::alloc(wind, static_cast<float>(GameArt::world.w), static_cast<float>(GameArt::world.h),
+                    32, 0.5f, FLOW_EVERY);
+            flow_x = (float*)malloc(sizeof(float)*NSPIN); flow_y = (float*)malloc(sizeof(float)*NSPIN);
+            for(int i=0; i<NSPIN; i++) { flow_x[i] = spinners[i]->center_x; flow_y[i] = spinners[i]->center_y; }
         }
         // Each pointer to a spinner is 8 bytes:
         if(DEBUG) printf("%d: sizeof(spinners[0]): %d bytes (pointer)\n", __LINE__, (int)sizeof(spinners[0]));
@@ -511,10 +1306,10 @@ int main(int argc, char* argv[])
 
     if (GameDemo::BLOB)
     {
-        // Blob initial center: center of game window
+        // Blob initial center: center of the world (the game window, without CAMERA)
         Blob::center = SDL_FPoint{
-            .x=static_cast<float>(GameArt::rect.w/2),
-            .y=static_cast<float>(GameArt::rect.h/2)
+            .x=static_cast<float>(GameArt::world.w/2),
+            .y=static_cast<float>(GameArt::world.h/2)
         };
         // Blob initial radius: tiny fraction of the game window width
         Blob::radius = static_cast<float>(GameArt::rect.w/12);
@@ -522,6 +1317,75 @@ int main(int argc, char* argv[])
         Blob::points = (SDL_FPoint*)malloc(sizeof(SDL_FPoint) * Blob::FULL);
         // Allocate memory for debug overlay: debug blob points do NOT jiggle
         Blob::points_debug = (SDL_FPoint*)malloc(sizeof(SDL_FPoint) * Blob::FULL);
+        // (The setup thread pre-computed the quarter circle table)
+    }
+    // TILEMAP demo -- tiles cover the world (16 world pixels a tile at scale 80: the tile count never changes)
+    Tilemap::Map tilemap;
+    constexpr Tilemap::Tile TRAIL = 4;                  // Kind of tile the Blob leaves behind
+    int tile_colors = -1;                               // Foreground color the palette was made from
+    if (GameDemo::TILEMAP)
+    { // Rolling hills of tile kinds 0 (empty) to 3
+        const int tile = GameArt::scale/5;
+        Tilemap::alloc(tilemap, GameArt::world.w/tile, GameArt::world.h/tile, tile, GameArt::native.format);
+        for (int ty=0; ty<tilemap.h; ty++)
+        {
+            for (int tx=0; tx<tilemap.w; tx++)
+            {
+                const float v = std::sin(0.11f*tx) + std::sin(0.07f*ty) + std::sin(0.05f*(tx + ty)); // [-3:3]
+                Tilemap::set(tilemap, tx, ty, (v > 0.5f) + (v > 1.3f) + (v > 2.0f));
+            }
+        }
+        tilemap.changes = 0;                            // (Count the changes after this)
+        if (DEBUG) printf("tilemap: %d x %d tiles, %d x %d chunks of %d x %d\n",
+                tilemap.w, tilemap.h, tilemap.cw, tilemap.ch, Tilemap::CHUNK, Tilemap::CHUNK);
+    }
+    // PATHS demo -- walkers go from goal to goal around the hilltops (positions in tiles: nothing to rescale)
+    constexpr Tilemap::Tile WALL = 3;                   // Kind of tile walkers can't walk on (the hilltops)
+    constexpr int NWALKERS = 512;
+    constexpr int NGOALS = 6;                           // Goals the walkers share (same goal, same chunk : cache hit)
+    constexpr int MAX_BATCH = 64;                       // Paths asked for per frame (the rest ask next frame)
+    constexpr float WALK_SPEED = 0.2f;                  // Tiles per frame
+    Path::Grid walls;                                   // 1 where the tile is a WALL
+    Path::Service path_service;                         // Batches the requests on jobs, caches the paths
+    SDL_Point goals[NGOALS];                            // Tiles the walkers go to
+    float* walk_x; float* walk_y;                       // Walker positions in tiles
+    int* walk_goal;                                     // Goal each walker is going to
+    int* walk_next;                                     // Waypoint each walker is going to (walk_path n : none)
+    Path::Result* walk_path;                            // Walker i's path, in walk_points[i*MAX_POINTS]
+    SDL_Point* walk_points;
+    Path::Request* batch_req; Path::Result* batch_res; int* batch_who; // This frame's requests and who asked
+    int ask_from = 0;                                   // Walker the next batch starts at (everyone gets a turn)
+    SDL_FRect* walk_rects;                              // Walkers on screen, in game art pixels
+    if (GameDemo::PATHS)
+    {
+        Path::alloc(walls, tilemap.w, tilemap.h);
+        for (int ty=0; ty<tilemap.h; ty++)
+        {
+            for (int tx=0; tx<tilemap.w; tx++) walls.wall[ty*walls.w + tx] = (Tilemap::get(tilemap, tx, ty) == WALL);
+        }
+        Path::alloc(path_service, walls, Jobs::threads(jobs), MAX_BATCH);
+        auto open_tile = [&walls](void)
+        { // Random tile that is not a wall
+            SDL_Point t;
+            do { t = SDL_Point{.x=std::rand()%walls.w, .y=std::rand()%walls.h}; } while (!Path::open(walls, t.x, t.y));
+            return t;
+        };
+        for (SDL_Point& g : goals) g = open_tile();
+        walk_x = (float*)malloc(sizeof(float)*NWALKERS); walk_y = (float*)malloc(sizeof(float)*NWALKERS);
+        walk_goal = (int*)malloc(sizeof(int)*NWALKERS); walk_next = (int*)malloc(sizeof(int)*NWALKERS);
+        walk_path = (Path::Result*)malloc(sizeof(Path::Result)*NWALKERS);
+        walk_points = (SDL_Point*)malloc(sizeof(SDL_Point)*NWALKERS*Path::MAX_POINTS);
+        for (int i=0; i<NWALKERS; i++)
+        { // Start on an open tile with no path (so it asks for one)
+            const SDL_Point t = open_tile();
+            walk_x[i] = t.x + 0.5f; walk_y[i] = t.y + 0.5f;
+            walk_goal[i] = std::rand()%NGOALS; walk_next[i] = 0;
+            walk_path[i] = Path::Result{.points=&walk_points[i*Path::MAX_POINTS], .n=0, .length=0, .cached=false};
+        }
+        batch_req = (Path::Request*)malloc(sizeof(Path::Request)*MAX_BATCH);
+        batch_res = (Path::Result*)malloc(sizeof(Path::Result)*MAX_BATCH);
+        batch_who = (int*)malloc(sizeof(int)*MAX_BATCH);
+        walk_rects = (SDL_FRect*)malloc(sizeof(SDL_FRect)*NWALKERS);
     }
     if (0)
     { // Debugging my Spinner constructor
@@ -536,16 +1400,41 @@ int main(int argc, char* argv[])
                             RatCircle::MAX_NUM_POINTS);
     }
 
-    if(  GameDemo::GEN_CURVE  )
+    Raster::Batch stroke_batch{};                       // STROKE_CURVES: the frame's curves, stroked together on jobs
+    if(  GameDemo::GEN_CURVE || GameDemo::FIT_CURVE  )
     {
         // Generate K points on a 2nd-order dCB curve by the matrix multiplication:
         // dCB control points (1 row x 3 cols) x Bmatrix (3 cols x K points)
         // The B matrix is constant if K (number of desired points) is constant.
         // To save time, the B matrix is pre-computed (computed once before the game loop
-        // starts).
+        // starts): the setup thread did it.
 
-        BezierCurves::calc_Bmatrix();                   // Pre-compute the B matrix
+        // Fill the curve pool with random curves. Curves stay put until the mouse drags them.
+        // (FIT_CURVE starts with an empty pool: draw the curves with the mouse.)
+        for (int i=0; i<(GameDemo::GEN_CURVE ? Curves::NCURVES : 0); i++)
+        {
+            SDL_FPoint control_points[BezierCurves::NC];
+            for (int j=0; j<BezierCurves::NC; j++)
+            { // Pick a random point, then scale and offset it
+                constexpr float MAX = static_cast<float>(RAND_MAX);
+                const int SCALE = GameArt::world.w/2;
+                const float OFFSET_X = GameArt::world.w/2;
+                const float OFFSET_Y = GameArt::world.h/2;
+                control_points[j].x = ((std::rand()/MAX) - 0.5)*SCALE + OFFSET_X;
+                control_points[j].y = ((std::rand()/MAX) - 0.5)*SCALE + OFFSET_Y;
+            }
+            int c = Curves::add(control_points);
+            if (GameDemo::CURVE_HITS)
+            { // Give each curve a random velocity
+                constexpr float MAX = static_cast<float>(RAND_MAX);
+                Curves::VX[c] = (2*(std::rand()/MAX) - 1)*Curves::max_speed();
+                Curves::VY[c] = (2*(std::rand()/MAX) - 1)*Curves::max_speed();
+            }
+        }
+        if (GameDemo::CURVE_HITS) Broadphase::alloc(Curves::sweep, 1+Curves::MAX_CURVES); // Blob + every curve
+        if (GameDemo::STROKE_CURVES) Raster::alloc(stroke_batch, Curves::MAX_CURVES, Curves::MAX_CURVES*BezierCurves::K/8);
     }
+    startup.mark("demo setup");
     ////////////
     // GAME LOOP
     ////////////
@@ -577,6 +1466,36 @@ int main(int argc, char* argv[])
                     }
                 }
 
+                // Mouse controls
+                // A fast mouse sends several SDL_MOUSEMOTION events per video frame.
+                // Only the latest position matters, so just remember it here and pick
+                // once per frame in the physics update (coalesce the motion events).
+                if (  e.type == SDL_MOUSEMOTION  )
+                {
+                    mouse_win = SDL_Point{.x=e.motion.x, .y=e.motion.y};
+                    flag_mouse_moved = true;
+                    motion_events++;
+                    if (flag_mouse_down && (nstroke < MAX_STROKE_SAMPLES)) stroke_win[nstroke++] = mouse_win;
+                }
+                if (  (e.type == SDL_MOUSEBUTTONDOWN) && (e.button.button == SDL_BUTTON_LEFT)  )
+                { // Left click : grab a control point or a curve
+                    mouse_win = SDL_Point{.x=e.button.x, .y=e.button.y};
+                    flag_grab = true;
+                    flag_mouse_down = true;
+                    nstroke = 0; stroke_win[nstroke++] = mouse_win; // Stroke starts here
+                }
+                if (  (e.type == SDL_MOUSEBUTTONUP) && (e.button.button == SDL_BUTTON_LEFT)  )
+                { // Let go
+                    flag_drop = true;
+                    flag_mouse_down = false;
+                    if (nstroke < MAX_STROKE_SAMPLES) stroke_win[nstroke++] = SDL_Point{.x=e.button.x, .y=e.button.y};
+                }
+                if (  e.type == SDL_MOUSEWHEEL  )
+                { // Wheel : CAMERA zoom in/out about the mouse (Shift : whole number zoom)
+                    wheel += e.wheel.y;
+                    flag_whole_zoom = ((kmod & KMOD_SHIFT) != 0);
+                }
+
                 // Keyboard controls
                 if (  e.type == SDL_KEYDOWN  )
                 {
@@ -720,6 +1639,18 @@ int main(int argc, char* argv[])
                             }
                             break;
 
+                        case SDLK_MINUS:                // - : smaller game art (chunkier pixels)
+                            next_scale = GameArt::step_scale(GameArt::scale, -1);
+                            break;
+
+                        case SDLK_0:                    // 0 : CAMERA zoom 1
+                            flag_zoom_reset = true;
+                            break;
+
+                        case SDLK_EQUALS:               // = : bigger game art (finer pixels)
+                            next_scale = GameArt::step_scale(GameArt::scale, +1);
+                            break;
+
                         case SDLK_h:                    // h : left
                              if (GameDemo::BLOB) flag_left = true; // Demo tile-based-game "left"
                              break;
@@ -743,20 +1674,124 @@ int main(int argc, char* argv[])
                 if(  k[SDL_SCANCODE_S]  ) flag_down = true;
                 if(  k[SDL_SCANCODE_D]  ) flag_right = true;
             }
+            if (GameDemo::CAMERA)
+            { // Arrows pan (hold to keep panning)
+                const float PAN = GameArt::scale/10.0f; // Game art pixels per frame
+                if(  k[SDL_SCANCODE_LEFT]  ) cam_pan.x -= PAN;
+                if(  k[SDL_SCANCODE_RIGHT] ) cam_pan.x += PAN;
+                if(  k[SDL_SCANCODE_UP]    ) cam_pan.y -= PAN;
+                if(  k[SDL_SCANCODE_DOWN]  ) cam_pan.y += PAN;
+            }
         }
         /////////////////
         // PHYSICS UPDATE
         /////////////////
 
+        if (next_scale != GameArt::scale)
+        { // Switch game art size: textures from the pool, and the world rescales in place (no re-spawn)
+            rescale_time.start();
+            const float k = static_cast<float>(next_scale)/static_cast<float>(GameArt::scale);
+            if (!GameArt::use(next_scale))
+            { // SDL can't make textures that size: stay at this scale
+                printf("Cannot switch to scale %d: %s\n", next_scale, SDL_GetError());
+                next_scale = GameArt::scale;
+            }
+            else
+            { // Everything in game art pixels is k times bigger (spinner radii stay: they are 2-63 at any scale)
+                if (GameDemo::RAT_CIRCLE)
+                {
+                    for(int i=0; i<NSPIN; i++) { spinners[i]->center_x *= k; spinners[i]->center_y *= k; }
+                    if (GameDemo::BOIDS) Boids::rescale(flock, k);
+                    if (GameDemo::GRAVITY) Gravity::rescale(bodies, k);
+                    if (GameDemo::FLOW)
+                    {
+                        Flow::rescale(wind, k);
+                        for(int i=0; i<NSPIN; i++) { flow_x[i] *= k; flow_y[i] *= k; }
+                    }
+                }
+                if (GameDemo::BLOB)
+                {
+                    Blob::center = SDL_FPoint{.x=k*Blob::center.x, .y=k*Blob::center.y};
+                    Blob::radius *= k;
+                }
+                if (GameDemo::GEN_CURVE || GameDemo::FIT_CURVE)
+                {
+                    Curves::rescale(k);
+                    hover.last = SDL_FPoint{.x=k*hover.last.x, .y=k*hover.last.y};
+                    grab.last = SDL_FPoint{.x=k*grab.last.x, .y=k*grab.last.y};
+                    if (drawing) Fit::rescale(stroke, k);
+                }
+                if (GameDemo::PARTICLES)
+                {
+                    Particles::rescale(sparks, k); Particles::rescale(debris, k);
+                    Particles::rescale(blob_sparks, k); Particles::rescale(hit_debris, k);
+                }
+                if (GameDemo::CAMERA)
+                { // Same view of the rescaled world (the grid keeps its cells, k times bigger)
+                    cam.x *= k; cam.y *= k;
+                    cam.w = static_cast<float>(GameArt::rect.w); cam.h = static_cast<float>(GameArt::rect.h);
+                    if (GameDemo::RAT_CIRCLE) spin_grid.cell *= k;
+                }
+                if (GameDemo::TILEMAP) Tilemap::set_tile_size(tilemap, GameArt::scale/5); // (Same tiles, new textures)
+                // The mouse maps to the new game art right away (not next frame)
+                dstrect = GameArt::scale_src_to_win(SDL_Rect{.x=0,.y=0,.w=wI.w,.h=wI.h}, GameArt::rect);
+            }
+            rescale_time.stop();
+        }
+
+        if (reacting)
+        { // Levels where the track is playing (the analyzer thread did the FFT already)
+            react_time.start();
+            const Fft::Frame& f = Fft::frame_at(analyzer, track.played.load(std::memory_order_acquire));
+            for(int b=0; b<Fft::BANDS; b++) levels[b] = f.bands[b];
+            react_time.stop();
+        }
+
         if(  GameDemo::RAT_CIRCLE  )
         {
             for(int i=0; i<NSPIN; i++)
-            {
-                for( int j=0; j<spinners[i]->speed; j++)
+            { // (REACT: spinner i listens to band i%BANDS)
+                int steps = spinners[i]->speed;
+                if (reacting) steps += static_cast<int>(GameDemo::REACT_SPIN*levels[i%Fft::BANDS]);
+                for( int j=0; j<steps; j++)
                 {
                     spinners[i]->counter++;             // Track location on circle
                 }
             }
+            if (GameDemo::BOIDS)
+            { // Move the centers with the flock
+                boids_time.start();
+                Boids::step(flock, jobs);
+                boids_time.stop();
+                for(int i=0; i<NSPIN; i++)
+                {
+                    spinners[i]->center_x = flock.x[i]; spinners[i]->center_y = flock.y[i];
+                }
+            }
+            if (GameDemo::GRAVITY)
+            { // Move the centers with gravity
+                gravity_time.start();
+                Gravity::step(bodies, jobs);
+                gravity_time.stop();
+                for(int i=0; i<NSPIN; i++)
+                {
+                    spinners[i]->center_x = bodies.x[i]; spinners[i]->center_y = bodies.y[i];
+                }
+            }
+            if (GameDemo::FLOW)
+            { // Move the centers with the wind (new snapshot every FLOW_EVERY frames, blend every frame)
+                flow_time.start();
+                Flow::update(wind);
+                Jobs::parallel_for(jobs, NSPIN, 1<<11, [&](int begin, int end)
+                {
+                    Flow::advect(wind, flow_x, flow_y, begin, end, 1);
+                });
+                flow_time.stop();
+                for(int i=0; i<NSPIN; i++)
+                {
+                    spinners[i]->center_x = flow_x[i]; spinners[i]->center_y = flow_y[i];
+                }
+            }
             if(0)
             {
                 for( int i=0; i<ali->speed; i++)
@@ -768,6 +1803,113 @@ int main(int argc, char* argv[])
                     bob->counter++;                          // Track location on circle
                 }
             }
+            if (GameDemo::SONIFY && (audio.dev != 0))
+            { // Retune the bank (the callback picks it up at its next buffer)
+                sonify_time.start();
+                Audio::Params& p = Audio::back(hum);
+                const float gain = 0.5f/std::sqrt(static_cast<float>(NHUM)); // (Random phases: adds up like sqrt(N))
+                for(int i=0; i<NHUM; i++)
+                { // Each j/k speed step is two semitones
+                    const float pitch = 110*std::exp2((spinners[i]->speed - 1)/6.0f);
+                    const float pan = 2*spinners[i]->center_x/GameArt::world.w - 1;
+                    Audio::set(p, i, pitch, gain, pan, audio.spec.freq);
+                }
+                p.count = NHUM;
+                Audio::publish(hum);
+                sonify_time.stop();
+            }
+        }
+
+        if(  GameDemo::GEN_CURVE || GameDemo::FIT_CURVE  )
+        { // Pick and drag curves with the mouse
+            // Mouse in world pixels. (dstrect is where the game art went last frame, and
+            // cam is what it showed: last frame is what the user is pointing at.)
+            SDL_FPoint mouse = Camera::to_world(cam, GameArt::win_to_art(dstrect, mouse_win));
+            const float reach = Curves::pick_radius()/cam.zoom; // (Same reach on screen at any zoom)
+            if (  (flag_mouse_moved || flag_grab) && !drawing  )
+            {
+                motion_updates++;
+                pick_time.start();
+                if (grab.curve >= 0)
+                { // Dragging: move the grabbed control point (or the whole curve)
+                    if (grab.point >= 0) Curves::set(grab.curve, grab.point, mouse);
+                    else Curves::move(grab.curve, SDL_FPoint{.x=mouse.x-grab.last.x, .y=mouse.y-grab.last.y});
+                    grab.last = mouse;
+                }
+                else
+                { // Not dragging: find what is under the mouse
+                    int which;                          // Which control point of the curve
+                    Pick::Hit point = Curves::nearest_control_point(mouse, &which);
+                    const float REACH2 = reach*reach;
+                    if (point.d2 <= REACH2)
+                    { // Close to a control point: that's the one
+                        hover = Curves::Grab{.curve=point.index, .point=which, .last=mouse};
+                    }
+                    else
+                    { // Otherwise the nearest curve (if any is in reach)
+                        Pick::Hit curve = Pick::nearest_curve(Curves::X, Curves::Y, Curves::boxes,
+                                Curves::count, mouse, reach, Curves::scratch);
+                        hover = Curves::Grab{.curve=curve.index, .point=-1, .last=mouse};
+                    }
+                    if (flag_grab) grab = hover;        // Grab it (or nothing)
+                }
+                pick_time.stop();
+            }
+            if (GameDemo::FIT_CURVE)
+            { // Click on empty space and drag to draw a curve
+                fit_time.start();
+                int first = 0;                          // First queued sample to fit
+                if (flag_grab && (grab.curve < 0) && (nstroke > 0))
+                { // Start a stroke where the button went down
+                    Fit::begin(stroke, Camera::to_world(cam, GameArt::win_to_art(dstrect, stroke_win[0])));
+                    drawing = true; first = 1;
+                }
+                if (drawing)
+                { // Fit every queued sample. Closed segments go in the curve pool for good.
+                    SDL_FPoint closed[BezierCurves::NC];
+                    for (int i=first; i<nstroke; i++)
+                    {
+                        fit_samples++;
+                        SDL_FPoint p = Camera::to_world(cam, GameArt::win_to_art(dstrect, stroke_win[i]));
+                        if (  Fit::add(stroke, p, GameDemo::FIT_TOL/cam.zoom, closed) && (Curves::count < Curves::MAX_CURVES)  )
+                        {
+                            Curves::add(closed); fit_segments++;
+                        }
+                    }
+                    if (flag_drop)
+                    { // Stroke is done: the open segment goes in the pool too
+                        if (  Fit::end(stroke, closed) && (Curves::count < Curves::MAX_CURVES)  )
+                        {
+                            Curves::add(closed); fit_segments++;
+                        }
+                        drawing = false;
+                    }
+                }
+                fit_time.stop();
+            }
+            if (flag_drop) grab.curve = -1;
+            flag_mouse_moved = false; flag_grab = false; flag_drop = false;
+            nstroke = 0;
+        }
+
+        if(  GameDemo::CURVE_HITS && (GameDemo::GEN_CURVE || GameDemo::FIT_CURVE)  )
+        { // Animate the curves and find where they cross
+            Curves::animate(grab.curve);                // (Leave the curve the mouse has alone)
+            // The Blob's box (center and radius are already up to date, its points are not yet)
+            SDL_FRect blob = {.x=-INFINITY, .y=-INFINITY, .w=0, .h=0}; // No Blob: a box nothing touches
+            if (GameDemo::BLOB)
+            {
+                float r = Blob::radius*(1 + Blob::JIGAMT);   // Jiggle pushes points out a little
+                blob = SDL_FRect{.x=Blob::center.x-r, .y=Blob::center.y-r, .w=2*r, .h=2*r};
+            }
+            pairs_time.start();
+            Curves::find_pairs(blob);
+            pairs_time.stop();
+            hits_time.start();
+            Curves::find_hits(jobs);
+            hits_time.stop();
+            pairs_total += Curves::npairs; hits_total += Curves::nhits; blob_total += Curves::nblob;
+            swaps_total += Curves::sweep.swaps; resorts += Curves::sweep.resorted;
         }
 
         if(  GameDemo::BLOB  )
@@ -786,8 +1928,9 @@ int main(int argc, char* argv[])
                     float MAX = GameArt::rect.w/4;
                     if (Blob::radius >=MAX) Blob::radius = MAX;
                 }
-                // Note: speed of moving up/down/left/right depends on radius
-                const float move_amount = Blob::radius/4;
+                const SDL_FPoint was = Blob::center;
+                // Note: speed of moving up/down/left/right depends on radius (TILEMAP: one tile a step)
+                const float move_amount = (GameDemo::TILEMAP) ? static_cast<float>(tilemap.tile) : Blob::radius/4;
                 if(flag_down)
                 { // Move blob down
                     flag_down = false;
@@ -808,23 +1951,26 @@ int main(int argc, char* argv[])
                     flag_right = false;
                     Blob::center.x += move_amount;
                 }
+                if (GameDemo::AUDIO && ((Blob::center.x != was.x) || (Blob::center.y != was.y)))
+                { // Blip: two octaves from the bottom of the world to the top, panned by x
+                    const float up = 1 - Blob::center.y/GameArt::world.h;
+                    const float pan = 2*Blob::center.x/GameArt::world.w - 1;
+                    Audio::play(audio, blip_voice, 220*std::exp2(2*up), 0.25f, pan, 0.3f);
+                    blip_voice = (blip_voice + 1)%Audio::MAX_VOICES;
+                }
             }
             { // Make the circle
+                /////////////////////////////////////
+                // FIND RATIONAL POINTS ON THE CIRCLE
+                /////////////////////////////////////
+                // Quarter circle is a rational dCB curve (same table every frame)
+                BezierCurves::dCB_curve_points(RatCircle::QUARTER, Blob::Qmatrix, Blob::N, Blob::points);
+                // Same for debug circle
+                BezierCurves::dCB_curve_points(RatCircle::QUARTER, Blob::Qmatrix, Blob::N, Blob::points_debug);
+                // REACT: the bass shakes it (up to JIGAMT, so it still fits in its box)
+                const float jigamt = (reacting) ? Blob::JIGAMT*levels[0] : Blob::JIGAMT;
                 for(int i=0; i<Blob::N; i++)
-                { // Make a quarter circle
-
-                    /////////////////////////////////////
-                    // FIND RATIONAL POINTS ON THE CIRCLE
-                    /////////////////////////////////////
-                    Blob::points[i] = SDL_FPoint{
-                        .x=RatCircle::x(i,Blob::N),
-                        .y=RatCircle::y(i,Blob::N)
-                    };
-                    // Same for debug circle
-                    Blob::points_debug[i] = SDL_FPoint{
-                        .x=RatCircle::x(i,Blob::N),
-                        .y=RatCircle::y(i,Blob::N)
-                    };
+                { // Jiggle the quarter circle
 
                     //////////////////////
                     // JIGGLE THOSE POINTS
@@ -834,21 +1980,23 @@ int main(int argc, char* argv[])
                     // Get a random float from -0.5 to 0.5
                     float jiggle = (static_cast<float>(std::rand()) / RAND_MAX) - 0.5;
                     // And scale it by JIGAMT
-                    Blob::points[i].x += Blob::JIGAMT*jiggle;
-                    Blob::points[i].y += Blob::JIGAMT*jiggle;
+                    Blob::points[i].x += jigamt*jiggle;
+                    Blob::points[i].y += jigamt*jiggle;
                 }
-                for(int i=Blob::N; i<Blob::FULL; i++)
+                const RatGeom::Rotation quarter = RatGeom::rotation(RatGeom::QUARTER_TURN);
+                for(int q=1; q<4; q++)
                 { // Make the other three-quarters of the circle
-                  // Next point is N indices back, rotated a quarter-circle
-                    Blob::points[i]       = SDL_FPoint{
-                        .x=-1*Blob::points[i-Blob::N].y,
-                        .y=   Blob::points[i-Blob::N].x
-                    };
+                  // Each quarter is the quarter before it, rotated a quarter-circle
+                    const int from = (q-1)*Blob::N; const int to = q*Blob::N;
+                    RatGeom::rotate(quarter, &Blob::points[from], &Blob::points[to], Blob::N, SDL_FPoint{0,0});
                     // Same for debug circle
-                    Blob::points_debug[i] = SDL_FPoint{
-                        .x=-1*Blob::points_debug[i-Blob::N].y,
-                        .y=   Blob::points_debug[i-Blob::N].x
-                    };
+                    RatGeom::rotate(quarter, &Blob::points_debug[from], &Blob::points_debug[to], Blob::N, SDL_FPoint{0,0});
+                }
+                if (GameDemo::BLOB_SPIN)
+                { // Spin the whole circle (still a unit circle at [0,0], so rotate about [0,0])
+                    Blob::heading = RatGeom::compose(Blob::heading, Blob::SPIN);
+                    RatGeom::rotate(Blob::heading, Blob::points, Blob::points, Blob::FULL, SDL_FPoint{0,0});
+                    RatGeom::rotate(Blob::heading, Blob::points_debug, Blob::points_debug, Blob::FULL, SDL_FPoint{0,0});
                 }
                 for(int i=0; i<Blob::FULL; i++)
                 { // Scale circle by radius and offset by center
@@ -867,6 +2015,93 @@ int main(int argc, char* argv[])
                 // Same for debug circle
                 Blob::points_debug[Blob::FULL-1] = Blob::points_debug[0];
             }
+            if (GameDemo::TILEMAP)
+            { // Paint the tile under the Blob (only its chunk gets redrawn, and only if it changed)
+                const float tile = static_cast<float>(tilemap.tile);
+                const int tx = static_cast<int>(std::floor(Blob::center.x/tile));
+                const int ty = static_cast<int>(std::floor(Blob::center.y/tile));
+                if (!GameDemo::PATHS || (Tilemap::get(tilemap, tx, ty) != WALL)) Tilemap::set(tilemap, tx, ty, TRAIL);
+            }
+        }
+        if (GameDemo::PATHS)
+        { // Walkers with no path ask for one (a batch a frame, on jobs), the rest take a step along theirs
+            path_time.start();
+            int n = 0;
+            for (int k=0; (k<NWALKERS) && (n<MAX_BATCH); k++)
+            {
+                const int i = (ask_from + k)%NWALKERS;
+                if (walk_next[i] < walk_path[i].n) continue;
+                const SDL_Point g = goals[walk_goal[i]];
+                batch_req[n] = Path::Request{.sx=static_cast<int>(walk_x[i]), .sy=static_cast<int>(walk_y[i]), .gx=g.x, .gy=g.y};
+                batch_res[n].points = walk_path[i].points;
+                batch_who[n++] = i;
+                ask_from = i + 1;
+            }
+            if (n > 0) Path::find(path_service, jobs, batch_req, n, batch_res);
+            auto arrive = [&](int i)
+            { // Got there: off to some other goal
+                walk_goal[i] = (walk_goal[i] + 1 + std::rand()%(NGOALS-1))%NGOALS;
+                walk_path[i].n = 0; walk_next[i] = 0;
+            };
+            for (int k=0; k<n; k++)
+            { // points[0] is where the walker is: go to points[1]
+                const int i = batch_who[k];
+                walk_path[i] = batch_res[k]; walk_next[i] = 1;
+                if (walk_path[i].n == 0) walk_goal[i] = (walk_goal[i] + 1)%NGOALS; // (No way there: try the next goal)
+                else if (walk_path[i].n == 1) arrive(i);    // (Already on the goal: asking again gets the same path)
+            }
+            for (int i=0; i<NWALKERS; i++)
+            {
+                if (walk_next[i] >= walk_path[i].n) continue;
+                const SDL_Point p = walk_path[i].points[walk_next[i]];
+                const float dx = p.x + 0.5f - walk_x[i]; const float dy = p.y + 0.5f - walk_y[i];
+                const float d = std::sqrt(dx*dx + dy*dy);
+                if (d > WALK_SPEED) { walk_x[i] += WALK_SPEED*dx/d; walk_y[i] += WALK_SPEED*dy/d; continue; }
+                walk_x[i] = p.x + 0.5f; walk_y[i] = p.y + 0.5f;
+                if (++walk_next[i] == walk_path[i].n) arrive(i);
+            }
+            path_time.stop();
+        }
+        if (GameDemo::PARTICLES)
+        { // Emit, move, kill (no malloc: the pools are full or they aren't)
+            particles_time.start();
+            if (GameDemo::BLOB)
+            {
+                blob_sparks.x = Blob::center.x; blob_sparks.y = Blob::center.y; blob_sparks.radius = Blob::radius;
+                Particles::emit(sparks, blob_sparks);
+            }
+            if (GameDemo::CURVE_HITS)
+            {
+                for (int k=0; k<Curves::nhits; k++)
+                {
+                    hit_debris.x = Curves::hits[k].p.x; hit_debris.y = Curves::hits[k].p.y;
+                    Particles::burst(debris, hit_debris, 2);
+                }
+            }
+            for (Particles::Pool* pool : {&sparks, &debris})
+            {
+                Particles::update(*pool, 0, pool->count);
+                Particles::kill(*pool);
+            }
+            particles_time.stop();
+        }
+        if (GameDemo::CAMERA)
+        { // Move the camera last: the mouse picked in the view the user saw last frame
+            if (flag_zoom_reset)
+            { // Zoom 1 about the middle of the game art
+                flag_zoom_reset = false;
+                Camera::zoom_about(cam, 1, SDL_FPoint{.x=cam.w/2, .y=cam.h/2});
+            }
+            const SDL_FPoint at = GameArt::win_to_art(dstrect, mouse_win);
+            for (; wheel != 0; wheel -= (wheel > 0) ? 1 : -1)
+            { // A zoom step per wheel click. Zoom out until the whole world fits, zoom in up to 8.
+                const float MIN = 1.0f/GameDemo::WORLD; constexpr float MAX = 8;
+                const float zoom = Camera::zoom_step(cam.zoom, (wheel > 0) ? 1 : -1, flag_whole_zoom);
+                Camera::zoom_about(cam, std::min(std::max(zoom, MIN), MAX), at);
+            }
+            Camera::pan(cam, cam_pan.x, cam_pan.y);
+            cam_pan = SDL_FPoint{};
+            Camera::keep_in(cam, static_cast<float>(GameArt::world.w), static_cast<float>(GameArt::world.h));
         }
         ////////////
         // RENDERING
@@ -876,6 +2111,15 @@ int main(int argc, char* argv[])
         // GAME ART
         ///////////
 
+        game_art_time.start();
+        SDL_Rect strokes_cleared{};                     // Area of last frame's strokes
+        if (GameDemo::STROKE_CURVES)
+        { // Start the frame with no strokes
+            stroke_time.start();
+            strokes_cleared = Raster::clear(GameArt::strokes);
+            stroke_time.stop();
+        }
+
         // Default is to render to the OS window.
         // Render game art stuff to the GameArt texture instead.
         SDL_SetRenderTarget(ren, GameArt::tex);
@@ -885,26 +2129,60 @@ int main(int argc, char* argv[])
             SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
             SDL_RenderClear(ren);
         }
+        const SDL_FRect see = Camera::visible(cam);     // Part of the world in the game art (CAMERA: cull the rest)
+        if (GameDemo::TILEMAP)
+        { // Tiles go under everything else
+            tilemap_time.start();
+            if (tile_colors != fgnd_color)
+            { // New color scheme: new palette, so every chunk gets redrawn (once, as it comes on screen)
+                tile_colors = fgnd_color;
+                const SDL_Color f = Colors::list[fgnd_color];
+                for (int kind=1; kind<TRAIL; kind++) tilemap.palette[kind] = SDL_Color{f.r, f.g, f.b, (Uint8)(32*kind)};
+                const SDL_Color t = Colors::tardis;
+                tilemap.palette[TRAIL] = SDL_Color{t.r, t.g, t.b, (Uint8)(t.a/2)};
+                Tilemap::invalidate(tilemap);
+            }
+            chunks_copied += Tilemap::draw(tilemap, ren, GameArt::tex, cam);
+            tilemap_time.stop();
+        }
         SDL_FRect border;                               // Use this in later blocks
         { // Border
             float W = static_cast<float>(GameArt::rect.w);
             float H = static_cast<float>(GameArt::rect.h);
             float M = 0.01*W;                           // M : Margin in pixels
             border = {.x=M, .y=M, .w=W-2*M, .h=H-2*M};
+            SDL_FRect edge = border;
+            if (GameDemo::CAMERA)
+            { // Border goes around the world, wherever the camera puts it
+                W = static_cast<float>(GameArt::world.w); H = static_cast<float>(GameArt::world.h);
+                edge = Camera::to_art(cam, SDL_FRect{.x=M, .y=M, .w=W-2*M, .h=H-2*M});
+            }
             SDL_Color c = Colors::list[fgnd_color];
             // Render
             SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
-            SDL_RenderDrawRectF(ren, &border);
+            SDL_RenderDrawRectF(ren, &edge);
         }
-        if(  GameDemo::BLOB  )
+        bool blob_shown = true;                         // CAMERA: false if the Blob is off screen
+        if (GameDemo::CAMERA && GameDemo::BLOB)
+        {
+            const float r = Blob::radius*(1 + Blob::JIGAMT);
+            blob_shown = Camera::overlaps(SDL_FRect{.x=Blob::center.x-r, .y=Blob::center.y-r, .w=2*r, .h=2*r}, see);
+        }
+        if(  GameDemo::BLOB && blob_shown  )
         { // Draw the circle specified by Blob::center and Blob::radius
+            SDL_FPoint points[Blob::FULL];              // Blob points in game art pixels
+            for(int i=0; i<Blob::FULL; i++) points[i] = Blob::points[i];
+            if (GameDemo::CAMERA) Camera::to_art(cam, points, Blob::FULL);
             if (  show_overlay  )
             { // Debug overlay -- expect circle in center of jiggle
                 { // Pick an obvious debug color, but make it a little transparent
                     SDL_SetRenderDrawColor(ren, 100, 255, 100, 255/(1<<1));
                 }
                 { // Draw blob points without jiggle, connect with lines
-                    SDL_RenderDrawLinesF(ren, Blob::points_debug, Blob::FULL);
+                    SDL_FPoint debug[Blob::FULL];
+                    for(int i=0; i<Blob::FULL; i++) debug[i] = Blob::points_debug[i];
+                    if (GameDemo::CAMERA) Camera::to_art(cam, debug, Blob::FULL);
+                    SDL_RenderDrawLinesF(ren, debug, Blob::FULL);
                 }
             }
                 if (1)
@@ -913,7 +2191,17 @@ int main(int argc, char* argv[])
                         SDL_Color c = Colors::tardis;
                         SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a/(1<<1));
                     }
-                    SDL_RenderDrawLinesF(ren, Blob::points, Blob::FULL);    // Render the circle
+                    SDL_FPoint lines[Blob::FULL];               // Polyline to submit
+                    int nlines = Blob::FULL;
+                    for(int i=0; i<nlines; i++) lines[i] = points[i];
+                    if (GameDemo::SIMPLIFY_LINES)
+                    { // Drop points that are collinear at chunky-pixel resolution
+                        simplify_time.start();
+                        nlines = Polyline::rdp(lines, nlines, GameDemo::SIMPLIFY_TOL);
+                        simplify_time.stop();
+                    }
+                    segments_in += Blob::FULL-1; segments_out += nlines-1;
+                    SDL_RenderDrawLinesF(ren, lines, nlines);   // Render the circle
                 }
                 if (1)
                 { // Draw points
@@ -921,7 +2209,14 @@ int main(int argc, char* argv[])
                         SDL_Color c = Colors::list[fgnd_color];
                         SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
                     }
-                    SDL_RenderDrawPointsF(ren, Blob::points, Blob::FULL);   // Render the circle
+                    if (GameDemo::SNAP_POINTS)
+                    { // One point per chunky pixel
+                        SDL_Point pixels[Blob::FULL];
+                        int npixels = Polyline::snap_unique(points, Blob::FULL, pixels);
+                        samples_in += Blob::FULL; samples_out += npixels;
+                        SDL_RenderDrawPoints(ren, pixels, npixels);         // Render the circle
+                    }
+                    else SDL_RenderDrawPointsF(ren, points, Blob::FULL); // Render the circle
                 }
         }
         if(  GameDemo::RAT_CIRCLE  )
@@ -930,7 +2225,10 @@ int main(int argc, char* argv[])
             { // Draw tardis-colored points
                 SDL_Color c = Colors::tardis;
                 SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
-                SDL_RenderDrawPointsF(ren, bob->points, bob->COUNT);
+                for(int i=0; i<bob->COUNT; i++)
+                { // (Points are relative to the center)
+                    SDL_RenderDrawPointF(ren, bob->center_x + bob->points[i].x, bob->center_y + bob->points[i].y);
+                }
             }
             if (0)
             { // Draw an orange line from center to a point
@@ -938,13 +2236,29 @@ int main(int argc, char* argv[])
                 SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
                 SDL_RenderDrawLineF(ren,
                         bob->center_x, bob->center_y,
-                        bob->points[bob->counter%bob->COUNT].x,
-                        bob->points[bob->counter%bob->COUNT].y);
+                        bob->center_x + bob->points[bob->counter%bob->COUNT].x,
+                        bob->center_y + bob->points[bob->counter%bob->COUNT].y);
+            }
+            int nshown = NSPIN;                         // Spinners to draw (CAMERA: the ones on screen)
+            if (GameDemo::CAMERA)
+            { // Bin the spinners where they are now (they move), keep the ones the camera sees
+                cull_time.start();
+                for(int i=0; i<NSPIN; i++)
+                {
+                    spin_x[i] = spinners[i]->center_x; spin_y[i] = spinners[i]->center_y;
+                    spin_r[i] = spinners[i]->RADIUS;
+                    if (reacting) spin_r[i] *= 1 + GameDemo::REACT_SWELL*levels[i%Fft::BANDS];
+                }
+                Camera::bin(spin_grid, spin_x, spin_y, spin_r, NSPIN);
+                nshown = Camera::query(spin_grid, spin_x, spin_y, spin_r, see, spin_shown);
+                cull_time.stop();
+                spinners_drawn += nshown;
             }
             if (1)
             { // Draw each spinner at its active point
-                for(int i=0; i<NSPIN; i++)
+                for(int n=0; n<nshown; n++)
                 {
+                    const int i = (GameDemo::CAMERA) ? spin_shown[n] : n;
                     int index = i%Colors::count;
                     if (index == bgnd_color) index++;   // Don't make spinners same color as bgnd
                     SDL_Color c = Colors::list[i%Colors::count];
@@ -954,11 +2268,35 @@ int main(int argc, char* argv[])
                     int phase = counter%COUNT; // a point from 0 to COUNT-1
                     // Draw the point AND a trail after it for one color spinners
                     int ntrail = (index == fgnd_color) ? NTRAIL : 1;
+                    SDL_Point last_pixel{};             // Last pixel drawn in this trail
+                    // REACT: swells with its band (points are relative to the center: just scale them)
+                    const float swell = (reacting) ? 1 + GameDemo::REACT_SWELL*levels[i%Fft::BANDS] : 1;
                     for(int j=0; j<ntrail; j++)
                     {
-                        SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a-(j*10));
-                        SDL_FPoint active_point = spinners[i]->points[phase-j];
-                        SDL_RenderDrawPointF(ren, active_point.x, active_point.y);
+                        // Wrap back around the circle if the trail goes past point 0
+                        SDL_FPoint active_point = spinners[i]->points[(phase-j+COUNT)%COUNT];
+                        active_point.x = spinners[i]->center_x + swell*active_point.x;
+                        active_point.y = spinners[i]->center_y + swell*active_point.y;
+                        if (GameDemo::CAMERA) active_point = Camera::to_art(cam, active_point);
+                        samples_in++;
+                        if (GameDemo::SNAP_POINTS)
+                        { // Small circles put several trail points in one chunky pixel
+                            SDL_Point pixel = Polyline::snap(active_point);
+                            if (  (j>0) && (pixel.x==last_pixel.x) && (pixel.y==last_pixel.y)  )
+                            { // Already drawn (and brighter, because j was smaller)
+                                continue;
+                            }
+                            last_pixel = pixel;
+                            samples_out++;
+                            SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a-(j*10));
+                            SDL_RenderDrawPoint(ren, pixel.x, pixel.y);
+                        }
+                        else
+                        {
+                            samples_out++;
+                            SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a-(j*10));
+                            SDL_RenderDrawPointF(ren, active_point.x, active_point.y);
+                        }
                     }
                 }
                 if(0)
@@ -966,6 +2304,7 @@ int main(int argc, char* argv[])
                     SDL_Color c = Colors::lime;
                     SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
                     SDL_FPoint active_point = ali->points[ali->counter%ali->COUNT];
+                    active_point.x += ali->center_x; active_point.y += ali->center_y;
                     SDL_RenderDrawPointF(ren, active_point.x, active_point.y);
                 }
                 if(0)
@@ -973,6 +2312,7 @@ int main(int argc, char* argv[])
                     SDL_Color c = Colors::orange;
                     SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
                     SDL_FPoint active_point = bob->points[bob->counter%bob->COUNT];
+                    active_point.x += bob->center_x; active_point.y += bob->center_y;
                     SDL_RenderDrawPointF(ren, active_point.x, active_point.y);
                 }
             }
@@ -983,8 +2323,9 @@ int main(int argc, char* argv[])
             {
                 SDL_Color c = Colors::list[i];
 
-                constexpr int COUNT = (1<<6) * GameArt::scale*GameArt::scale/100;
-                SDL_FPoint points[COUNT];
+                const int COUNT = (1<<6) * GameArt::scale*GameArt::scale/100;
+                constexpr int BIGGEST = GameArt::SCALES[sizeof(GameArt::SCALES)/sizeof(int) - 1];
+                SDL_FPoint points[(1<<6) * BIGGEST*BIGGEST/100]; // (Room for COUNT at any scale)
                 for(int i=0; i<COUNT; i++)
                 {
                     float x = (static_cast<float>(std::rand()) * (border.w-3)) / RAND_MAX + (border.x+1);
@@ -1009,9 +2350,9 @@ int main(int argc, char* argv[])
                 control_points[i].y = (std::rand()/MAX) - 0.5;
             }
             // Scale and offset points:
-            constexpr int SCALE = GameArt::rect.w/2;
-            constexpr float OFFSET_X = GameArt::rect.w/2;
-            constexpr float OFFSET_Y = GameArt::rect.h/2;
+            const int SCALE = GameArt::rect.w/2;
+            const float OFFSET_X = GameArt::rect.w/2;
+            const float OFFSET_Y = GameArt::rect.h/2;
             for(int i=0;i<NC;i++)
             {
                 control_points[i].x *= SCALE;
@@ -1076,63 +2417,231 @@ int main(int argc, char* argv[])
                 { // Use foreground color
                     SDL_SetRenderDrawColor(ren, 255>>2, 255, 255>>2, 255>>1);
                 }
-                constexpr float W = SCALE;
-                constexpr float H = SCALE;
-                constexpr float x_left = OFFSET_X - W/2;
-                constexpr float y_top = OFFSET_Y - H/2;
+                const float W = SCALE;
+                const float H = SCALE;
+                const float x_left = OFFSET_X - W/2;
+                const float y_top = OFFSET_Y - H/2;
                 SDL_FRect rect = { .x=x_left, .y=y_top, .w=W, .h=H };
                 SDL_RenderDrawRectF(ren, &rect);
             }
         }
-        if (1)
+        if(  GameDemo::GEN_CURVE || GameDemo::FIT_CURVE  )
         { // Method 2: dCB curve is matrix product of control points and pre-computed B matrix (NC rows x K cols)
             using namespace BezierCurves;
             // Calculate points on the dCB curve from the Bmatrix and the control points
-
-            // TODO: move control points creation/update to the physics loop
-            //       First make a pool of memory for many control_points[3] arrays
-            //       Then I will have larger scope for control points so that
-            //       physics and renderer can both see control points.
-            SDL_FPoint control_points[NC];              // dCB control points
-            { // Generate three random control points
-                for(int i=0; i<NC; i++)
-                {
-                    constexpr float MAX = static_cast<float>(RAND_MAX);
-                    control_points[i].x = (std::rand()/MAX) - 0.5;
-                    control_points[i].y = (std::rand()/MAX) - 0.5;
+            // Highlight the curve being dragged, or else the curve under the mouse
+            const Curves::Grab& picked = (grab.curve >= 0) ? grab : hover;
+            for (int i=0; i<Curves::count; i++)
+            { // Draw every curve in the pool (CAMERA: that the camera sees)
+                if (  GameDemo::CAMERA && !Camera::overlaps(Curves::boxes[i], see)  ) continue; // No samples, no RDP
+                SDL_FPoint control_points[NC];              // dCB control points
+                Curves::get(i, control_points);
+                // A dCB curve of moved control points is the moved curve: move 3 points, not K
+                if (GameDemo::CAMERA) { Camera::to_art(cam, control_points, NC); curves_drawn++; }
+                bool highlight = (i == picked.curve);
+
+                SDL_FPoint points[K];                       // dCB curve points
+                SDL_FPoint tangents[K];                     // dCB curve tangents
+                SDL_FPoint normals[K];                      // dCB curve unit normals
+                // Fill arg points with dCB curve points (and tangents and normals)
+                dCB_curve_points(control_points, points, tangents, normals);
+                { // Render as lines in foreground color (orange if picked)
+                    SDL_Color c = (highlight) ? Colors::orange : Colors::list[fgnd_color];
+                    SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+                    SDL_FPoint lines[K];                    // Polyline to submit
+                    int nlines = K;
+                    for(int k=0; k<K; k++) lines[k] = points[k];
+                    if (GameDemo::SIMPLIFY_LINES)
+                    { // Drop points that are collinear at chunky-pixel resolution
+                        simplify_time.start();
+                        nlines = Polyline::rdp(lines, nlines, GameDemo::SIMPLIFY_TOL);
+                        simplify_time.stop();
+                    }
+                    segments_in += K-1; segments_out += nlines-1;
+                    if (GameDemo::STROKE_CURVES)
+                    { // Thick anti-aliased line: into the batch (stroked on jobs after the last curve)
+                        stroke_time.start();
+                        if (!Raster::add(stroke_batch, lines, nlines, c))
+                        { // Batch is full: stroke what is in it, then start a new one
+                            Raster::stroke(GameArt::strokes, jobs, stroke_batch, GameDemo::STROKE_WIDTH);
+                            Raster::add(stroke_batch, lines, nlines, c);
+                        }
+                        stroke_time.stop();
+                    }
+                    else SDL_RenderDrawLinesF(ren,lines,nlines);
+                }
+                { // Render as lime points
+                    { // Use lime color
+                        SDL_Color c = Colors::lime;
+                        SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+                    }
+                    if (GameDemo::SNAP_POINTS)
+                    { // One point per chunky pixel
+                        SDL_Point pixels[K];
+                        int npixels = Polyline::snap_unique(points, K, pixels);
+                        samples_in += K; samples_out += npixels;
+                        SDL_RenderDrawPoints(ren, pixels, npixels);
+                    }
+                    else SDL_RenderDrawPointsF(ren, points, K);
+                }
+                if (highlight)
+                { // Show the handles of the picked curve
+                    { // Draw the JOIN segment of each pair of control points in tardis blue
+                        SDL_Color c = Colors::tardis;
+                        SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+                        SDL_RenderDrawLinesF(ren,control_points,NC);
+                    }
+                    { // Draw the control points as little squares in red/pink
+                        SDL_Color c = Colors::dress;
+                        SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+                        const float R = Curves::pick_radius()/2;
+                        for (int j=0; j<NC; j++)
+                        {
+                            SDL_FRect handle = {.x=control_points[j].x-R, .y=control_points[j].y-R, .w=2*R, .h=2*R};
+                            if (j == picked.point) SDL_RenderFillRectF(ren, &handle);
+                            else SDL_RenderDrawRectF(ren, &handle);
+                        }
+                    }
+                }
+                if (show_overlay)
+                { // Debug overlay: draw the unit normals as little hairs on the curve
+                    SDL_Color c = Colors::tardis;
+                    SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a/(1<<1));
+                    const float HAIR = 3*GameArt::scale/10; // Hair length in pixels
+                    for(int k=0; k<K; k+=(1<<3))
+                    {
+                        SDL_RenderDrawLineF(ren, points[k].x, points[k].y,
+                                points[k].x + HAIR*normals[k].x,
+                                points[k].y + HAIR*normals[k].y);
+                    }
                 }
-                // TODO: move scale and offset to physics loop
-                // Scale and offset points:
-                constexpr int SCALE = GameArt::rect.w/2;
-                constexpr float OFFSET_X = GameArt::rect.w/2;
-                constexpr float OFFSET_Y = GameArt::rect.h/2;
-                for(int i=0;i<NC;i++)
+            }
+            if (GameDemo::STROKE_CURVES)
+            { // Stroke every curve at once: bands of canvas rows on every thread
+                stroke_time.start();
+                Raster::stroke(GameArt::strokes, jobs, stroke_batch, GameDemo::STROKE_WIDTH);
+                stroke_time.stop();
+            }
+            if (GameDemo::CURVE_HITS && GameDemo::BLOB)
+            { // Outline the curves whose boxes touch the Blob's box
+                SDL_Color c = Colors::lime;
+                SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+                for (int k=0; k<Curves::npairs; k++)
                 {
-                    control_points[i].x *= SCALE;
-                    control_points[i].y *= SCALE;
-                    control_points[i].x += OFFSET_X;
-                    control_points[i].y += OFFSET_Y;
+                    if (Curves::pairs[k].a != 0) continue;
+                    SDL_FRect box = Curves::objects[Curves::pairs[k].b];
+                    if (GameDemo::CAMERA) box = Camera::to_art(cam, box);
+                    SDL_RenderDrawRectF(ren, &box);
                 }
             }
-
-            // Below here stays in the rendering loop!
-            SDL_FPoint points[K];                       // dCB curve points
-            dCB_curve_points(control_points, points);   // Fill arg points with dCB curve points
-            { // Render as lines in foreground color
-                { // Use foreground color
-                    SDL_Color c = Colors::list[fgnd_color];
-                    SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+            if (GameDemo::CURVE_HITS)
+            { // Mark where curves cross
+                SDL_Color c = Colors::taffy;
+                SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+                const float R = GameArt::scale/20.0;
+                for (int k=0; k<Curves::nhits; k++)
+                {
+                    SDL_FPoint p = Curves::hits[k].p;
+                    if (GameDemo::CAMERA) p = Camera::to_art(cam, p);
+                    SDL_FRect mark = {.x=p.x-R, .y=p.y-R, .w=2*R, .h=2*R};
+                    SDL_RenderFillRectF(ren, &mark);
                 }
-                SDL_RenderDrawLinesF(ren,points,K);
             }
-            { // Render as lime points
-                { // Use lime color
-                    SDL_Color c = Colors::lime;
-                    SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+        }
+        if (GameDemo::PARTICLES)
+        { // Sparks and debris: one point each
+            auto draw = [&](const Particles::Pool& pool, SDL_Color c)
+            { // (CAMERA: only the ones on screen, in game art pixels)
+                int n = 0;
+                for (int i=0; i<pool.count; i++)
+                {
+                    const SDL_FPoint p = {pool.x[i], pool.y[i]};
+                    particle_points[n] = (GameDemo::CAMERA) ? Camera::to_art(cam, p) : p;
+                    n += (!GameDemo::CAMERA) || (  (p.x >= see.x) && (p.x < see.x + see.w) &&
+                                                    (p.y >= see.y) && (p.y < see.y + see.h)  );
+                }
+                SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+                SDL_RenderDrawPointsF(ren, particle_points, n);
+            };
+            draw(sparks, Colors::orange);
+            draw(debris, Colors::taffy);
+        }
+        if (GameDemo::PATHS)
+        { // Walkers: a small square each, goals: a tile outline each (CAMERA: only the ones on screen)
+            const float tile = static_cast<float>(tilemap.tile);
+            const float size = 0.6f*tile;
+            int n = 0;
+            for (int i=0; i<NWALKERS; i++)
+            {
+                SDL_FRect r = {.x=walk_x[i]*tile - size/2, .y=walk_y[i]*tile - size/2, .w=size, .h=size};
+                if (GameDemo::CAMERA)
+                {
+                    if (!Camera::overlaps(see, r)) continue;
+                    r = Camera::to_art(cam, r);
                 }
-                SDL_RenderDrawPointsF(ren, points, K);
+                walk_rects[n++] = r;
+            }
+            SDL_Color c = Colors::lime;
+            SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+            SDL_RenderFillRectsF(ren, walk_rects, n);
+            c = Colors::orange;
+            SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+            for (const SDL_Point& g : goals)
+            {
+                SDL_FRect r = {.x=g.x*tile, .y=g.y*tile, .w=tile, .h=tile};
+                if (GameDemo::CAMERA) r = Camera::to_art(cam, r);
+                SDL_RenderDrawRectF(ren, &r);
+            }
+        }
+        if(  GameDemo::FIT_CURVE  )
+        { // The stroke being drawn, and the fitting HUD
+            if (drawing)
+            { // Draw the open segment (it changes with every mouse sample) in orange
+                SDL_FPoint fit[BezierCurves::NC] = {stroke.fit[0], stroke.fit[1], stroke.fit[2]};
+                if (GameDemo::CAMERA) Camera::to_art(cam, fit, BezierCurves::NC);
+                SDL_FPoint points[BezierCurves::K];
+                BezierCurves::dCB_curve_points(fit, points);
+                SDL_Color c = Colors::orange;
+                SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+                SDL_RenderDrawLinesF(ren, points, BezierCurves::K);
+            }
+            { // Latency bar: time to fit last frame's mouse samples
+                // No text yet, so show the time as a bar. Full track is US_FULL microseconds.
+                constexpr float US_FULL = 100;
+                const float H = GameArt::scale/10;  // Bar height
+                const float W = border.w/4;             // Track width
+                SDL_FRect track = {.x=border.x+H, .y=border.y+H, .w=W, .h=H};
+                SDL_Color c = Colors::list[fgnd_color];
+                SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a/(1<<2));
+                SDL_RenderFillRectF(ren, &track);
+                SDL_FRect bar = track;
+                bar.w = std::min(static_cast<float>(fit_time.last_us)/US_FULL, 1.0f)*W;
+                c = Colors::lime;
+                SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+                SDL_RenderFillRectF(ren, &bar);
+                // Tick at the worst frame so far
+                float worst = track.x + std::min(static_cast<float>(fit_time.max_us)/US_FULL, 1.0f)*W;
+                c = Colors::taffy;
+                SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+                SDL_RenderDrawLineF(ren, worst, track.y, worst, track.y+H);
             }
         }
+        if (GameDemo::STROKE_CURVES)
+        { // Stream the strokes to the GPU and lay them over the game art
+            stroke_time.start();
+            // Upload what changed: last frame's strokes (now cleared) and this frame's strokes
+            SDL_Rect changed;
+            SDL_UnionRect(&strokes_cleared, &GameArt::strokes.dirty, &changed);
+            if ((changed.w > 0) && (changed.h > 0))
+            {
+                const Uint32* first = &GameArt::strokes.pixels[changed.y*GameArt::strokes.w + changed.x];
+                SDL_UpdateTexture(GameArt::stroke_tex, &changed, first, sizeof(Uint32)*GameArt::strokes.w);
+                PixFmt::upload(GameArt::native, GameArt::strokes.format);
+            }
+            SDL_RenderCopy(ren, GameArt::stroke_tex, NULL, NULL);
+            PixFmt::copy(GameArt::native, GameArt::strokes.format);
+            stroke_time.stop();
+        }
         if(  show_overlay  )
         { // Overlay help
             { // Darken light stuff
@@ -1149,17 +2658,13 @@ int main(int argc, char* argv[])
             }
         }
 
+        game_art_time.stop();
+
         ////////////
         // OS WINDOW
         ////////////
 
-        SDL_SetRenderTarget(ren, NULL);                 // Render to OS window
-        { // Clear the window to a black background
-            SDL_SetRenderDrawColor(ren, 0,0,0,0);
-            SDL_RenderClear(ren);
-        }
-        // Copy the game art to the OS window
-        SDL_Rect dstrect;                               // Game location & size in OS window
+        present_time.start();
         SDL_Rect winrect = {.x=0,.y=0,.w=wI.w,.h=wI.h}; // OS window size
         // - Center game art in OS window
         // - Leave scaling 1:1 or scale-up to fit (but maintain aspect ratio)
@@ -1167,10 +2672,74 @@ int main(int argc, char* argv[])
         dstrect = (SCALE_GAME_ART) ?
             GameArt::scale_src_to_win(winrect, GameArt::rect) :
             GameArt::center_src_in_win(winrect, GameArt::rect);
-        SDL_RenderCopy(ren, GameArt::tex, &GameArt::rect, &dstrect);
-        SDL_RenderPresent(ren);
+        if (GameDemo::CPU_PRESENT)
+        { // Upscale the game art surface straight into the window surface
+            GameArt::native.copies++;
+            if (!Present::present(presenter, win, GameArt::surface, dstrect))
+            { // Window surface is some other format: let SDL convert (slow, but it works)
+                SDL_Surface* surf = SDL_GetWindowSurface(win);
+                SDL_FillRect(surf, NULL, 0);
+                SDL_BlitScaled(GameArt::surface, &GameArt::rect, surf, &dstrect);
+                SDL_UpdateWindowSurface(win);
+                GameArt::native.converted_copies++;
+            }
+            present_time.stop();
+            Uint32 now = SDL_GetTicks();
+            if (now - last_present < 16) SDL_Delay(16 - (now - last_present));
+            last_present = SDL_GetTicks();
+        }
+        else
+        {
+            SDL_SetRenderTarget(ren, NULL);             // Render to OS window
+            { // Clear the window to a black background
+                SDL_SetRenderDrawColor(ren, 0,0,0,0);
+                SDL_RenderClear(ren);
+            }
+            // Copy the game art to the OS window
+            SDL_RenderCopy(ren, GameArt::tex, &GameArt::rect, &dstrect);
+            PixFmt::copy(GameArt::native, GameArt::native.format);
+            present_time.stop();                        // (Not the VSYNC wait)
+            SDL_RenderPresent(ren);
+        }
+
+        if (first_frame)
+        { // The first frame is on screen: start the sound now (see Startup)
+            first_frame = false;
+            startup.mark("first frame");
+            if (SOUND && Audio::open(audio, 48000, GameDemo::AUDIO_SAMPLES))
+            {
+                if (DEBUG) printf("audio: %s driver, %d Hz, %d samples per buffer\n",
+                        SDL_GetCurrentAudioDriver(), audio.spec.freq, audio.spec.samples);
+                if (GameDemo::REACT && Audio::load(track, GameDemo::REACT_WAV, audio))
+                { // Analyzer gets going first, then the sound starts
+                    Fft::start(analyzer, track.samples, track.frames, audio.spec.freq);
+                    Audio::attach(audio, &track);
+                    reacting = true;
+                    if (DEBUG) printf("track: %s, %.1f s\n", GameDemo::REACT_WAV,
+                            static_cast<double>(track.frames)/audio.spec.freq);
+                }
+                if (GameDemo::SONIFY && GameDemo::RAT_CIRCLE)
+                { // Each oscillator starts at its spinner's phase (silent until the next frame publishes)
+                    Audio::alloc(hum, NHUM);
+                    for(int i=0; i<NHUM; i++)
+                    {
+                        const float angle = Audio::TWO_PI*(spinners[i]->counter%spinners[i]->COUNT)/spinners[i]->COUNT;
+                        hum.re[i] = std::cos(angle); hum.im[i] = std::sin(angle);
+                    }
+                    Audio::attach(audio, &hum);
+                }
+                startup.mark("sound (lazy)");
+            }
+            if (DEBUG) startup.print();
+        }
     }
 
+    if (SOUND) Audio::close(audio);                     // (Before the bank it mixes is released)
+    if (reacting)
+    { // (Analyzer reads the track: stop it first)
+        Fft::stop(analyzer);
+        Audio::release(track);
+    }
     if (GameDemo::RAT_CIRCLE)
     { // Free pool of memory for points in the circle
         for(int i=0; i<NSPIN; i++)
@@ -1185,13 +2754,132 @@ int main(int argc, char* argv[])
             free(bob->points);
             delete bob;
         }
+        if (GameDemo::BOIDS) Boids::release(flock);
+        if (GameDemo::GRAVITY) Gravity::release(bodies);
+        if (GameDemo::FLOW)
+        {
+            Flow::release(wind);
+            free(flow_x); free(flow_y);
+        }
+        if (GameDemo::SONIFY && (hum.capacity > 0)) Audio::release(hum);
+        if (GameDemo::CAMERA)
+        {
+            Camera::release(spin_grid);
+            free(spin_x); free(spin_y); free(spin_r); free(spin_shown);
+        }
+    }
+    if (GameDemo::CURVE_HITS) Broadphase::release(Curves::sweep);
+    if (GameDemo::PATHS)
+    {
+        Path::release(path_service); Path::release(walls);
+        free(walk_x); free(walk_y); free(walk_goal); free(walk_next); free(walk_path); free(walk_points);
+        free(batch_req); free(batch_res); free(batch_who); free(walk_rects);
+    }
+    if (GameDemo::TILEMAP) Tilemap::release(tilemap);
+    if (GameDemo::PARTICLES)
+    {
+        Particles::release(sparks); Particles::release(debris);
+        free(particle_points);
     }
+    if (GameDemo::STROKE_CURVES && (stroke_batch.capacity > 0)) Raster::release(stroke_batch);
+    if (JOBS) Jobs::stop(jobs);
     if (GameDemo::BLOB)
     { // Free the array of blob points
         free(Blob::points);
         free(Blob::points_debug);
     }
 
+    if (DEBUG)
+    { // Frame stats
+        game_art_time.print();
+        present_time.print();
+        if (GameDemo::CPU_PRESENT) printf("letterbox cleared %ld times in %ld frames\n", presenter.bar_clears, presenter.frames);
+        if (rescale_time.laps > 0)
+        {
+            rescale_time.print();
+            printf("game art targets         : %ld switches, %ld made, the rest re-used from the pool\n",
+                    rescale_time.laps, GameArt::made - 1);  // (Not counting the first)
+        }
+        PixFmt::print(GameArt::native, present_time.laps);
+        if (GameDemo::SIMPLIFY_LINES) simplify_time.print();
+        if (GameDemo::STROKE_CURVES) stroke_time.print();
+        if (GameDemo::GEN_CURVE || GameDemo::FIT_CURVE) pick_time.print();
+        if (GameDemo::FIT_CURVE) fit_time.print();
+        if (GameDemo::CURVE_HITS) { pairs_time.print(); hits_time.print(); }
+        if (GameDemo::BOIDS) boids_time.print();
+        if (GameDemo::GRAVITY) gravity_time.print();
+        if (GameDemo::FLOW) flow_time.print();
+        if (GameDemo::CAMERA && GameDemo::RAT_CIRCLE) cull_time.print();
+        if (GameDemo::TILEMAP) tilemap_time.print();
+        if (SOUND) Audio::print(audio);
+        if (GameDemo::SONIFY && (hum.published > 0))
+        {
+            sonify_time.print();
+            printf("spinner bank             : %d oscillators, %ld snapshots published, %ld mixed\n",
+                    NHUM, hum.published, hum.taken);
+        }
+        if (reacting)
+        {
+            react_time.print();
+            printf("track analysis           : %ld frames analyzed, %ld asked for, %ld not ready, %.1f frames ahead (%.0f ms)\n",
+                    analyzer.produced.load(), analyzer.asks, analyzer.misses,
+                    (analyzer.asks > analyzer.misses) ? static_cast<double>(analyzer.lead)/(analyzer.asks - analyzer.misses) : 0.0,
+                    (analyzer.asks > analyzer.misses) ? 1e3*analyzer.lead*Fft::HOP/(analyzer.asks - analyzer.misses)/audio.spec.freq : 0.0);
+        }
+        if (GameDemo::PATHS)
+        {
+            path_time.print();
+            printf("path requests            : %ld asked for, %ld cache hits (%.0f%%), %ld searched\n",
+                    path_service.requests, path_service.hits,
+                    (path_service.requests > 0) ? 100.0*path_service.hits/path_service.requests : 0.0,
+                    path_service.searched);
+        }
+        if (GameDemo::PARTICLES)
+        {
+            particles_time.print();
+            printf("sparks : %ld spawned, %ld killed, %ld dropped\n", sparks.spawned, sparks.killed, sparks.dropped);
+            printf("debris : %ld spawned, %ld killed, %ld dropped\n", debris.spawned, debris.killed, debris.dropped);
+        }
+        if (game_art_time.laps > 0)
+        {
+            printf("line segments per frame  : %ld in, %ld out (%.1f%% fewer)\n",
+                    segments_in/game_art_time.laps, segments_out/game_art_time.laps,
+                    (segments_in > 0) ? 100.0*(segments_in-segments_out)/segments_in : 0.0);
+            printf("sample points per frame  : %ld in, %ld out (%.1f%% fewer)\n",
+                    samples_in/game_art_time.laps, samples_out/game_art_time.laps,
+                    (samples_in > 0) ? 100.0*(samples_in-samples_out)/samples_in : 0.0);
+            if (GameDemo::CURVE_HITS)
+            {
+                printf("curve pairs per frame    : %ld overlapping boxes, %ld crossings, %ld touch the Blob\n",
+                        pairs_total/game_art_time.laps, hits_total/game_art_time.laps,
+                        blob_total/game_art_time.laps);
+                printf("broad phase sort         : %ld swaps per frame, %ld of %ld frames resorted\n",
+                        swaps_total/game_art_time.laps, resorts, game_art_time.laps);
+            }
+            if (GameDemo::CAMERA)
+            {
+                printf("on screen per frame      : %ld of %d spinners, %ld curves (of %d in the pool)\n",
+                        spinners_drawn/game_art_time.laps, GameDemo::RAT_CIRCLE ? NSPIN : 0,
+                        curves_drawn/game_art_time.laps, Curves::count);
+            }
+            if (GameDemo::TILEMAP)
+            {
+                printf("tile chunks per frame    : %ld copied, %ld redrawn in all, %ld tile changes, %ld evicted\n",
+                        chunks_copied/game_art_time.laps, tilemap.redraws, tilemap.changes, tilemap.evictions);
+            }
+            if (GameDemo::FIT_CURVE)
+            {
+                printf("stroke samples fitted    : %ld, %ld dCB segments closed\n",
+                        fit_samples, fit_segments);
+            }
+            if (GameDemo::GEN_CURVE || GameDemo::FIT_CURVE)
+            {
+                printf("mouse motion events      : %ld in, %ld frames picked (coalesced)\n",
+                        motion_events, motion_updates);
+            }
+        }
+    }
+
     shutdown();
     return EXIT_SUCCESS;
 }
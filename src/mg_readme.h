@@ -207,6 +207,12 @@
  * In GameDemo::BLOB, I assign HJKL for movement using the first method (tile-based),
  * and WASD for movement using the second method (platformer).
  *
+ * Mouse motion is different: a fast mouse sends several SDL_MOUSEMOTION events
+ * per video frame, and only the last one matters. So the UI code just saves
+ * the latest mouse position and sets a flag. The physics code looks at the
+ * mouse once per frame. In GameDemo::GEN_CURVE, click and drag a curve (or
+ * one of its control points) to move it.
+ *
  * *******************************/
 /* *************Physics code***************
  * - calculate the physics for all the stuff
@@ -390,6 +396,20 @@
  *
  * So circles, yeah. I can't think of any other non-linear curves that I'd find much use
  * for in a game. If it ever comes up, I'll look into how to parameterize those.
+ *
+ * Turns out the circle is a dCB curve after all, just a weighted one. Give each control
+ * point a weight, do the dCB curve in homogeneous coordinates [w*x, w*y, w], and divide
+ * by w at the end. Control points [1,0], [1,1], [0,1] with weights 1, 1, 2 give exactly
+ * x(t) = (1-t*t)/(1+t*t) and y(t) = 2t/(1+t*t). If the weights are fixed, the division
+ * folds into the pre-computed Bmatrix, so spinners, Blob and curves all go through the
+ * same matrix multiplication (see BezierCurves::calc_rational_Bmatrix).
+ *
+ * And the circle points ARE rotations. [x(t), y(t)] is [cos, sin] of some angle, exactly,
+ * without ever knowing the angle. So rotate by it: that's RatGeom (mg_ratgeom.h), along
+ * with quadrance and spread. The quarter turns that build the spinners and the Blob are
+ * RatGeom::QUARTER_TURN, and the Blob spins by RatGeom::turn(1,64) every frame. Per
+ * object, the rational [cos, sin] is about 4x faster than std::cos and std::sin
+ * (make bench).
  * *******************************/
 /* *************De Casteljau - Bezier (dCB) curves***************
  * - dCB curves produce polynomial curves in 2D
@@ -590,6 +610,13 @@
  * But if I just imagine my x-y plane rotated so that the line x=0 bisects the angle formed
  * by the two tangent lines, then the "observations" hold true.
  *
+ * In practice (GameDemo::FIT_CURVE) the datapoints come from the mouse, and the
+ * tangent at a mouse sample is mostly noise. So the live fit does not MEET the
+ * tangents. It keeps P0 and P2 on the data and picks the P1 that is closest to
+ * ALL the points in between (least squares). The sums for that fit add up one
+ * point at a time, so fitting keeps up with the mouse. When the fit gets too
+ * far off, the segment is done and a new one starts at its P2. See mg_fit.h.
+ *
  *
  *
   * *******************************/